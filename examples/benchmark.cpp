@@ -1,10 +1,13 @@
 #include <lift/lift.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <getopt.h>
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <sys/resource.h>
 #include <thread>
 #include <vector>
 
@@ -15,11 +18,67 @@ static auto print_usage(const std::string& program_name) -> void
     std::cout << "    -t --threads      Number of threads to use.\n";
     std::cout << "                      evenly between each worker thread.\n";
     std::cout << "    -d --duration     Duration of the test in seconds\n";
+    std::cout << "    -s --socket       Socket readiness backend [uv_poll|io_uring], default=uv_poll.\n";
+    std::cout << "    -S --spin         Busy-poll the event loop for this many microseconds before sleeping.\n";
+    std::cout << "    -T --tune         Sweep threads and connections per thread to find the best client options,\n";
+    std::cout << "                      -d is the duration of each step, default=2.\n";
+    std::cout << "    -p --slo-p99      Tuning p99 latency objective in microseconds, default=10000.\n";
+    std::cout << "    -C --max-connections Largest connections per thread tried when tuning, default=256.\n";
+    std::cout << "    -M --max-threads  Largest thread count tried when tuning, default=hardware threads.\n";
     std::cout << "    -h --help         Print this help usage.\n";
 }
 
-static auto print_stats(std::chrono::seconds duration, uint64_t threads, uint64_t total_success, uint64_t total_error)
-    -> void
+/**
+ * The outcome of driving the url with a fixed number of clients and connections for a duration.
+ */
+struct load_result
+{
+    uint64_t                  success{0};
+    uint64_t                  error{0};
+    std::vector<uint32_t>     latencies{};
+    std::chrono::microseconds cpu{0};
+    uint64_t                  poll_updates{0};
+    uint64_t                  poll_syscalls{0};
+    uint64_t                  loop_sleeps{0};
+};
+
+static auto cpu_time() -> std::chrono::microseconds
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    auto to_us = [](const timeval& tv) -> std::chrono::microseconds
+    { return std::chrono::seconds{tv.tv_sec} + std::chrono::microseconds{tv.tv_usec}; };
+    return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+static auto print_latency(std::vector<uint32_t>& latencies, std::chrono::microseconds cpu, uint64_t total) -> void
+{
+    std::cout << "Latency Distribution\n";
+    if (!latencies.empty())
+    {
+        std::sort(latencies.begin(), latencies.end());
+        for (auto p : {50.0, 90.0, 99.0, 99.9})
+        {
+            auto index = static_cast<std::size_t>((p / 100.0) * static_cast<double>(latencies.size() - 1));
+            std::cout << "  p" << p << "  " << latencies[index] << "us\n";
+        }
+    }
+
+    std::cout << "CPU Stats\n";
+    std::cout << "  " << cpu.count() / 1000 << "ms cpu time\n";
+    if (total > 0)
+    {
+        std::cout << "  CPU/req: " << (cpu.count() / static_cast<double>(total)) << "us\n";
+    }
+}
+
+static auto print_stats(
+    std::chrono::seconds duration,
+    uint64_t             threads,
+    uint64_t             total_success,
+    uint64_t             total_error,
+    uint64_t             poll_updates,
+    uint64_t             poll_syscalls) -> void
 {
     auto total = total_success + total_error;
     std::cout << "Thread Stats    Avg\n";
@@ -32,27 +91,261 @@ static auto print_stats(std::chrono::seconds duration, uint64_t threads, uint64_
         std::cout << "  " << total_error << " errors\n";
     }
     std::cout << "  Req/sec: " << (total / static_cast<double>(duration.count())) << "\n";
+
+    std::cout << "Socket Stats\n";
+    std::cout << "  " << poll_updates << " interest updates, " << poll_syscalls << " syscalls\n";
+    if (total > 0)
+    {
+        std::cout << "  Syscalls/req: " << (poll_syscalls / static_cast<double>(total)) << "\n";
+    }
+}
+
+/**
+ * Keeps every connection of every client busy with back to back requests to the url for the duration.
+ */
+static auto run_load(
+    const std::string&           url,
+    uint64_t                     threads,
+    uint64_t                     connections,
+    std::chrono::seconds         duration,
+    const lift::client::options& options) -> load_result
+{
+    using namespace std::chrono_literals;
+
+    load_result           result{};
+    std::atomic<uint64_t> success{0};
+    std::atomic<uint64_t> error{0};
+
+    // Each connection slot records when its current request was submitted, latencies are recorded
+    // per thread since each client's callbacks only ever run on that client's event loop thread.
+    using clock = std::chrono::steady_clock;
+    std::vector<std::vector<clock::time_point>> started(threads, std::vector<clock::time_point>(connections));
+    std::vector<std::vector<uint32_t>>          latencies(threads);
+
+    auto cpu_start = cpu_time();
+
+    {
+        std::vector<std::vector<lift::request::async_callback_type>> callbacks(threads);
+        std::vector<std::unique_ptr<lift::client>>                   clients;
+        clients.reserve(threads);
+
+        for (uint64_t i = 0; i < threads; ++i)
+        {
+            clients.emplace_back(std::make_unique<lift::client>(options));
+            if (clients.back()->active_socket_backend() != options.socket_backend)
+            {
+                std::cout << "Requested socket backend is unavailable, falling back to uv_poll.\n";
+            }
+
+            latencies[i].reserve(1'000'000);
+            callbacks[i].reserve(connections);
+
+            for (uint64_t j = 0; j < connections; ++j)
+            {
+                callbacks[i].emplace_back(
+                    [&clients, &success, &error, &callbacks, &started, &latencies, i, j](
+                        lift::request_ptr req_ptr, lift::response response)
+                    {
+                        if (response.lift_status() == lift::lift_status::success)
+                        {
+                            success.fetch_add(1, std::memory_order_relaxed);
+                        }
+                        else if (response.lift_status() == lift::lift_status::error_failed_to_start)
+                        {
+                            return;
+                        }
+                        else
+                        {
+                            error.fetch_add(1, std::memory_order_relaxed);
+                        }
+
+                        auto now = clock::now();
+                        latencies[i].push_back(static_cast<uint32_t>(
+                            std::chrono::duration_cast<std::chrono::microseconds>(now - started[i][j]).count()));
+                        started[i][j] = now;
+
+                        // And request again until we are shutting down.
+                        auto copy_callback = callbacks[i][j];
+                        clients[i]->start_request(std::move(req_ptr), std::move(copy_callback));
+                    });
+            }
+
+            for (uint64_t j = 0; j < connections; ++j)
+            {
+                auto request_ptr = std::make_unique<lift::request>(url, 30s);
+
+                request_ptr->follow_redirects(false);
+                request_ptr->header("Connection", "Keep-Alive");
+                auto copy_callback = callbacks[i][j];
+                started[i][j]      = clock::now();
+                clients[i]->start_request(std::move(request_ptr), std::move(copy_callback));
+            }
+        }
+
+        std::this_thread::sleep_for(duration);
+
+        for (auto& thread : clients)
+        {
+            thread->stop();
+        }
+
+        for (auto& client : clients)
+        {
+            auto metrics = client->metrics();
+            result.poll_updates += metrics.socket_poll_updates;
+            result.poll_syscalls += metrics.socket_poll_syscalls;
+            result.loop_sleeps += metrics.loop_sleeps;
+        }
+    }
+
+    result.cpu     = cpu_time() - cpu_start;
+    result.success = success.load();
+    result.error   = error.load();
+    for (auto& l : latencies)
+    {
+        result.latencies.insert(result.latencies.end(), l.begin(), l.end());
+    }
+    std::sort(result.latencies.begin(), result.latencies.end());
+
+    return result;
+}
+
+/**
+ * @return The p-th percentile of the sorted latencies in microseconds, 0 if there are none.
+ */
+static auto percentile(const std::vector<uint32_t>& sorted, double p) -> uint32_t
+{
+    if (sorted.empty())
+    {
+        return 0;
+    }
+    return sorted[static_cast<std::size_t>((p / 100.0) * static_cast<double>(sorted.size() - 1))];
+}
+
+/**
+ * Sweeps the thread count and the connections per thread, both doubling each step, and recommends the
+ * smallest configuration whose throughput is within 5% of the best seen while its p99 latency stays
+ * within the objective.  For each thread count connections stop doubling at the knee, once doubling
+ * them adds less than 5% throughput or breaks the objective, and threads stop doubling once a thread
+ * count no longer improves on the best configuration.
+ */
+static auto run_tune(
+    const std::string&           url,
+    std::chrono::seconds         duration,
+    uint32_t                     slo_p99_us,
+    uint64_t                     max_threads,
+    uint64_t                     max_connections,
+    const lift::client::options& base_options) -> int
+{
+    struct tune_step
+    {
+        uint64_t threads{0};
+        uint64_t connections{0};
+        double   req_per_sec{0};
+        uint32_t p99{0};
+    };
+
+    constexpr double better{1.05};
+
+    std::cout << "Tuning @ " << url << " with a p99 objective of " << slo_p99_us << "us, " << duration.count()
+              << "s per step\n";
+    std::cout << "  Threads  Connections      Req/sec        p50        p99   Errors\n";
+
+    std::optional<tune_step> best{};
+    for (uint64_t threads = 1; threads <= max_threads; threads *= 2)
+    {
+        bool   improved{false};
+        double previous{0};
+        for (uint64_t connections = 1; connections <= max_connections; connections *= 2)
+        {
+            auto options                = base_options;
+            options.reserve_connections = connections;
+            options.max_connections     = connections;
+
+            auto result      = run_load(url, threads, connections, duration, options);
+            auto total       = result.success + result.error;
+            auto req_per_sec = static_cast<double>(total) / static_cast<double>(duration.count());
+            auto p99         = percentile(result.latencies, 99.0);
+            bool within_slo  = result.error == 0 && total > 0 && p99 <= slo_p99_us;
+
+            std::cout << std::setw(9) << threads << std::setw(13) << connections << std::setw(13) << std::fixed
+                      << std::setprecision(0) << req_per_sec << std::setw(9) << percentile(result.latencies, 50.0)
+                      << "us" << std::setw(9) << p99 << "us" << std::setw(9) << result.error
+                      << (within_slo ? "" : "  over objective") << "\n";
+
+            if (!within_slo)
+            {
+                // More connections only queue more requests behind the same server.
+                break;
+            }
+
+            if (!best.has_value() || req_per_sec > best.value().req_per_sec * better)
+            {
+                best     = tune_step{threads, connections, req_per_sec, p99};
+                improved = true;
+            }
+
+            if (previous > 0 && req_per_sec < previous * better)
+            {
+                // The knee, doubling the connections no longer buys throughput.
+                break;
+            }
+            previous = req_per_sec;
+        }
+
+        if (!improved)
+        {
+            break;
+        }
+    }
+
+    if (!best.has_value())
+    {
+        std::cout << "No configuration met the p99 objective.\n";
+        return EXIT_FAILURE;
+    }
+
+    const auto& step = best.value();
+    std::cout << "\nBest: " << step.threads << " thread(s) x " << step.connections << " connection(s), "
+              << step.req_per_sec << " req/sec at p99 " << step.p99 << "us\n";
+    std::cout << "Recommended: a pool of " << step.threads << " lift::client(s), one per thread, each with\n";
+    std::cout << "    lift::client::options{\n";
+    std::cout << "        .reserve_connections = " << step.connections << ",\n";
+    std::cout << "        .max_connections     = " << step.connections << "}\n";
+    std::cout << "and at most " << step.connections << " requests in flight per client.\n";
+
+    return EXIT_SUCCESS;
 }
 
 int main(int argc, char* argv[])
 {
-    constexpr char   short_options[] = "c:d:t:h";
+    constexpr char   short_options[] = "c:d:t:s:S:Tp:C:M:h";
     constexpr option long_options[]  = {
         {"help", no_argument, nullptr, 'h'},
         {"connections", required_argument, nullptr, 'c'},
         {"duration", required_argument, nullptr, 'd'},
         {"threads", required_argument, nullptr, 't'},
+        {"socket", required_argument, nullptr, 's'},
+        {"spin", required_argument, nullptr, 'S'},
+        {"tune", no_argument, nullptr, 'T'},
+        {"slo-p99", required_argument, nullptr, 'p'},
+        {"max-connections", required_argument, nullptr, 'C'},
+        {"max-threads", required_argument, nullptr, 'M'},
         {nullptr, 0, nullptr, 0}};
 
     int option_index = 0;
     int opt          = 0;
 
-    std::optional<uint64_t>             connections_opt;
-    std::optional<std::chrono::seconds> duration_opt;
-    std::optional<uint64_t>             threads_opt;
-    std::optional<std::string>          url_opt;
-
-    std::size_t index{0};
+    std::optional<uint64_t>                  connections_opt;
+    std::optional<std::chrono::seconds>      duration_opt;
+    std::optional<uint64_t>                  threads_opt;
+    std::optional<std::string>               url_opt;
+    lift::socket_backend                     socket_backend{lift::socket_backend::uv_poll};
+    std::optional<std::chrono::microseconds> spin_budget{};
+    bool                                     tune{false};
+    uint32_t                                 slo_p99_us{10'000};
+    uint64_t                                 max_connections{256};
+    uint64_t                                 max_threads{std::max(1u, std::thread::hardware_concurrency())};
 
     while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
     {
@@ -70,14 +363,44 @@ int main(int argc, char* argv[])
             case 't':
                 threads_opt = std::stoul(optarg);
                 break;
+            case 's':
+                socket_backend = (std::string{optarg} == "io_uring") ? lift::socket_backend::io_uring
+                                                                     : lift::socket_backend::uv_poll;
+                break;
+            case 'S':
+                spin_budget = std::chrono::microseconds{std::stol(optarg)};
+                break;
+            case 'T':
+                tune = true;
+                break;
+            case 'p':
+                slo_p99_us = static_cast<uint32_t>(std::stoul(optarg));
+                break;
+            case 'C':
+                max_connections = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'M':
+                max_threads = std::max(1ul, std::stoul(optarg));
+                break;
         }
+    }
 
-        index += 2;
+    if (optind < argc)
+    {
+        url_opt = argv[optind];
     }
 
-    if (index + 1 < argc)
+    lift::client::options options{.socket_backend = socket_backend, .spin_budget = spin_budget};
+
+    if (tune && url_opt.has_value())
     {
-        url_opt = argv[index + 1];
+        return run_tune(
+            url_opt.value(),
+            duration_opt.value_or(std::chrono::seconds{2}),
+            slo_p99_us,
+            max_threads,
+            max_connections,
+            options);
     }
 
     if (!connections_opt.has_value() || !duration_opt.has_value() || !threads_opt.has_value() || !url_opt.has_value())
@@ -86,8 +409,6 @@ int main(int argc, char* argv[])
         return EXIT_FAILURE;
     }
 
-    using namespace std::chrono_literals;
-
     auto url         = url_opt.value();
     auto duration    = duration_opt.value();
     auto connections = connections_opt.value();
@@ -95,59 +416,14 @@ int main(int argc, char* argv[])
 
     std::cout << "Running " << duration.count() << "s test @ " << url << "\n";
 
-    std::atomic<uint64_t> success{0};
-    std::atomic<uint64_t> error{0};
+    auto result = run_load(url, threads, connections, duration, options);
 
+    print_stats(duration, threads, result.success, result.error, result.poll_updates, result.poll_syscalls);
+    print_latency(result.latencies, result.cpu, result.success + result.error);
+    if (spin_budget.has_value())
     {
-        std::vector<lift::request::async_callback_type> callbacks;
-        callbacks.reserve(threads);
-        std::vector<std::unique_ptr<lift::client>> clients;
-        clients.reserve(threads);
-
-        for (uint64_t i = 0; i < threads; ++i)
-        {
-            clients.emplace_back(std::make_unique<lift::client>());
-
-            callbacks.emplace_back(
-                [&clients, &success, &error, &callbacks, i](lift::request_ptr req_ptr, lift::response response) {
-                    if (response.lift_status() == lift::lift_status::success)
-                    {
-                        success.fetch_add(1, std::memory_order_relaxed);
-                    }
-                    else if (response.lift_status() == lift::lift_status::error_failed_to_start)
-                    {
-                        return;
-                    }
-                    else
-                    {
-                        error.fetch_add(1, std::memory_order_relaxed);
-                    }
-
-                    // And request again until we are shutting down.
-                    auto copy_callback = callbacks[i];
-                    clients[i]->start_request(std::move(req_ptr), std::move(copy_callback));
-                });
-
-            for (uint64_t j = 0; j < connections; ++j)
-            {
-                auto request_ptr = std::make_unique<lift::request>(url, 30s);
-
-                request_ptr->follow_redirects(false);
-                request_ptr->header("Connection", "Keep-Alive");
-                auto copy_callback = callbacks[i];
-                clients[i]->start_request(std::move(request_ptr), std::move(copy_callback));
-            }
-        }
-
-        std::this_thread::sleep_for(duration);
-
-        for (auto& thread : clients)
-        {
-            thread->stop();
-        }
+        std::cout << "  Loop sleeps: " << result.loop_sleeps << "\n";
     }
 
-    print_stats(duration, threads, success, error);
-
     return 0;
 }
@@ -0,0 +1,146 @@
+#include <lift/lift.hpp>
+
+#include <chrono>
+#include <getopt.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Measures the throughput of lift::parallel_download() as the number of concurrent byte ranges
+ * varies.  Point it at a large static file on a local server, every chunk count is downloaded the
+ * given number of times and the best run is reported.  By default the bytes are discarded so only
+ * the network and client are measured, -o writes them to a file instead.
+ */
+
+static auto print_usage(const std::string& program_name) -> void
+{
+    std::cout << "Usage: " << program_name << " <options> <url>\n";
+    std::cout << "    -c --chunks      Comma separated chunk counts to measure, default=1,2,4,8,16.\n";
+    std::cout << "    -s --chunk-size  Maximum size of a single range in bytes, default=unlimited.\n";
+    std::cout << "    -r --runs        Downloads per chunk count, the best is reported, default=3.\n";
+    std::cout << "    -o --output      Write the download to this file with mmap, default=discard.\n";
+    std::cout << "    -h --help        Print this help usage.\n";
+}
+
+/**
+ * Discards the download, only counting the bytes written.
+ */
+class discard_sink : public lift::download_sink
+{
+public:
+    auto prepare(uint64_t) -> bool override { return true; }
+    auto write(uint64_t, std::string_view data) -> bool override
+    {
+        m_bytes += data.size();
+        return true;
+    }
+
+    uint64_t m_bytes{0};
+};
+
+int main(int argc, char* argv[])
+{
+    constexpr char   short_options[] = "c:s:r:o:h";
+    constexpr option long_options[]  = {
+        {"help", no_argument, nullptr, 'h'},
+        {"chunks", required_argument, nullptr, 'c'},
+        {"chunk-size", required_argument, nullptr, 's'},
+        {"runs", required_argument, nullptr, 'r'},
+        {"output", required_argument, nullptr, 'o'},
+        {nullptr, 0, nullptr, 0}};
+
+    int option_index = 0;
+    int opt          = 0;
+
+    std::vector<uint64_t>   chunk_counts{1, 2, 4, 8, 16};
+    std::optional<uint64_t> chunk_size{std::nullopt};
+    uint64_t                runs{3};
+    std::string             output{};
+
+    while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            case 'c':
+            {
+                chunk_counts.clear();
+                std::stringstream ss{optarg};
+                std::string       count{};
+                while (std::getline(ss, count, ','))
+                {
+                    chunk_counts.push_back(std::max(1ul, std::stoul(count)));
+                }
+            }
+            break;
+            case 's':
+                chunk_size = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'r':
+                runs = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'o':
+                output = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc || chunk_counts.empty())
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string url{argv[optind]};
+
+    // One client for every run so connections are re-used like a long lived application would.
+    lift::client client{};
+
+    std::cout << "chunks  ranges  size(bytes)  best(ms)  MB/s\n";
+    for (auto chunks : chunk_counts)
+    {
+        lift::parallel_download_result best{};
+        for (uint64_t run = 0; run < runs; ++run)
+        {
+            lift::parallel_download_options options{
+                .client = &client, .chunks = chunks, .max_chunk_size = chunk_size, .min_chunk_size = 1};
+
+            lift::parallel_download_result result{};
+            if (output.empty())
+            {
+                discard_sink sink{};
+                result = lift::parallel_download(url, sink, std::move(options));
+            }
+            else
+            {
+                lift::mmap_download_sink sink{output};
+                result = lift::parallel_download(url, sink, std::move(options));
+            }
+
+            if (result.lift_status != lift::lift_status::success)
+            {
+                std::cerr << "Download failed: " << lift::to_string(result.lift_status) << " "
+                          << lift::http::to_string(result.status_code) << "\n";
+                return EXIT_FAILURE;
+            }
+
+            if (run == 0 || result.total_time < best.total_time)
+            {
+                best = result;
+            }
+        }
+
+        auto seconds = std::max(best.total_time.count(), int64_t{1}) / 1000.0;
+        std::cout << chunks << "  " << best.ranges << "  " << best.size << "  " << best.total_time.count() << "  "
+                  << (static_cast<double>(best.size) / (1024.0 * 1024.0) / seconds) << "\n";
+    }
+
+    return EXIT_SUCCESS;
+}
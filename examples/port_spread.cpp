@@ -0,0 +1,155 @@
+#include <lift/lift.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * Opens a new connection for every request to a single server, the traffic that exhausts the
+ * ephemeral ports of one source address, spread across the given source addresses.  Every request
+ * asks the server to close its connection so none are reused.  Prints the client's per source
+ * address counters, the run fails if any request fails.
+ */
+
+static auto print_usage(const std::string& program_name) -> void
+{
+    std::cout << "Usage: " << program_name << " <options> <url>\n";
+    std::cout << "    -s --source           A source address as ip[:port[:range]], repeat for each address.\n";
+    std::cout << "    -n --requests         Total requests, default=100000.\n";
+    std::cout << "    -c --concurrency      Requests in flight at once, default=256.\n";
+    std::cout << "    -h --help             Print this help usage.\n";
+}
+
+static auto parse_source(const std::string& value) -> lift::source_address
+{
+    lift::source_address source{};
+
+    auto first     = value.find(':');
+    source.address = value.substr(0, first);
+    if (first != std::string::npos)
+    {
+        auto second = value.find(':', first + 1);
+        source.port = static_cast<uint16_t>(std::stoul(value.substr(first + 1, second - first - 1)));
+        if (second != std::string::npos)
+        {
+            source.port_range = static_cast<uint16_t>(std::stoul(value.substr(second + 1)));
+        }
+    }
+
+    return source;
+}
+
+int main(int argc, char* argv[])
+{
+    constexpr char   short_options[] = "s:n:c:h";
+    constexpr option long_options[]  = {
+        {"help", no_argument, nullptr, 'h'},
+        {"source", required_argument, nullptr, 's'},
+        {"requests", required_argument, nullptr, 'n'},
+        {"concurrency", required_argument, nullptr, 'c'},
+        {nullptr, 0, nullptr, 0}};
+
+    int option_index = 0;
+    int opt          = 0;
+
+    std::vector<lift::source_address> sources{};
+    uint64_t                          total{100'000};
+    uint64_t                          concurrency{256};
+
+    while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            case 's':
+                sources.push_back(parse_source(optarg));
+                break;
+            case 'n':
+                total = std::stoul(optarg);
+                break;
+            case 'c':
+                concurrency = std::max(1ul, std::stoul(optarg));
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string url{argv[optind]};
+    auto        addresses = sources;
+
+    lift::client client{lift::client::options{.source_addresses = std::move(sources)}};
+
+    std::atomic<uint64_t> started{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> errors{0};
+
+    auto start = std::chrono::steady_clock::now();
+
+    while (completed.load(std::memory_order_acquire) < total)
+    {
+        while (started.load(std::memory_order_relaxed) < total &&
+               started.load(std::memory_order_relaxed) - completed.load(std::memory_order_acquire) < concurrency)
+        {
+            auto request = std::make_unique<lift::request>(url, std::chrono::seconds{10});
+            request->header("Connection", "close");
+
+            started.fetch_add(1, std::memory_order_relaxed);
+            client.start_request(
+                std::move(request),
+                [&](lift::request_ptr, lift::response response)
+                {
+                    if (response.lift_status() != lift::lift_status::success)
+                    {
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                    }
+                    completed.fetch_add(1, std::memory_order_release);
+                });
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    auto metrics = client.metrics();
+
+    std::cout << "Requests:      " << total << " (" << errors.load() << " errors)\n";
+    std::cout << "Elapsed:       " << elapsed.count() << "ms\n";
+
+    for (std::size_t i = 0; i < metrics.source_addresses.size(); ++i)
+    {
+        const auto& source = addresses[i];
+        const auto& counts = metrics.source_addresses[i];
+        std::cout << std::setw(16) << (source.address.empty() ? "*" : source.address);
+        if (source.port.has_value())
+        {
+            std::cout << ":" << source.port.value() << "+" << source.port_range;
+        }
+        std::cout << "  requests " << counts.requests << "  connections " << counts.connections << "\n";
+    }
+
+    if (errors.load() > 0)
+    {
+        std::cout << "FAILED\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "PASSED\n";
+    return EXIT_SUCCESS;
+}
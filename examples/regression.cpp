@@ -0,0 +1,612 @@
+#include <lift/lift.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * Runs a fixed matrix of scenarios against a local server, records the results as JSON and
+ * compares them against a stored baseline.  Any scenario that is worse than the baseline by more
+ * than the tolerance is flagged as a regression and the process exits with a non-zero status.
+ */
+
+enum class execution_mode
+{
+    sync,
+    async
+};
+
+struct scenario
+{
+    std::string         name;
+    std::size_t         body_size;
+    std::size_t         connections;
+    lift::http::version version;
+    execution_mode      mode;
+    bool                timeouts;
+};
+
+struct scenario_result
+{
+    std::string name{};
+    uint64_t    requests{0};
+    uint64_t    errors{0};
+    double      throughput_rps{0};
+    double      latency_p50_us{0};
+    double      latency_p90_us{0};
+    double      latency_p99_us{0};
+    double      latency_p999_us{0};
+    double      cpu_us_per_request{0};
+    double      rss_kib{0};
+};
+
+static auto print_usage(const std::string& program_name) -> void
+{
+    std::cout << "Usage: " << program_name << " <options> <url>\n";
+    std::cout << "    -d --duration         Duration of each scenario in seconds, default=1.\n";
+    std::cout << "    -b --baseline         Baseline JSON file to compare against.\n";
+    std::cout << "    -o --output           File to write this run's results JSON to.\n";
+    std::cout << "    -T --tolerance        Allowed relative regression before failing, default=0.10.\n";
+    std::cout << "    -u --update-baseline  Write this run's results to the baseline file instead of comparing.\n";
+    std::cout << "    -f --filter           Only run scenarios whose name contains this value.\n";
+    std::cout << "    -p --post-url         Url accepting POST for the request body scenarios, skipped if not set.\n";
+    std::cout << "    -h --help             Print this help usage.\n";
+}
+
+static auto build_matrix() -> std::vector<scenario>
+{
+    std::vector<scenario> matrix{};
+
+    for (auto mode : {execution_mode::sync, execution_mode::async})
+    {
+        // HTTP/2 uses prior knowledge, plain http:// would otherwise negotiate down to HTTP/1.1.
+        for (auto version : {lift::http::version::v1_1, lift::http::version::v2_0_only})
+        {
+            for (std::size_t connections : {1, 16, 64})
+            {
+                for (std::size_t body_size : {0, 4096, 65536})
+                {
+                    for (bool timeouts : {false, true})
+                    {
+                        std::string name{};
+                        name += (mode == execution_mode::sync) ? "sync" : "async";
+                        name += (version == lift::http::version::v1_1) ? "_h1" : "_h2";
+                        name += "_c" + std::to_string(connections);
+                        name += "_b" + std::to_string(body_size);
+                        name += (timeouts) ? "_timeout" : "_notimeout";
+
+                        matrix.push_back(scenario{std::move(name), body_size, connections, version, mode, timeouts});
+                    }
+                }
+            }
+        }
+    }
+
+    return matrix;
+}
+
+static auto cpu_time() -> std::chrono::microseconds
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+    auto to_us = [](const timeval& tv)
+    { return std::chrono::seconds{tv.tv_sec} + std::chrono::microseconds{tv.tv_usec}; };
+
+    return to_us(usage.ru_utime) + to_us(usage.ru_stime);
+}
+
+static auto resident_set_kib() -> double
+{
+    std::ifstream statm{"/proc/self/statm"};
+    uint64_t      size_pages{0};
+    uint64_t      resident_pages{0};
+    statm >> size_pages >> resident_pages;
+    return static_cast<double>(resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE))) / 1024.0;
+}
+
+static auto percentile(const std::vector<uint32_t>& sorted_latencies, double p) -> double
+{
+    if (sorted_latencies.empty())
+    {
+        return 0;
+    }
+
+    auto index = static_cast<std::size_t>(p * static_cast<double>(sorted_latencies.size() - 1));
+    return sorted_latencies[index];
+}
+
+static auto make_request(const std::string& url, const scenario& s, const std::string& body) -> lift::request_ptr
+{
+    std::optional<std::chrono::milliseconds> timeout{std::nullopt};
+    if (s.timeouts)
+    {
+        timeout = 30s;
+    }
+
+    auto request_ptr = std::make_unique<lift::request>(url, timeout);
+    request_ptr->version(s.version);
+    request_ptr->follow_redirects(false);
+    request_ptr->header("Connection", "Keep-Alive");
+    if (!body.empty())
+    {
+        request_ptr->data(body);
+    }
+    return request_ptr;
+}
+
+/**
+ * @return True if the response failed, was not a 2xx or was served over a different HTTP version than
+ *         the scenario measures.
+ */
+static auto is_error(const scenario& s, const lift::response& response) -> bool
+{
+    if (response.lift_status() != lift::lift_status::success)
+    {
+        return true;
+    }
+
+    auto status = static_cast<uint32_t>(response.status_code());
+    if (status < 200 || status >= 300)
+    {
+        return true;
+    }
+
+    return s.version == lift::http::version::v2_0_only && response.version() != lift::http::version::v2_0;
+}
+
+static auto elapsed_us(std::chrono::steady_clock::time_point start) -> uint32_t
+{
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+}
+
+static auto run_sync(const std::string& url, const scenario& s, std::chrono::seconds duration, std::string& body)
+    -> std::pair<std::vector<uint32_t>, uint64_t>
+{
+    std::atomic<bool>     stop{false};
+    std::mutex            results_lock{};
+    std::vector<uint32_t> latencies{};
+    uint64_t              errors{0};
+
+    std::vector<std::thread> workers{};
+    workers.reserve(s.connections);
+    for (std::size_t i = 0; i < s.connections; ++i)
+    {
+        workers.emplace_back(
+            [&]()
+            {
+                // Each worker keeps its own share so its connection is re-used between requests.
+                auto                  share_ptr = lift::share::make_shared(lift::share::options::all);
+                std::vector<uint32_t> local_latencies{};
+                uint64_t              local_errors{0};
+
+                while (!stop.load(std::memory_order_acquire))
+                {
+                    auto request_ptr = make_request(url, s, body);
+                    auto start       = std::chrono::steady_clock::now();
+                    auto response    = request_ptr->perform(share_ptr);
+                    local_latencies.push_back(elapsed_us(start));
+                    if (is_error(s, response))
+                    {
+                        ++local_errors;
+                    }
+                }
+
+                std::scoped_lock<std::mutex> lk{results_lock};
+                latencies.insert(latencies.end(), local_latencies.begin(), local_latencies.end());
+                errors += local_errors;
+            });
+    }
+
+    std::this_thread::sleep_for(duration);
+    stop.store(true, std::memory_order_release);
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    return {std::move(latencies), errors};
+}
+
+static auto run_async(const std::string& url, const scenario& s, std::chrono::seconds duration, std::string& body)
+    -> std::pair<std::vector<uint32_t>, uint64_t>
+{
+    std::atomic<bool>     stop{false};
+    std::vector<uint32_t> latencies{};
+    uint64_t              errors{0};
+
+    std::vector<std::chrono::steady_clock::time_point> started(s.connections);
+    std::vector<lift::request::async_callback_type>    callbacks{};
+    callbacks.reserve(s.connections);
+
+    {
+        // A connect timeout larger than the request timeout drives the client's own timesup
+        // bookkeeping rather than letting curl handle the timeout.
+        std::optional<std::chrono::milliseconds> connect_timeout{std::nullopt};
+        if (s.timeouts)
+        {
+            connect_timeout = 60s;
+        }
+
+        lift::client client{lift::client::options{
+            .reserve_connections = s.connections,
+            .max_connections     = s.connections,
+            .connect_timeout     = connect_timeout}};
+
+        // Every callback is invoked on the client's event loop thread, so the latencies and errors
+        // do not require any synchronization.
+        for (std::size_t i = 0; i < s.connections; ++i)
+        {
+            callbacks.emplace_back(
+                [&, i](lift::request_ptr request_ptr, lift::response response)
+                {
+                    if (response.lift_status() == lift::lift_status::error_failed_to_start)
+                    {
+                        return;
+                    }
+
+                    latencies.push_back(elapsed_us(started[i]));
+                    if (is_error(s, response))
+                    {
+                        ++errors;
+                    }
+
+                    if (!stop.load(std::memory_order_acquire))
+                    {
+                        started[i] = std::chrono::steady_clock::now();
+                        client.start_request(std::move(request_ptr), callbacks[i]);
+                    }
+                });
+        }
+
+        for (std::size_t i = 0; i < s.connections; ++i)
+        {
+            started[i] = std::chrono::steady_clock::now();
+            client.start_request(make_request(url, s, body), callbacks[i]);
+        }
+
+        std::this_thread::sleep_for(duration);
+        stop.store(true, std::memory_order_release);
+
+        // The client destructor waits for the outstanding requests to drain.
+    }
+
+    return {std::move(latencies), errors};
+}
+
+static auto run_scenario(const std::string& url, const scenario& s, std::chrono::seconds duration) -> scenario_result
+{
+    std::string body(s.body_size, 'x');
+
+    auto cpu_start  = cpu_time();
+    auto wall_start = std::chrono::steady_clock::now();
+
+    auto [latencies, errors] =
+        (s.mode == execution_mode::sync) ? run_sync(url, s, duration, body) : run_async(url, s, duration, body);
+
+    auto wall_elapsed = std::chrono::steady_clock::now() - wall_start;
+    auto cpu_elapsed  = cpu_time() - cpu_start;
+
+    std::sort(latencies.begin(), latencies.end());
+
+    scenario_result result{};
+    result.name     = s.name;
+    result.requests = latencies.size();
+    result.errors   = errors;
+
+    auto wall_seconds = std::chrono::duration<double>{wall_elapsed}.count();
+    if (wall_seconds > 0)
+    {
+        result.throughput_rps = static_cast<double>(result.requests) / wall_seconds;
+    }
+    result.latency_p50_us  = percentile(latencies, 0.50);
+    result.latency_p90_us  = percentile(latencies, 0.90);
+    result.latency_p99_us  = percentile(latencies, 0.99);
+    result.latency_p999_us = percentile(latencies, 0.999);
+    if (result.requests > 0)
+    {
+        result.cpu_us_per_request =
+            static_cast<double>(cpu_elapsed.count()) / static_cast<double>(result.requests);
+    }
+    result.rss_kib = resident_set_kib();
+
+    return result;
+}
+
+static auto to_json(const std::string& url, std::chrono::seconds duration, const std::vector<scenario_result>& results)
+    -> std::string
+{
+    std::ostringstream os{};
+    os << std::fixed << std::setprecision(2);
+    os << "{\n";
+    os << "    \"version\": 1,\n";
+    os << "    \"url\": \"" << url << "\",\n";
+    os << "    \"duration_s\": " << duration.count() << ",\n";
+    os << "    \"scenarios\": [";
+
+    bool first{true};
+    for (const auto& r : results)
+    {
+        os << ((first) ? "\n" : ",\n");
+        first = false;
+
+        os << "        {\n";
+        os << "            \"name\": \"" << r.name << "\",\n";
+        os << "            \"requests\": " << r.requests << ",\n";
+        os << "            \"errors\": " << r.errors << ",\n";
+        os << "            \"throughput_rps\": " << r.throughput_rps << ",\n";
+        os << "            \"latency_p50_us\": " << r.latency_p50_us << ",\n";
+        os << "            \"latency_p90_us\": " << r.latency_p90_us << ",\n";
+        os << "            \"latency_p99_us\": " << r.latency_p99_us << ",\n";
+        os << "            \"latency_p999_us\": " << r.latency_p999_us << ",\n";
+        os << "            \"cpu_us_per_request\": " << r.cpu_us_per_request << ",\n";
+        os << "            \"rss_kib\": " << r.rss_kib << "\n";
+        os << "        }";
+    }
+
+    os << ((first) ? "]\n" : "\n    ]\n");
+    os << "}\n";
+    return os.str();
+}
+
+/**
+ * Minimal reader for the JSON format written by to_json(), each scenario object is located by its
+ * "name" key and the numeric fields are read from within that object's braces.
+ */
+static auto parse_baseline(const std::string& json) -> std::map<std::string, scenario_result>
+{
+    std::map<std::string, scenario_result> baseline{};
+
+    auto read_number = [](const std::string& object, const std::string& key) -> double
+    {
+        auto pos = object.find("\"" + key + "\"");
+        if (pos == std::string::npos)
+        {
+            return 0;
+        }
+        pos = object.find(':', pos);
+        if (pos == std::string::npos)
+        {
+            return 0;
+        }
+        return std::strtod(object.c_str() + pos + 1, nullptr);
+    };
+
+    std::size_t pos{0};
+    while ((pos = json.find("\"name\"", pos)) != std::string::npos)
+    {
+        auto object_begin = json.rfind('{', pos);
+        auto object_end   = json.find('}', pos);
+        auto value_begin  = json.find('"', json.find(':', pos) + 1);
+        auto value_end    = json.find('"', value_begin + 1);
+        if (object_begin == std::string::npos || object_end == std::string::npos || value_end == std::string::npos)
+        {
+            break;
+        }
+
+        auto object = json.substr(object_begin, object_end - object_begin + 1);
+
+        scenario_result r{};
+        r.name               = json.substr(value_begin + 1, value_end - value_begin - 1);
+        r.requests           = static_cast<uint64_t>(read_number(object, "requests"));
+        r.errors             = static_cast<uint64_t>(read_number(object, "errors"));
+        r.throughput_rps     = read_number(object, "throughput_rps");
+        r.latency_p50_us     = read_number(object, "latency_p50_us");
+        r.latency_p90_us     = read_number(object, "latency_p90_us");
+        r.latency_p99_us     = read_number(object, "latency_p99_us");
+        r.latency_p999_us    = read_number(object, "latency_p999_us");
+        r.cpu_us_per_request = read_number(object, "cpu_us_per_request");
+        r.rss_kib            = read_number(object, "rss_kib");
+        baseline.emplace(r.name, std::move(r));
+
+        pos = object_end;
+    }
+
+    return baseline;
+}
+
+/**
+ * @return The list of regressions for this result, empty if it is within tolerance of the baseline.
+ */
+static auto compare(const scenario_result& current, const scenario_result& base, double tolerance)
+    -> std::vector<std::string>
+{
+    std::vector<std::string> regressions{};
+
+    // Higher is better.
+    auto check_lower = [&](const char* metric, double now, double then)
+    {
+        if (then > 0 && now < then * (1.0 - tolerance))
+        {
+            regressions.emplace_back(
+                std::string{metric} + " " + std::to_string(now) + " < baseline " + std::to_string(then));
+        }
+    };
+
+    // Lower is better.
+    auto check_higher = [&](const char* metric, double now, double then)
+    {
+        if (then > 0 && now > then * (1.0 + tolerance))
+        {
+            regressions.emplace_back(
+                std::string{metric} + " " + std::to_string(now) + " > baseline " + std::to_string(then));
+        }
+    };
+
+    check_lower("throughput_rps", current.throughput_rps, base.throughput_rps);
+    check_higher("latency_p50_us", current.latency_p50_us, base.latency_p50_us);
+    check_higher("latency_p99_us", current.latency_p99_us, base.latency_p99_us);
+    check_higher("cpu_us_per_request", current.cpu_us_per_request, base.cpu_us_per_request);
+    check_higher("rss_kib", current.rss_kib, base.rss_kib);
+
+    if (current.errors > base.errors)
+    {
+        regressions.emplace_back(
+            "errors " + std::to_string(current.errors) + " > baseline " + std::to_string(base.errors));
+    }
+
+    return regressions;
+}
+
+int main(int argc, char* argv[])
+{
+    constexpr char   short_options[] = "d:b:o:T:f:p:uh";
+    constexpr option long_options[]  = {
+        {"help", no_argument, nullptr, 'h'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"baseline", required_argument, nullptr, 'b'},
+        {"output", required_argument, nullptr, 'o'},
+        {"tolerance", required_argument, nullptr, 'T'},
+        {"update-baseline", no_argument, nullptr, 'u'},
+        {"filter", required_argument, nullptr, 'f'},
+        {"post-url", required_argument, nullptr, 'p'},
+        {nullptr, 0, nullptr, 0}};
+
+    int option_index = 0;
+    int opt          = 0;
+
+    std::chrono::seconds       duration{1};
+    std::optional<std::string> baseline_path{};
+    std::optional<std::string> output_path{};
+    std::optional<std::string> filter{};
+    std::optional<std::string> post_url{};
+    double                     tolerance{0.10};
+    bool                       update_baseline{false};
+
+    while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            case 'd':
+                duration = std::chrono::seconds{std::stol(optarg)};
+                break;
+            case 'b':
+                baseline_path = optarg;
+                break;
+            case 'o':
+                output_path = optarg;
+                break;
+            case 'T':
+                tolerance = std::stod(optarg);
+                break;
+            case 'u':
+                update_baseline = true;
+                break;
+            case 'f':
+                filter = optarg;
+                break;
+            case 'p':
+                post_url = optarg;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc || (update_baseline && !baseline_path.has_value()))
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string url{argv[optind]};
+
+    std::vector<scenario_result> results{};
+    for (const auto& s : build_matrix())
+    {
+        if (filter.has_value() && s.name.find(filter.value()) == std::string::npos)
+        {
+            continue;
+        }
+
+        // A static server rejects POST, the body scenarios only run against a url that accepts it.
+        if (s.body_size > 0 && !post_url.has_value())
+        {
+            continue;
+        }
+
+        auto r = run_scenario((s.body_size > 0) ? post_url.value() : url, s, duration);
+        std::cout << std::left << std::setw(32) << r.name << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(10) << r.throughput_rps << " req/s  p50 " << std::setw(7) << r.latency_p50_us
+                  << "us  p99 " << std::setw(7) << r.latency_p99_us << "us  cpu/req " << std::setprecision(1)
+                  << std::setw(6) << r.cpu_us_per_request << "us  rss " << std::setprecision(0) << r.rss_kib
+                  << "KiB  errors " << r.errors << "\n";
+        results.push_back(std::move(r));
+    }
+
+    auto json = to_json(url, duration, results);
+
+    if (output_path.has_value())
+    {
+        std::ofstream{output_path.value()} << json;
+    }
+
+    if (update_baseline)
+    {
+        std::ofstream{baseline_path.value()} << json;
+        std::cout << "Baseline written to " << baseline_path.value() << "\n";
+        return EXIT_SUCCESS;
+    }
+
+    if (!baseline_path.has_value())
+    {
+        return EXIT_SUCCESS;
+    }
+
+    std::ifstream     baseline_file{baseline_path.value()};
+    std::stringstream baseline_contents{};
+    baseline_contents << baseline_file.rdbuf();
+    auto baseline = parse_baseline(baseline_contents.str());
+
+    uint64_t regressed{0};
+    for (const auto& r : results)
+    {
+        auto found = baseline.find(r.name);
+        if (found == baseline.end())
+        {
+            std::cout << "NEW         " << r.name << " (no baseline recorded)\n";
+            continue;
+        }
+
+        auto regressions = compare(r, found->second, tolerance);
+        if (regressions.empty())
+        {
+            std::cout << "OK          " << r.name << "\n";
+        }
+        else
+        {
+            ++regressed;
+            for (const auto& regression : regressions)
+            {
+                std::cout << "REGRESSION  " << r.name << " " << regression << "\n";
+            }
+        }
+    }
+
+    std::cout << regressed << " of " << results.size() << " scenarios regressed beyond " << (tolerance * 100.0)
+              << "% tolerance.\n";
+
+    return (regressed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
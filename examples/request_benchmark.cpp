@@ -0,0 +1,206 @@
+#include <lift/lift.hpp>
+
+#include <chrono>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * Measures the in memory footprint of lift::request and what it costs to construct, move and copy
+ * one.  A request is moved into and back out of the client for every asynchronous execution and
+ * is copied once if it times out, so these costs are paid per request on top of the transfer.
+ * Each operation is measured on a typical request (url, timeout, a few headers) and, with -c, on
+ * one that also sets the rarely used TLS, proxy and debug settings.
+ *
+ * Fan-out, retries and hedging send "the same request, slightly different", so the cost of a 1 to
+ * 50 fan-out of a request with a 10KB body and 20 headers is also measured: once with every copy
+ * left unchanged, once with every copy given its own url and once with every copy also given its
+ * own header.
+ */
+
+static auto print_usage(const std::string& program_name) -> void
+{
+    std::cout << "Usage: " << program_name << " <options>\n";
+    std::cout << "    -n --iterations  Iterations per measurement, default=1000000.\n";
+    std::cout << "    -c --cold        Also set the TLS, proxy and debug settings on every request.\n";
+    std::cout << "    -h --help        Print this help usage.\n";
+}
+
+static auto make_request(bool cold) -> lift::request
+{
+    lift::request request{"http://localhost:80/some/path?query=value", 10s};
+    request.header("Accept", "application/json");
+    request.header("Connection", "keep-alive");
+    request.header("X-Request-Id", "0123456789abcdef");
+
+    if (cold)
+    {
+        request.ssl_cert("/etc/ssl/certs/client.pem");
+        request.ssl_cert_type(lift::ssl_certificate_type::pem);
+        request.ssl_key("/etc/ssl/private/client.key");
+        request.key_password("password");
+        request.proxy(lift::proxy_type::http, "proxy.localhost", 3128, "user", "pass");
+        request.happy_eyeballs_timeout(100ms);
+        request.debug_info_handler([](const lift::request&, lift::debug_info_type, std::string_view) {});
+    }
+
+    return request;
+}
+
+static auto make_fan_out_request() -> lift::request
+{
+    lift::request request{"http://localhost:80/some/path?query=value", 10s};
+    for (std::size_t i = 0; i < 20; ++i)
+    {
+        request.header("X-Lift-Header-" + std::to_string(i), "header value number " + std::to_string(i));
+    }
+    request.data(std::string(10 * 1024, 'x'));
+    return request;
+}
+
+template<typename functor_type>
+static auto measure_ns(uint64_t iterations, functor_type&& functor) -> double
+{
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i)
+    {
+        functor();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / static_cast<double>(iterations);
+}
+
+int main(int argc, char* argv[])
+{
+    constexpr char   short_options[] = "n:ch";
+    constexpr option long_options[]  = {
+        {"help", no_argument, nullptr, 'h'},
+        {"iterations", required_argument, nullptr, 'n'},
+        {"cold", no_argument, nullptr, 'c'},
+        {nullptr, 0, nullptr, 0}};
+
+    int option_index = 0;
+    int opt          = 0;
+
+    uint64_t iterations{1'000'000};
+    bool     cold{false};
+
+    while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            case 'n':
+                iterations = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'c':
+                cold = true;
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    // Keeps the optimizer from discarding the measured work.
+    uint64_t sink{0};
+
+    auto construct_ns = measure_ns(
+        iterations,
+        [&]()
+        {
+            auto request = make_request(cold);
+            sink += request.url().size();
+        });
+
+    // Ping pong between two requests so every iteration is a real move of a fully set request.
+    auto a       = make_request(cold);
+    auto b       = make_request(cold);
+    auto move_ns = measure_ns(
+        iterations,
+        [&]()
+        {
+            b = std::move(a);
+            a = std::move(b);
+            sink += a.url().size();
+        });
+
+    auto original = make_request(cold);
+    auto copy_ns  = measure_ns(
+        iterations,
+        [&]()
+        {
+            lift::request copy{original};
+            sink += copy.url().size();
+        });
+
+    // Fan-out is 50 copies per iteration, run fewer iterations so it takes about as long as the rest.
+    constexpr std::size_t fan_out{50};
+    auto                  fan_out_iterations = std::max<uint64_t>(1, iterations / fan_out);
+    auto                  fan_out_original   = make_fan_out_request();
+
+    std::vector<std::string> fan_out_urls{};
+    for (std::size_t i = 0; i < fan_out; ++i)
+    {
+        fan_out_urls.emplace_back("http://shard-" + std::to_string(i) + ".localhost:80/some/path?query=value");
+    }
+
+    std::vector<lift::request> fan_out_copies{};
+    fan_out_copies.reserve(fan_out);
+
+    auto fan_out_ns = measure_ns(
+        fan_out_iterations,
+        [&]()
+        {
+            fan_out_copies.clear();
+            for (std::size_t i = 0; i < fan_out; ++i)
+            {
+                fan_out_copies.emplace_back(fan_out_original);
+            }
+            sink += fan_out_copies.back().data().size();
+        });
+
+    auto fan_out_url_ns = measure_ns(
+        fan_out_iterations,
+        [&]()
+        {
+            fan_out_copies.clear();
+            for (std::size_t i = 0; i < fan_out; ++i)
+            {
+                fan_out_copies.emplace_back(fan_out_original).url(fan_out_urls[i]);
+            }
+            sink += fan_out_copies.back().url().size();
+        });
+
+    auto fan_out_header_ns = measure_ns(
+        fan_out_iterations,
+        [&]()
+        {
+            fan_out_copies.clear();
+            for (std::size_t i = 0; i < fan_out; ++i)
+            {
+                auto& copy = fan_out_copies.emplace_back(fan_out_original);
+                copy.url(fan_out_urls[i]);
+                copy.header("X-Lift-Shard", fan_out_urls[i]);
+            }
+            sink += fan_out_copies.back().headers().size();
+        });
+    fan_out_copies.clear();
+
+    std::cout << "sizeof(lift::request): " << sizeof(lift::request) << " bytes\n";
+    std::cout << "Request settings:      " << (cold ? "typical + TLS/proxy/debug" : "typical") << "\n";
+    std::cout << "Construct:             " << construct_ns << "ns\n";
+    std::cout << "Move (x2):             " << move_ns << "ns\n";
+    std::cout << "Copy:                  " << copy_ns << "ns\n";
+    std::cout << "Fan-out 1->50 (10KB body, 20 headers)\n";
+    std::cout << "    Unchanged copies:  " << fan_out_ns / 1000.0 << "us\n";
+    std::cout << "    Own url:           " << fan_out_url_ns / 1000.0 << "us\n";
+    std::cout << "    Own url + header:  " << fan_out_header_ns / 1000.0 << "us\n";
+
+    return (sink == 0) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
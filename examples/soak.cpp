@@ -0,0 +1,217 @@
+#include <lift/lift.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+#endif
+
+using namespace std::chrono_literals;
+
+/**
+ * Compresses many hours of bursty traffic into a short run.  Every cycle simulates a number of
+ * minutes of traffic: a burst of requests whose size swings between quiet and peak load, followed
+ * by an idle period long enough for the client to trim its pools.  After each idle period the
+ * resident set size and the client's pool metrics are sampled, the run fails if memory keeps
+ * growing past the warmed up baseline or if the pools did not shrink back to their reserved size.
+ */
+
+static auto print_usage(const std::string& program_name) -> void
+{
+    std::cout << "Usage: " << program_name << " <options> <url>\n";
+    std::cout << "    -H --hours            Simulated hours of traffic, default=24.\n";
+    std::cout << "    -m --cycle-minutes    Simulated minutes per burst/idle cycle, default=10.\n";
+    std::cout << "    -p --peak             Requests in the largest burst, default=1024.\n";
+    std::cout << "    -r --reserve          Executors reserved by the client, default=8.\n";
+    std::cout << "    -t --trim-interval    Client pool trim interval in milliseconds, default=50.\n";
+    std::cout << "    -w --warmup           Cycles run before the memory baseline is taken, default=3.\n";
+    std::cout << "    -T --tolerance        Allowed relative RSS growth over the baseline, default=0.10.\n";
+    std::cout << "    -h --help             Print this help usage.\n";
+}
+
+static auto resident_set_kib() -> uint64_t
+{
+#if defined(__GLIBC__)
+    // Hand freed arenas back to the kernel so the sample reflects what is actually still held.
+    malloc_trim(0);
+#endif
+    std::ifstream statm{"/proc/self/statm"};
+    uint64_t      size_pages{0};
+    uint64_t      resident_pages{0};
+    statm >> size_pages >> resident_pages;
+    return (resident_pages * static_cast<uint64_t>(sysconf(_SC_PAGESIZE))) / 1024;
+}
+
+static auto run_burst(lift::client& client, const std::string& url, std::size_t count) -> uint64_t
+{
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> errors{0};
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        client.start_request(
+            std::make_unique<lift::request>(url, std::chrono::seconds{10}),
+            [&](lift::request_ptr, lift::response response)
+            {
+                if (response.lift_status() != lift::lift_status::success)
+                {
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                }
+                completed.fetch_add(1, std::memory_order_release);
+            });
+    }
+
+    while (completed.load(std::memory_order_acquire) < count)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    return errors.load(std::memory_order_relaxed);
+}
+
+int main(int argc, char* argv[])
+{
+    constexpr char   short_options[] = "H:m:p:r:t:w:T:h";
+    constexpr option long_options[]  = {
+        {"help", no_argument, nullptr, 'h'},
+        {"hours", required_argument, nullptr, 'H'},
+        {"cycle-minutes", required_argument, nullptr, 'm'},
+        {"peak", required_argument, nullptr, 'p'},
+        {"reserve", required_argument, nullptr, 'r'},
+        {"trim-interval", required_argument, nullptr, 't'},
+        {"warmup", required_argument, nullptr, 'w'},
+        {"tolerance", required_argument, nullptr, 'T'},
+        {nullptr, 0, nullptr, 0}};
+
+    int option_index = 0;
+    int opt          = 0;
+
+    uint64_t                  hours{24};
+    uint64_t                  cycle_minutes{10};
+    std::size_t               peak{1024};
+    std::size_t               reserve{8};
+    std::chrono::milliseconds trim_interval{50};
+    uint64_t                  warmup_cycles{3};
+    double                    tolerance{0.10};
+
+    while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            case 'H':
+                hours = std::stoul(optarg);
+                break;
+            case 'm':
+                cycle_minutes = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'p':
+                peak = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'r':
+                reserve = std::stoul(optarg);
+                break;
+            case 't':
+                trim_interval = std::chrono::milliseconds{std::max(1l, std::stol(optarg))};
+                break;
+            case 'w':
+                warmup_cycles = std::stoul(optarg);
+                break;
+            case 'T':
+                tolerance = std::stod(optarg);
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string url{argv[optind]};
+    uint64_t    cycles = std::max<uint64_t>(warmup_cycles + 1, (hours * 60) / cycle_minutes);
+
+    lift::client client{lift::client::options{.reserve_connections = reserve, .pool_trim_interval = trim_interval}};
+
+    // A fixed seed keeps the traffic shape identical between runs so results are comparable.
+    std::mt19937                               rng{0x5eed};
+    std::uniform_int_distribution<std::size_t> burst_distribution{1, peak};
+
+    uint64_t baseline_rss_kib{0};
+    uint64_t peak_rss_kib{0};
+    uint64_t total_requests{0};
+    uint64_t total_errors{0};
+    uint64_t failed_cycles{0};
+
+    for (uint64_t cycle = 0; cycle < cycles; ++cycle)
+    {
+        // Every fourth cycle is a full peak so the pools are pushed to their largest size regularly.
+        auto burst = (cycle % 4 == 0) ? peak : burst_distribution(rng);
+        total_errors += run_burst(client, url, burst);
+        total_requests += burst;
+
+        // Idle long enough for at least two trim ticks, anything pooled through the whole first
+        // tick is released on the second.
+        std::this_thread::sleep_for(trim_interval * 3);
+
+        auto rss     = resident_set_kib();
+        auto metrics = client.metrics();
+        peak_rss_kib = std::max(peak_rss_kib, rss);
+
+        if (cycle + 1 == warmup_cycles || (warmup_cycles == 0 && cycle == 0))
+        {
+            baseline_rss_kib = rss;
+        }
+
+        bool pools_returned = metrics.executors_total <= reserve && metrics.curl_contexts_pooled == 0 &&
+                              metrics.request_queue_capacity == 0 && metrics.timeouts_pending == 0;
+        bool rss_ok = baseline_rss_kib == 0 ||
+                      static_cast<double>(rss) <= static_cast<double>(baseline_rss_kib) * (1.0 + tolerance);
+
+        bool failed = cycle >= warmup_cycles && (!pools_returned || !rss_ok);
+        if (failed)
+        {
+            ++failed_cycles;
+        }
+
+        auto simulated_minutes = (cycle + 1) * cycle_minutes;
+        std::cout << "t+" << std::setw(3) << simulated_minutes / 60 << "h" << std::setw(2) << std::setfill('0')
+                  << simulated_minutes % 60 << std::setfill(' ') << "m  burst " << std::setw(6) << burst << "  rss "
+                  << std::setw(8) << rss << "KiB  executors " << metrics.executors_total << "/"
+                  << metrics.executors_pooled << "  curl_contexts " << metrics.curl_contexts_pooled << "  queue_cap "
+                  << metrics.request_queue_capacity << "  timeouts " << metrics.timeouts_pending
+                  << (failed ? "  FAIL" : "") << "\n";
+    }
+
+    std::cout << "\n";
+    std::cout << "Cycles:        " << cycles << " (" << hours << " simulated hours)\n";
+    std::cout << "Requests:      " << total_requests << " (" << total_errors << " errors)\n";
+    std::cout << "Baseline RSS:  " << baseline_rss_kib << "KiB\n";
+    std::cout << "Peak RSS:      " << peak_rss_kib << "KiB\n";
+
+    if (failed_cycles > 0)
+    {
+        std::cout << "FAILED: " << failed_cycles << " cycle(s) grew memory or did not return their pools.\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "PASSED\n";
+    return EXIT_SUCCESS;
+}
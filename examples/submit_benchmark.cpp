@@ -0,0 +1,162 @@
+#include <lift/lift.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * Measures the cost of lift::client::start_request() on the submitting threads.  Each producer
+ * thread submits its requests in bursts and records how many write syscalls it issued while doing
+ * so (from /proc/thread-self/io), every wake-up of the event loop is an eventfd write so this is
+ * the number of times a submitter had to wake the loop.  Without wake-up coalescing this would be
+ * one syscall per submission.
+ */
+
+static auto print_usage(const std::string& program_name) -> void
+{
+    std::cout << "Usage: " << program_name << " <options> <url>\n";
+    std::cout << "    -p --producers  Number of submitting threads, default=4.\n";
+    std::cout << "    -n --requests   Requests submitted per producer, default=10000.\n";
+    std::cout << "    -b --burst      Requests submitted back to back before the producer pauses, default=16.\n";
+    std::cout << "    -i --interval   Pause between bursts in microseconds, default=2000.\n";
+    std::cout << "    -h --help       Print this help usage.\n";
+}
+
+/**
+ * @return The number of write syscalls the calling thread has made.
+ */
+static auto thread_write_syscalls() -> uint64_t
+{
+    std::ifstream io{"/proc/thread-self/io"};
+    std::string   key{};
+    uint64_t      value{0};
+    while (io >> key >> value)
+    {
+        if (key == "syscw:")
+        {
+            return value;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    constexpr char   short_options[] = "p:n:b:i:h";
+    constexpr option long_options[]  = {
+        {"help", no_argument, nullptr, 'h'},
+        {"producers", required_argument, nullptr, 'p'},
+        {"requests", required_argument, nullptr, 'n'},
+        {"burst", required_argument, nullptr, 'b'},
+        {"interval", required_argument, nullptr, 'i'},
+        {nullptr, 0, nullptr, 0}};
+
+    int option_index = 0;
+    int opt          = 0;
+
+    uint64_t                  producers{4};
+    uint64_t                  requests{10'000};
+    uint64_t                  burst{16};
+    std::chrono::microseconds interval{2000};
+
+    while ((opt = getopt_long(argc, argv, short_options, long_options, &option_index)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                print_usage(argv[0]);
+                return EXIT_SUCCESS;
+            case 'p':
+                producers = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'n':
+                requests = std::stoul(optarg);
+                break;
+            case 'b':
+                burst = std::max(1ul, std::stoul(optarg));
+                break;
+            case 'i':
+                interval = std::chrono::microseconds{std::stol(optarg)};
+                break;
+            default:
+                print_usage(argv[0]);
+                return EXIT_FAILURE;
+        }
+    }
+
+    if (optind >= argc)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string url{argv[optind]};
+
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> producer_syscalls{0};
+    std::atomic<uint64_t> producer_ns{0};
+
+    lift::client client{};
+
+    std::vector<std::thread> threads{};
+    for (uint64_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back(
+            [&]()
+            {
+                uint64_t submit_ns{0};
+                auto     syscalls_start = thread_write_syscalls();
+
+                for (uint64_t i = 0; i < requests; ++i)
+                {
+                    auto request_ptr = std::make_unique<lift::request>(url, 30s);
+
+                    auto start = std::chrono::steady_clock::now();
+                    client.start_request(
+                        std::move(request_ptr),
+                        [&](lift::request_ptr, lift::response) { completed.fetch_add(1, std::memory_order_relaxed); });
+                    submit_ns += static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start)
+                            .count());
+
+                    // Pause between bursts to let the event loop drain and fall back asleep.
+                    if ((i + 1) % burst == 0)
+                    {
+                        std::this_thread::sleep_for(interval);
+                    }
+                }
+
+                // Measured before anything else on this thread can issue a write.
+                producer_syscalls.fetch_add(thread_write_syscalls() - syscalls_start, std::memory_order_relaxed);
+                producer_ns.fetch_add(submit_ns, std::memory_order_relaxed);
+            });
+    }
+
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    while (!client.empty())
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+
+    auto total   = producers * requests;
+    auto metrics = client.metrics();
+
+    std::cout << "Submissions:             " << total << " (" << completed.load() << " completed)\n";
+    std::cout << "Producer write syscalls: " << producer_syscalls.load() << "\n";
+    std::cout << "Syscalls/submission:     " << (producer_syscalls.load() / static_cast<double>(total)) << "\n";
+    std::cout << "Loop wakeups:            " << metrics.loop_wakeups << "\n";
+    std::cout << "Submit cost:             " << (producer_ns.load() / static_cast<double>(total)) << "ns\n";
+
+    return EXIT_SUCCESS;
+}
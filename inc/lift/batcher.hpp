@@ -0,0 +1,128 @@
+#pragma once
+
+#include "lift/lift_status.hpp"
+#include "lift/request.hpp"
+#include "lift/response.hpp"
+
+#include <uv.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lift
+{
+class client;
+
+/**
+ * Combines small requests for an endpoint with a batch API into batch requests.  Items submitted
+ * from any thread are collected until `window` has passed since the first of them or `max_batch_size`
+ * items are waiting, then `merge` builds one request for all of them and the client executes it.
+ * When the batch completes `split` demultiplexes its response into one result per item and every
+ * item's callback is called with its own result.  The collecting is driven by a timer on the
+ * client's event loop, items, merging, splitting and callbacks all run on the event loop thread.
+ *
+ * The batcher must be destroyed before its client and not on the client's event loop thread, the
+ * items still waiting when it is destroyed are sent as a final batch.
+ */
+class batcher
+{
+    friend auto on_uv_batcher_timer_callback(uv_timer_t* handle) -> void;
+
+public:
+    /// Called with an item's result, the result is only meaningful if the status is success.
+    using item_callback_type = std::function<void(lift::lift_status status, std::string result)>;
+    /// Builds the batch request for the items, in the order they were submitted.  Returning nullptr
+    /// fails every item with error_failed_to_start.
+    using merge_type = std::function<request_ptr(const std::vector<std::string>& items)>;
+    /// Splits a successful batch response into one result per item, in the same order as the items.
+    /// An item without a result, because it is nullopt or missing, fails with error.
+    using split_type = std::function<std::vector<std::optional<std::string>>(
+        const lift::response& response, const std::vector<std::string>& items)>;
+
+    struct options
+    {
+        /// How long the first item of a batch waits for more items.
+        std::chrono::milliseconds window{std::chrono::milliseconds{5}};
+        /// The most items in one batch, a full batch is sent without waiting for the window.
+        std::size_t max_batch_size{64};
+        /// Builds each batch request, required.
+        merge_type merge{nullptr};
+        /// Demultiplexes each batch response, required.
+        split_type split{nullptr};
+    };
+
+    /**
+     * @param client The client executing the batch requests, it must outlive the batcher.
+     * @param opts The batching window, size and the merge and split functions.
+     * @throw std::runtime_error If merge or split are not set.
+     */
+    batcher(lift::client& client, options opts);
+    ~batcher();
+
+    batcher(const batcher&) = delete;
+    batcher(batcher&&)      = delete;
+    auto operator=(const batcher&) -> batcher& = delete;
+    auto operator=(batcher&&) -> batcher& = delete;
+
+    /**
+     * Adds an item to the next batch.  This function is thread safe.
+     * @param item The item's part of the batch request, handed to merge and split.
+     * @param callback Called on the client's event loop thread with the item's result.
+     * @throw std::runtime_error If the callback is nullptr.
+     */
+    auto submit(std::string item, item_callback_type callback) -> void;
+
+    /**
+     * @return The number of items submitted so far.
+     */
+    [[nodiscard]] auto items() const -> uint64_t { return m_items_submitted.load(std::memory_order_relaxed); }
+
+    /**
+     * @return The number of batch requests sent so far.
+     */
+    [[nodiscard]] auto batches() const -> uint64_t { return m_batches_sent.load(std::memory_order_relaxed); }
+
+private:
+    struct pending_item
+    {
+        std::string        item{};
+        item_callback_type callback{nullptr};
+    };
+
+    /// The client executing the batches.
+    lift::client& m_client;
+    /// How long the first item of a batch waits for more items, in ms.
+    uint64_t m_window_ms{0};
+    /// The most items in one batch.
+    std::size_t m_max_batch_size{1};
+    /// Builds each batch request, only called on the event loop thread.
+    merge_type m_merge{nullptr};
+    /// Shared with the batches in flight so they can still be split after the batcher is destroyed.
+    std::shared_ptr<const split_type> m_split{nullptr};
+
+    /// The items waiting for the next batch, guarded by m_items_lock.
+    std::vector<pending_item> m_items{};
+    std::mutex                m_items_lock{};
+
+    /// Sends a partial batch once its window has passed, only used on the event loop thread.
+    uv_timer_t m_timer{};
+
+    std::atomic<uint64_t> m_items_submitted{0};
+    std::atomic<uint64_t> m_batches_sent{0};
+
+    /**
+     * Sends the waiting items, in batches of at most m_max_batch_size.  Only called on the event
+     * loop thread.
+     * @param full_only If true only full batches are sent and the rest keep waiting for their window.
+     */
+    auto flush(bool full_only) -> void;
+};
+
+} // namespace lift
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "lift/executor.hpp"
+#include "lift/inflight.hpp"
 #include "lift/request.hpp"
 #include "lift/resolve_host.hpp"
 #include "lift/share.hpp"
@@ -10,6 +11,9 @@
 
 #include <array>
 #include <atomic>
+#include <deque>
+#include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -19,11 +23,243 @@
 
 namespace lift
 {
+class batcher;
 class curl_context;
 using curl_context_ptr = std::unique_ptr<curl_context>;
 
+namespace impl
+{
+class io_uring_poller;
+class file_reader;
+
+/**
+ * The demand a client has seen for a single host (scheme://host:port), see client::options::predictive_pool.
+ * Only used on the client's event loop thread, except that libcurl may close a connection on any thread
+ * that cleans up the multi handle.
+ */
+struct host_demand
+{
+    /// The url warm-up requests are sent to, the host's root.
+    std::string warmup_url{};
+    /// The number of user requests to the host currently executing.
+    uint64_t in_flight{0};
+    /// The most user requests in flight at once during the current interval.
+    uint64_t peak{0};
+    /// The moving average of each interval's peak, the predicted demand.
+    double average{0.0};
+    /// The number of connections kept open to the host.
+    uint64_t target{0};
+    /// The number of sockets opened to the host by this client that are not closed yet.
+    uint64_t open_connections{0};
+    /// The number of warm-up requests to the host currently executing.
+    uint64_t warming{0};
+};
+
+/**
+ * A tenant's admission queue and counters, see client::options::fair_queuing.  The queue and
+ * scheduling state are only used on the client's event loop thread, the counters are read by
+ * client::metrics() from any thread.
+ */
+struct tenant_queue
+{
+    /// A request waiting for admission.
+    struct queued_request
+    {
+        request_ptr request{nullptr};
+        /// When the event loop queued the request, uv_now().
+        uint64_t queued_at{0};
+    };
+
+    /// The tenant's share relative to the other tenants.
+    uint64_t weight{1};
+    /// The most of the tenant's requests executing at once, if set.
+    std::optional<uint64_t> max_in_flight{std::nullopt};
+    /// The tenant's requests waiting for admission, oldest first.
+    std::deque<queued_request> queue{};
+    /// The tenant's requests currently executing.
+    uint64_t in_flight{0};
+    /// The requests the tenant may still start in its current turn.
+    uint64_t deficit{0};
+    /// Has the tenant been given its weight for its current turn?
+    bool credited{false};
+    /// Is the tenant in the rotation of tenants with queued requests?
+    bool active{false};
+
+    std::atomic<uint64_t> queued_count{0};
+    std::atomic<uint64_t> in_flight_count{0};
+    std::atomic<uint64_t> admitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> wait_time_ms{0};
+    std::atomic<uint64_t> max_wait_time_ms{0};
+};
+} // namespace impl
+
+/**
+ * How the client's event loop is notified about socket readiness for libcurl.
+ */
+enum class socket_backend
+{
+    /// One uv_poll_t per socket, every interest change is an epoll_ctl.
+    uv_poll,
+    /// A single io_uring, interest changes are batched into one io_uring_enter per loop iteration.
+    /// Requires liblifthttp to be built with LIFT_IO_URING and a Linux kernel with io_uring enabled.
+    io_uring
+};
+
+/**
+ * What happens to a transfer that is still running when its request reaches timesup.  Transfers
+ * only outlive their timesup when the connect timeout is longer than the request's timeout, the
+ * user has already received the timeout response so these transfers are orphans.
+ */
+enum class orphan_policy
+{
+    /// Abort the transfer at timesup, a connection still being set up is closed.
+    abort,
+    /// Keep the transfer only until its connection is established and abort it before the request
+    /// is sent.  libcurl only keeps the connection of an aborted transfer open when it is multiplexed
+    /// (HTTP/2), an HTTP/1.x connection is closed but DNS and TLS session caches have been warmed.
+    /// Requires libcurl 7.80.0 or newer, older versions behave as keep_to_completion.
+    keep_until_connected,
+    /// Keep the transfer until it completes or reaches the connect timeout, a transfer that completes
+    /// leaves its connection open for later requests.
+    keep_to_completion
+};
+
+/**
+ * A local address and port range a client binds new connections to, see
+ * client::options::source_addresses.
+ */
+struct source_address
+{
+    /// The local interface name, IP address or host name to bind to, see CURLOPT_INTERFACE for the
+    /// "if!" and "host!" prefixes.  Empty binds to any local address, e.g. to only set a port range.
+    std::string address{};
+    /// The first local port to try, if not set the kernel picks an ephemeral port.
+    std::optional<uint16_t> port{std::nullopt};
+    /// The number of ports starting at `port` that are tried until one is free.
+    uint16_t port_range{1};
+};
+
+/**
+ * Opens and keeps connections and executors ahead of the demand a client predicts from its own
+ * traffic, see client::options::predictive_pool.  Every interval the client samples the most requests
+ * it had in flight at once to each host (scheme://host:port) and folds that into an exponentially
+ * weighted moving average.  Each host is then kept at ceil(average * headroom) open connections:
+ * missing connections are opened with HEAD requests to the host's root, libcurl's connection cache
+ * is sized so it keeps them and the executor pool is kept at the total.
+ */
+struct predictive_pool
+{
+    /// How often demand is sampled and the pool adjusted.
+    std::chrono::milliseconds interval{std::chrono::milliseconds{250}};
+    /// The weight of the newest sample in the moving average, between 0 and 1.  Higher values follow
+    /// changes in traffic faster, lower values ride out short gaps between bursts.
+    double smoothing{0.2};
+    /// The connections kept per host as a multiple of its predicted demand.
+    double headroom{1.25};
+    /// The most connections kept open to a single host.
+    uint64_t max_connections_per_host{64};
+    /// The most connections, and executors, kept across all hosts.  client::options::max_connections
+    /// also caps this when it is set.
+    uint64_t max_connections{256};
+    /// The most warm-up requests started per interval, spreads the handshakes of a ramp.
+    uint64_t max_warmups_per_interval{16};
+};
+
+/**
+ * A tenant's share of a client, see client::options::fair_queuing.
+ */
+struct tenant
+{
+    /// The tenant requests are tagged with, see request::tenant().
+    std::string name{};
+    /// The tenant's share of the client's in-flight requests relative to the other tenants, a
+    /// tenant with weight 3 starts three requests for every one a tenant with weight 1 starts while
+    /// both have requests waiting.
+    uint64_t weight{1};
+    /// The most of the tenant's requests executing at once, even if the client has room for more.
+    std::optional<uint64_t> max_in_flight{std::nullopt};
+};
+
+/**
+ * Schedules requests from several tenants sharing a client with deficit round robin, see
+ * client::options::fair_queuing.  At most max_in_flight requests execute at once, the rest wait in
+ * a queue per tenant.  Whenever there is room the tenants with waiting requests take turns, each
+ * starting up to its weight in requests per turn, so every tenant keeps its share no matter how many
+ * requests another tenant has queued.  A request's timeout starts once it is admitted.
+ */
+struct fair_queuing
+{
+    /// The most requests executing at once across every tenant.
+    uint64_t max_in_flight{64};
+    /// The tenants with their own weight or cap, any other tenant gets the defaults below.
+    std::vector<lift::tenant> tenants{};
+    /// The weight of tenants not in `tenants`, including the default (empty) tenant.
+    uint64_t default_weight{1};
+    /// The cap of tenants not in `tenants`, including the default (empty) tenant.
+    std::optional<uint64_t> default_max_in_flight{std::nullopt};
+};
+
+/**
+ * Mirrors a sample of a client's requests to a shadow endpoint, see client::options::mirror.  The
+ * shadow copies are fire-and-forget: they share the original's url, headers and body until one is
+ * changed, their responses are discarded as they arrive instead of being buffered and they are
+ * started after the original requests they copy.
+ */
+struct mirror
+{
+    /// The fraction of requests mirrored, between 0 and 1.  Requests are sampled evenly, e.g. 0.25
+    /// mirrors every fourth request.
+    double rate{0.0};
+    /// The scheme://host:port copies are sent to instead of the original's, the path and query are
+    /// kept.  Empty keeps the original's.
+    std::string target{};
+    /// Called on the event loop thread to change each copy before it is sent, e.g. to tag it with a
+    /// header.  It must not block.
+    std::function<void(lift::request& shadow)> rewrite{nullptr};
+    /// The most copies executing at once, copies beyond it are dropped.  Each copy holds at most one
+    /// connection so this also caps the connections to the shadow endpoint, the client's connection
+    /// cache is grown by this many so the copies never evict the client's own idle connections.
+    uint64_t max_in_flight{16};
+    /// How long a copy may take, copies ignore the original's timeouts.
+    std::chrono::milliseconds timeout{std::chrono::seconds{5}};
+    /// If set mirroring pauses, and the copies executing are aborted, while more than this many of
+    /// the client's own requests are executing or waiting.
+    std::optional<uint64_t> shed_above{std::nullopt};
+};
+
+/**
+ * Request settings shared by every request executed through a client.  Each value is only applied
+ * when the request itself did not set it, so requests only need to carry what differs from these.
+ * The header list and Accept-Encoding value are built once when the client is created rather than
+ * for every request.
+ */
+struct request_defaults
+{
+    /// The HTTP version to use.
+    std::optional<http::version> version{std::nullopt};
+    /// The total timeout, the client's connect timeout applies to requests using this value as
+    /// it would to the request's own timeout.
+    std::optional<std::chrono::milliseconds> timeout{std::nullopt};
+    /// Should redirects be followed?
+    std::optional<bool> follow_redirects{std::nullopt};
+    /// The maximum number of redirects to follow when following redirects, -1 for unlimited.
+    std::optional<int64_t> max_redirects{std::nullopt};
+    /// Should the peer's ssl certificate be verified?
+    std::optional<bool> verify_ssl_peer{std::nullopt};
+    /// Should the ssl certificate's host name be verified?
+    std::optional<bool> verify_ssl_host{std::nullopt};
+    /// Should the ssl certificate's status be verified?
+    std::optional<bool> verify_ssl_status{std::nullopt};
+    /// The Accept-Encoding values, an empty list accepts all encodings libcurl supports.
+    std::optional<std::vector<std::string>> accept_encodings{std::nullopt};
+    /// Headers sent with every request, a request header with the same name replaces the default.
+    std::vector<lift::header> headers{};
+};
+
 class client
 {
+    friend batcher;
     friend curl_context;
     friend executor;
 
@@ -51,7 +287,8 @@ public:
         /// feature to allow for long tail connects but very short requests once
         /// the keep-alive connection is established.
         std::optional<std::chrono::milliseconds> connect_timeout{std::nullopt};
-        /// A set of host:port combinations to bypass DNS resolving.
+        /// A set of host:port combinations to bypass DNS resolving, see update_resolve_hosts().
+        /// Connections made through an entry are only reused by requests sent to the same address.
         std::optional<std::vector<resolve_host>> resolve_hosts{std::nullopt};
         /// Should separate event loops share connection information?
         share_ptr share{nullptr};
@@ -59,6 +296,174 @@ public:
         /// thread starting and thread stopping.  This can be used to set the
         /// thread's priority/niceness or possibly changes its thread name.
         on_thread_callback_type on_thread_callback{nullptr};
+        /// If set the client will release pooled executors, curl socket contexts and request queue
+        /// capacity that went unused for an entire interval.  Executors are never released below
+        /// `reserve_connections`.  If not set the pools only ever grow to their high water mark.
+        std::optional<std::chrono::milliseconds> pool_trim_interval{std::nullopt};
+        /// The socket readiness backend.  If io_uring is requested but the running kernel does not
+        /// support it the client falls back to uv_poll, see client::active_socket_backend().
+        lift::socket_backend socket_backend{lift::socket_backend::uv_poll};
+        /// If set the event loop thread busy-polls for new requests and socket activity instead of
+        /// sleeping, it only sleeps after this long passes without any activity.  This trades a
+        /// fully busy CPU core for not paying the thread wake-up latency on every request.
+        std::optional<std::chrono::microseconds> spin_budget{std::nullopt};
+        /// Settings applied to every request that does not set them itself.
+        std::optional<lift::request_defaults> request_defaults{std::nullopt};
+        /// If set the responses of requests that were not created with their own memory resource
+        /// allocate their headers and data from this resource, e.g. a
+        /// std::pmr::synchronized_pool_resource.  Responses are released on whichever thread the
+        /// user destroys them so the resource must be thread safe, and it must outlive the client
+        /// and every response it produced.
+        std::pmr::memory_resource* memory_resource{nullptr};
+        /// What happens to transfers still running when their request reaches timesup, see
+        /// lift::orphan_policy.  Only applies when the connect timeout is longer than the timeout.
+        lift::orphan_policy orphan_policy{lift::orphan_policy::keep_to_completion};
+        /// If set no more than this many orphaned transfers are kept at once, any further transfer
+        /// is aborted at timesup regardless of the orphan policy.
+        std::optional<uint64_t> max_orphans{std::nullopt};
+        /// If set new connections are bound to these local addresses, each request is given the
+        /// next one in turn.  Every source address has its own ephemeral ports towards the same
+        /// backend ip:port, spreading connections across several raises how many short lived
+        /// connections (and their TIME_WAIT) one host can have to it.  A request only re-uses
+        /// connections that were opened from the source address it was given.
+        std::vector<lift::source_address> source_addresses{};
+        /// If set the client's event loop periodically hands its long running requests to the dump's
+        /// handler, see lift::inflight_dump.
+        std::optional<lift::inflight_dump> inflight_dump{std::nullopt};
+        /// If set the client opens connections and executors ahead of the demand it predicts from its
+        /// own traffic, see lift::predictive_pool.  Warm-up requests count towards client::size() while
+        /// they execute.  Connections are not warmed for clients with a share, their connections can
+        /// belong to the share's cache.
+        std::optional<lift::predictive_pool> predictive_pool{std::nullopt};
+        /// If set requests are admitted by tenant with weighted fair queuing instead of starting as
+        /// soon as they are submitted, see lift::fair_queuing and request::tenant().
+        std::optional<lift::fair_queuing> fair_queuing{std::nullopt};
+        /// If set a sample of the requests is copied to a shadow endpoint, see lift::mirror.  The
+        /// copies run outside of fair queuing and the predictive pool, within their own budget.
+        std::optional<lift::mirror> mirror{std::nullopt};
+        /// If set no more than this many connections are open to a single host at once, requests
+        /// beyond it wait for one of the host's connections.  Zero is unlimited.
+        std::optional<uint64_t> max_host_connections{std::nullopt};
+    };
+
+    /**
+     * New values for the client's limits, see reconfigure().  Only the limits that are set change,
+     * the others keep their current value.
+     */
+    struct limits
+    {
+        /// See options::max_connections.
+        std::optional<uint64_t> max_connections{std::nullopt};
+        /// See options::max_host_connections.
+        std::optional<uint64_t> max_host_connections{std::nullopt};
+        /// See options::connect_timeout, applies to requests started from now on.
+        std::optional<std::chrono::milliseconds> connect_timeout{std::nullopt};
+        /// See options::max_orphans.
+        std::optional<uint64_t> max_orphans{std::nullopt};
+        /// See fair_queuing::max_in_flight, ignored without options::fair_queuing.
+        std::optional<uint64_t> max_in_flight{std::nullopt};
+        /// Replaces the weight and cap of each named tenant, see fair_queuing::tenants.  Ignored
+        /// without options::fair_queuing.
+        std::vector<lift::tenant> tenants{};
+    };
+
+    /**
+     * The traffic sent from one of options::source_addresses.
+     */
+    struct source_address_metrics
+    {
+        /// The number of requests that were given this source address.
+        uint64_t requests{0};
+        /// The number of new connections those requests opened, the rest re-used open connections.
+        uint64_t connections{0};
+    };
+
+    /**
+     * The requests of one tenant, see options::fair_queuing.
+     */
+    struct tenant_metrics
+    {
+        /// The tenant's name, empty for the default tenant.
+        std::string name{};
+        /// The tenant's requests currently waiting for admission.
+        uint64_t queued{0};
+        /// The tenant's requests currently executing.
+        uint64_t in_flight{0};
+        /// The tenant's requests admitted so far.
+        uint64_t admitted{0};
+        /// The tenant's requests completed so far, the tenant's throughput.
+        uint64_t completed{0};
+        /// The total time the admitted requests waited for admission, divide by admitted for the mean.
+        std::chrono::milliseconds wait_time{0};
+        /// The longest any admitted request waited for admission.
+        std::chrono::milliseconds max_wait_time{0};
+    };
+
+    /**
+     * A point in time snapshot of the client's internal pool sizes.  Each value is published by the
+     * background event loop thread as it changes so the snapshot can be taken from any thread.
+     */
+    struct metrics_snapshot
+    {
+        /// The number of executors currently alive, pooled and executing.
+        uint64_t executors_total{0};
+        /// The number of executors waiting in the pool for a request.
+        uint64_t executors_pooled{0};
+        /// The number of curl socket contexts waiting in the pool for a socket.
+        uint64_t curl_contexts_pooled{0};
+        /// The combined capacity of the pending and grabbed request queues.
+        uint64_t request_queue_capacity{0};
+        /// The number of requests that have a client side timesup pending.
+        uint64_t timeouts_pending{0};
+        /// The number of socket interest changes libcurl has requested.
+        uint64_t socket_poll_updates{0};
+        /// The number of syscalls issued to apply those changes.  With uv_poll each change is its
+        /// own epoll_ctl, with io_uring this is the number of batched io_uring_enter calls.
+        uint64_t socket_poll_syscalls{0};
+        /// The number of times the event loop ran out of spin budget and went to sleep, only
+        /// counted when options::spin_budget is set.
+        uint64_t loop_sleeps{0};
+        /// The number of requests the event loop has picked up from the submission queue.
+        uint64_t requests_accepted{0};
+        /// The number of times a submitting thread had to signal the event loop to wake up,
+        /// submissions made while the loop is already awake do not signal it again.
+        uint64_t loop_wakeups{0};
+        /// The number of transfers still running after their request reached timesup.
+        uint64_t orphans_active{0};
+        /// The number of transfers aborted at timesup, by the orphan policy or the max_orphans cap.
+        uint64_t orphans_aborted{0};
+        /// The number of orphaned transfers that established their connection and were then aborted
+        /// by the keep_until_connected policy.
+        uint64_t orphans_connected{0};
+        /// The number of orphaned transfers that completed successfully, each left its connection
+        /// open for re-use by later requests.
+        uint64_t orphans_completed{0};
+        /// The number of completed requests that re-used an open connection.
+        uint64_t warm_requests{0};
+        /// The number of completed requests that had to open a new connection.
+        uint64_t cold_requests{0};
+        /// The number of warm-up requests options::predictive_pool started, they are not counted as
+        /// warm or cold requests.
+        uint64_t warmup_requests{0};
+        /// The number of shadow copies sent, see options::mirror.
+        uint64_t shadow_requests{0};
+        /// The number of shadow copies that completed successfully.
+        uint64_t shadow_completed{0};
+        /// The number of sampled requests not copied because the shadow budget was full or the
+        /// client was shedding.
+        uint64_t shadow_dropped{0};
+        /// The number of shadow copies aborted while the client was shedding.
+        uint64_t shadow_aborted{0};
+        /// The number of tasks waiting for their time to run, see schedule().
+        uint64_t tasks_scheduled{0};
+        /// The number of requests waiting for their time to start, see start_request_at().
+        uint64_t requests_scheduled{0};
+        /// The traffic per options::source_addresses entry, in the same order.  Counted as each
+        /// request completes.
+        std::vector<source_address_metrics> source_addresses{};
+        /// The requests per tenant in name order, only with options::fair_queuing.  Every configured
+        /// tenant is listed, other tenants once their first request is queued.
+        std::vector<tenant_metrics> tenants{};
     };
 
     /**
@@ -67,12 +472,25 @@ public:
      */
     explicit client(
         options opts = options{
-            std::nullopt, // reserve connections
-            std::nullopt, // max connections
-            std::nullopt, // connect timeout
-            std::nullopt, // resolve hosts
-            nullptr,      // share ptr
-            nullptr       // on thread callback
+            std::nullopt,                            // reserve connections
+            std::nullopt,                            // max connections
+            std::nullopt,                            // connect timeout
+            std::nullopt,                            // resolve hosts
+            nullptr,                                 // share ptr
+            nullptr,                                 // on thread callback
+            std::nullopt,                            // pool trim interval
+            lift::socket_backend::uv_poll,           // socket backend
+            std::nullopt,                            // spin budget
+            std::nullopt,                            // request defaults
+            nullptr,                                 // memory resource
+            lift::orphan_policy::keep_to_completion, // orphan policy
+            std::nullopt,                            // max orphans
+            {},                                      // source addresses
+            std::nullopt,                            // inflight dump
+            std::nullopt,                            // predictive pool
+            std::nullopt,                            // fair queuing
+            std::nullopt,                            // mirror
+            std::nullopt                             // max host connections
         });
 
     ~client();
@@ -108,6 +526,68 @@ public:
      */
     [[nodiscard]] auto empty() const -> bool { return size() == 0; }
 
+    /**
+     * This function is thread safe and can be called from any thread.
+     * @return A snapshot of the client's internal pool sizes.
+     */
+    [[nodiscard]] auto metrics() const -> metrics_snapshot;
+
+    /**
+     * Lists every request the client has been given and not yet completed, including orphaned
+     * transfers.  The list is built on the event loop thread when it next picks up new requests and
+     * the calling thread blocks until it is, nothing beyond each request's start and timeout is
+     * tracked ahead of time.  This function is thread safe and can also be called on the event loop
+     * thread, e.g. from a request's on complete callback.
+     * @return The requests in the order the event loop started them, queued requests last.
+     */
+    [[nodiscard]] auto inflight_snapshot() -> std::vector<lift::inflight_request>;
+
+    /**
+     * Replaces the client's resolve hosts, see options::resolve_hosts.  The new table is swapped in
+     * on the event loop thread, each request uses either the old or the new table in full, and
+     * requests started after this call use the new one.  Open connections to an address that is
+     * still in the table keep being reused, connections to a removed or changed address are left
+     * to finish their requests and are not reused again.  This function is thread safe.
+     * @param resolve_hosts The new set of host:port combinations to bypass DNS resolving.
+     */
+    auto update_resolve_hosts(std::vector<lift::resolve_host> resolve_hosts) -> void;
+
+    /**
+     * Changes the client's limits while it runs, e.g. to lower the concurrency towards a struggling
+     * backend without losing the open connections.  The limits are applied on the event loop thread
+     * before the requests submitted after this call start.  Requests already executing are not
+     * interrupted: a lower connection limit closes idle connections only, and a lower admission
+     * limit holds back queued requests until enough of the executing ones complete.  This function
+     * is thread safe.
+     * @param new_limits The limits to change.
+     */
+    auto reconfigure(limits new_limits) -> void;
+
+    /**
+     * Runs the task on the event loop thread, before the requests submitted after this call start.
+     * Tasks run in the order they were posted and are handed over with the same queue and wake-up as
+     * new requests, so posting costs no more than submitting a request.  The task must not block,
+     * every request on the client waits for it.  This function is thread safe and can also be called
+     * on the event loop thread, the task then runs when the loop next picks up new requests.
+     * @param task The work to run on the event loop thread.
+     */
+    auto post(std::function<void()> task) -> void;
+
+    /**
+     * Runs the task on the event loop thread once the delay has passed, timed by the event loop
+     * instead of a sleeping thread.  Tasks still waiting when the client is destroyed never run.
+     * This function is thread safe.
+     * @param delay How long from now to wait before running the task.
+     * @param task The work to run on the event loop thread.
+     */
+    auto schedule(std::chrono::milliseconds delay, std::function<void()> task) -> void;
+
+    /**
+     * @return The socket readiness backend actually in use, this can differ from the requested
+     *         options::socket_backend if io_uring was unavailable at runtime.
+     */
+    [[nodiscard]] auto active_socket_backend() const -> lift::socket_backend { return m_socket_backend; }
+
     /**
      * Starts processing the given request.  The ownership of the request is transferred into the
      * client's background event loop thread during execution and is returned to the user when
@@ -134,6 +614,59 @@ public:
      */
     auto start_request(request_ptr&& request_ptr, request::async_callback_type callback) -> void;
 
+    /**
+     * Starts processing the given request no earlier than the given time.  Until then the request
+     * waits in the client's timer structure, it counts towards size() and metrics() reports it as
+     * scheduled.  Once its time comes it is accepted like a request given to start_request() then,
+     * its timeout starts when it does.
+     *
+     * This function is thread safe and can be called from any thread to schedule a request.
+     *
+     * @throw std::runtime_error If the request_ptr is nullptr.
+     * @param request_ptr The request to process.
+     * @param when The earliest time to start the request, a time in the past starts it right away.
+     * @return A future that will be fulfilled upon the request completing processing.
+     */
+    [[nodiscard]] auto start_request_at(request_ptr&& request_ptr, std::chrono::steady_clock::time_point when)
+        -> request::async_future_type;
+
+    /**
+     * Starts processing the given request no earlier than the given time, see start_request_at().
+     * @throw std::runtime_error If the request_ptr or callback are nullptr.
+     * @param request_ptr The request to process.
+     * @param when The earliest time to start the request, a time in the past starts it right away.
+     * @param callback Called when the request is completed/error'ed/etc.
+     */
+    auto start_request_at(
+        request_ptr&& request_ptr, std::chrono::steady_clock::time_point when, request::async_callback_type callback)
+        -> void;
+
+    /**
+     * Starts processing the given request once the delay has passed, see start_request_at().
+     * @throw std::runtime_error If the request_ptr is nullptr.
+     * @param request_ptr The request to process.
+     * @param delay How long from now to wait before starting the request.
+     * @return A future that will be fulfilled upon the request completing processing.
+     */
+    [[nodiscard]] auto start_request_after(request_ptr&& request_ptr, std::chrono::milliseconds delay)
+        -> request::async_future_type
+    {
+        return start_request_at(std::move(request_ptr), std::chrono::steady_clock::now() + delay);
+    }
+
+    /**
+     * Starts processing the given request once the delay has passed, see start_request_at().
+     * @throw std::runtime_error If the request_ptr or callback are nullptr.
+     * @param request_ptr The request to process.
+     * @param delay How long from now to wait before starting the request.
+     * @param callback Called when the request is completed/error'ed/etc.
+     */
+    auto start_request_after(
+        request_ptr&& request_ptr, std::chrono::milliseconds delay, request::async_callback_type callback) -> void
+    {
+        start_request_at(std::move(request_ptr), std::chrono::steady_clock::now() + delay, std::move(callback));
+    }
+
     /**
      * Starts processing the set of given requests.  The ownership of the requests are transferred
      * into the client's background event loop thread during execution and they are each individually
@@ -224,6 +757,10 @@ private:
     uv_loop_t m_uv_loop{};
     /// The async trigger for injecting new requests into the event loop.
     uv_async_t m_uv_async{};
+    /// The async trigger for resuming uploads whose MIME file parts have data again.
+    uv_async_t m_uv_async_file_reader{};
+    /// Reads MIME file parts for asynchronous requests so the event loop thread never blocks on disk.
+    std::unique_ptr<impl::file_reader> m_file_reader{nullptr};
     /// libcurl requires a single timer to drive internal timeouts/wake-ups.
     uv_timer_t m_uv_timer_curl{};
     /// If set, the amount of time connections are allowed to connect, this can be
@@ -248,6 +785,35 @@ private:
     std::vector<request_ptr> m_pending_requests{};
     /// Only accessible from within the client thread.
     std::vector<request_ptr> m_grabbed_requests{};
+    /// Callers of inflight_snapshot() waiting for the event loop, guarded by m_pending_requests_lock.
+    std::vector<std::promise<std::vector<lift::inflight_request>>> m_inflight_waiters{};
+    /// Work handed to the event loop thread by post(), guarded by m_pending_requests_lock.
+    std::vector<std::function<void()>> m_loop_tasks{};
+    /// Only accessible from within the client thread, swapped with m_loop_tasks so both keep their capacity.
+    std::vector<std::function<void()>> m_grabbed_tasks{};
+    /// Requests given to start_request_at() with their due loop time, guarded by m_pending_requests_lock.
+    std::vector<std::pair<time_point, request_ptr>> m_pending_scheduled{};
+    /// Set when any of the queues guarded by m_pending_requests_lock is non-empty so a spinning event
+    /// loop can check for new requests without taking m_pending_requests_lock.
+    std::atomic<bool> m_requests_pending{false};
+    /**
+     * True while the event loop is awake and will check m_requests_pending before it blocks again,
+     * submitters only need to wake the loop when they are the one to flip this from false to true.
+     * Cleared right before the loop blocks (m_uv_prepare_wakeup) and set again as soon as it
+     * returns from blocking (m_uv_check_wakeup).
+     */
+    std::atomic<bool> m_loop_awake{false};
+    /// Clears m_loop_awake and drains the submission queue right before the loop blocks.
+    uv_prepare_t m_uv_prepare_wakeup{};
+    /// Sets m_loop_awake once the loop returns from blocking.
+    uv_check_t m_uv_check_wakeup{};
+
+    /// If set the event loop busy-polls for this long without activity before sleeping.
+    std::optional<std::chrono::microseconds> m_spin_budget{std::nullopt};
+    /// Incremented by the event loop thread whenever it does any work, used to detect an idle spin.
+    uint64_t m_loop_activity{0};
+    /// True while run_spin() is spinning rather than blocking, only accessed by the event loop thread.
+    bool m_spinning{false};
 
     /// The background thread spawned to drive the event loop.
     std::thread m_background_thread{};
@@ -258,13 +824,151 @@ private:
 
     /// Pool of executors for running requests.
     std::deque<std::unique_ptr<executor>> m_executors{};
+    /// The number of executors alive, this includes executors currently running requests.
+    std::size_t m_executors_total{0};
+    /// The number of executors to always keep alive, see options::reserve_connections.
+    std::size_t m_executors_reserved{0};
+
+    /// If set the interval at which unused pooled resources are released.
+    std::optional<std::chrono::milliseconds> m_pool_trim_interval{std::nullopt};
+    /// Timer to drive releasing unused pooled resources.
+    uv_timer_t m_uv_timer_pool_trim{};
+    /// The smallest the executor pool has been during the current trim interval.
+    std::size_t m_executors_low_water{0};
+    /// The smallest the curl context pool has been during the current trim interval.
+    std::size_t m_curl_contexts_low_water{0};
+    /// The largest batch of requests accepted during the current trim interval.
+    std::size_t m_grabbed_requests_high_water{0};
+
+    /// Pool sizes published from the event loop thread for client::metrics().
+    struct metrics_counters
+    {
+        std::atomic<uint64_t> executors_total{0};
+        std::atomic<uint64_t> executors_pooled{0};
+        std::atomic<uint64_t> curl_contexts_pooled{0};
+        std::atomic<uint64_t> request_queue_capacity{0};
+        std::atomic<uint64_t> timeouts_pending{0};
+        std::atomic<uint64_t> socket_poll_updates{0};
+        std::atomic<uint64_t> socket_poll_syscalls{0};
+        std::atomic<uint64_t> loop_sleeps{0};
+        std::atomic<uint64_t> requests_accepted{0};
+        std::atomic<uint64_t> loop_wakeups{0};
+        std::atomic<uint64_t> orphans_active{0};
+        std::atomic<uint64_t> orphans_aborted{0};
+        std::atomic<uint64_t> orphans_connected{0};
+        std::atomic<uint64_t> orphans_completed{0};
+        std::atomic<uint64_t> warm_requests{0};
+        std::atomic<uint64_t> cold_requests{0};
+        std::atomic<uint64_t> warmup_requests{0};
+        std::atomic<uint64_t> shadow_requests{0};
+        std::atomic<uint64_t> shadow_completed{0};
+        std::atomic<uint64_t> shadow_dropped{0};
+        std::atomic<uint64_t> shadow_aborted{0};
+        std::atomic<uint64_t> tasks_scheduled{0};
+        std::atomic<uint64_t> requests_scheduled{0};
+    };
+    metrics_counters m_metrics{};
+
+    /// The local addresses new connections are bound to, see options::source_addresses.
+    std::vector<lift::source_address> m_source_addresses{};
+    /// The index of the source address the next request is given, only used on the event loop thread.
+    std::size_t m_next_source_address{0};
+    /// Published counters for client::metrics(), one per source address.
+    struct source_address_counters
+    {
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> connections{0};
+    };
+    std::vector<source_address_counters> m_source_address_counters;
+
+    /// The first of the requests the event loop is executing, each executor links to the next.
+    executor* m_inflight_head{nullptr};
+    /// The last of the requests the event loop is executing, new requests are linked after it.
+    executor* m_inflight_tail{nullptr};
+    /// See options::inflight_dump.
+    std::optional<lift::inflight_dump> m_inflight_dump{std::nullopt};
+    /// Timer to drive the in-flight dump.
+    uv_timer_t m_uv_timer_inflight_dump{};
+
+    /// See options::predictive_pool.
+    std::optional<lift::predictive_pool> m_predictive_pool{std::nullopt};
+    /// Timer to drive the predictive pool.
+    uv_timer_t m_uv_timer_predictive_pool{};
+    /// The demand seen per host, keyed by scheme://host:port.  Only tracked with a predictive pool.
+    std::map<std::string, impl::host_demand, std::less<>> m_hosts{};
+    /// Should the predictive pool open and count connections?  Not for clients with a share.
+    bool m_warm_connections{false};
+    /// The executors the predictive pool keeps, pool trimming never goes below this.
+    std::size_t m_executors_predicted{0};
+    /// The user's options::max_connections, if set it caps the predictive pool.
+    std::optional<uint64_t> m_max_connections{std::nullopt};
+    /// The user's options::max_host_connections, if set it caps the predictive pool per host.
+    std::optional<uint64_t> m_max_host_connections{std::nullopt};
+
+    /// See options::fair_queuing.
+    std::optional<lift::fair_queuing> m_fair_queuing{std::nullopt};
+    /// Every tenant seen so far keyed by name, tenants are never removed.  The event loop thread
+    /// only takes the lock to add a tenant, metrics() takes it to read them.
+    std::map<std::string, impl::tenant_queue, std::less<>> m_tenants{};
+    mutable std::mutex                                     m_tenants_lock{};
+    /// The tenants with queued requests in turn order, the front tenant is taking its turn.
+    std::deque<impl::tenant_queue*> m_tenants_active{};
+    /// The admitted requests currently executing across all tenants.
+    uint64_t m_tenants_in_flight{0};
+    /// Guards against admitting re-entrantly while a started request completes immediately.
+    bool m_admitting{false};
 
-    /// The set of resolve hosts to apply to all requests in this event loop.
+    /// See options::mirror.
+    std::optional<lift::mirror> m_mirror{std::nullopt};
+    /// The sampled share of a request owed to the mirror, a request is copied each time it reaches one.
+    double m_mirror_credit{0.0};
+    /// The copies of the requests being accepted, started once the originals are.
+    std::vector<request_ptr> m_shadows_pending{};
+    /// The shadow copies currently executing.
+    uint64_t m_shadows_in_flight{0};
+
+    /// The socket readiness backend in use.
+    lift::socket_backend m_socket_backend{lift::socket_backend::uv_poll};
+    /// The io_uring socket readiness backend, only set if m_socket_backend is io_uring.
+    std::unique_ptr<impl::io_uring_poller> m_io_uring{nullptr};
+    /// Watches the io_uring's file descriptor for completions.
+    uv_poll_t m_uv_poll_io_uring{};
+    /// Submits the io_uring's batched interest changes once per loop iteration before it blocks.
+    uv_prepare_t m_uv_prepare_io_uring{};
+
+    /// The set of resolve hosts to apply to all requests in this event loop, only replaced on the
+    /// event loop thread.
     std::vector<lift::resolve_host> m_resolve_hosts{};
+    /// "-host:port" entries for the hosts update_resolve_hosts() removed, they purge the removed
+    /// addresses from libcurl's DNS cache for requests that resolve through a proxy.
+    std::vector<std::string> m_resolve_hosts_removed{};
+
+    /// Settings applied to requests that do not set them, see options::request_defaults.
+    std::optional<lift::request_defaults> m_request_defaults{std::nullopt};
+    /// The default Accept-Encoding value joined once, only set if the defaults have encodings.
+    std::optional<std::string> m_default_accept_encoding{std::nullopt};
+    /// The default headers as a curl list, shared by every request that has no headers of its own.
+    curl_slist* m_default_headers{nullptr};
+    /// The memory resource for responses of requests without their own, see options::memory_resource.
+    std::pmr::memory_resource* m_memory_resource{nullptr};
+
+    /// What happens to transfers that outlive their timesup, see options::orphan_policy.
+    lift::orphan_policy m_orphan_policy{lift::orphan_policy::keep_to_completion};
+    /// The maximum number of orphaned transfers kept at once, see options::max_orphans.
+    std::optional<uint64_t> m_max_orphans{std::nullopt};
+    /// The number of orphaned transfers currently running, only used on the event loop thread.
+    uint64_t m_orphans_active{0};
 
     /// When connection time is enabled on an event loop the curl timeout is the longer
     /// timeout value and these timeouts are the shorter value.
     std::multimap<time_point, executor*> m_timeouts{};
+    /// Tasks waiting for their time to run, see schedule().  Only used on the event loop thread.
+    std::multimap<time_point, std::function<void()>> m_scheduled_tasks{};
+    /// Requests waiting for their time to start, see start_request_at().  Only used on the event loop
+    /// thread, due requests are moved to m_pending_requests and accepted like any other.
+    std::multimap<time_point, request_ptr> m_scheduled_requests{};
+    /// Timer to run the first of m_scheduled_tasks or start the first of m_scheduled_requests.
+    uv_timer_t m_uv_timer_scheduled{};
 
     /// If the event loop is provided a share object then connection information like
     /// DNS/SSL/Data pipelining can be shared across event loops.
@@ -278,6 +982,11 @@ private:
      */
     auto start_request_common(request_ptr&& request_ptr) -> void;
 
+    /**
+     * Common code between future and callback start request at functions.
+     */
+    auto start_request_at_common(request_ptr&& request_ptr, std::chrono::steady_clock::time_point when) -> void;
+
     /**
      * Common code between future and callback start requests functions.
      */
@@ -306,10 +1015,23 @@ private:
                     m_pending_requests.emplace_back(std::move(request_ptr));
                 }
             }
+            m_requests_pending.store(true, std::memory_order_seq_cst);
         }
 
-        // Notify the event loop thread that there are requests waiting to be picked up.
-        uv_async_send(&m_uv_async);
+        wake_event_loop();
+    }
+
+    /**
+     * Notifies the event loop thread that there are requests waiting to be picked up, unless it is
+     * already awake and guaranteed to check the submission queue before it sleeps again.
+     */
+    auto wake_event_loop() -> void
+    {
+        if (!m_loop_awake.exchange(true, std::memory_order_seq_cst))
+        {
+            m_metrics.loop_wakeups.fetch_add(1, std::memory_order_relaxed);
+            uv_async_send(&m_uv_async);
+        }
     }
 
     /**
@@ -347,6 +1069,12 @@ private:
      */
     auto run() -> void;
 
+    /**
+     * The background event loop when options::spin_budget is set, busy-polls with non-blocking
+     * loop iterations and only blocks after the spin budget passes without any activity.
+     */
+    auto run_spin() -> void;
+
     /**
      * Checks current pending curl actions like timeouts.
      */
@@ -389,6 +1117,12 @@ private:
      */
     auto add_timeout(executor& exe) -> void;
 
+    /**
+     * @param req The request to get the timeout for.
+     * @return The request's own timeout, or the default request timeout if it did not set one.
+     */
+    auto request_timeout(const request& req) const -> std::optional<std::chrono::milliseconds>;
+
     /**
      * Removes the timeout from the client timer information.
      * Connection time can still fire from curl but the request's
@@ -396,14 +1130,114 @@ private:
      */
     auto remove_timeout(executor& exe) -> std::multimap<uint64_t, executor*>::iterator;
 
+    /**
+     * Applies the orphan policy to a request that just reached timesup while its transfer is still
+     * running, the transfer is either aborted now or kept as an orphan.
+     * @param exe The executor of the request that reached timesup, it is returned to the pool if aborted.
+     */
+    auto orphan(executor& exe) -> void;
+
     /**
      * Updates the event loop timeout information.
      */
     auto update_timeouts() -> void;
 
+    /**
+     * Arms the scheduled timer for the first of m_scheduled_tasks and m_scheduled_requests, or stops
+     * it if there are none.
+     */
+    auto update_scheduled() -> void;
+
+    /**
+     * Fails every request scheduled for later with lift_status::error_failed_to_start, called once the
+     * client is stopping so they don't hold it open until they are due.
+     */
+    auto fail_scheduled_requests() -> void;
+
+    /**
+     * Starts executing a request on the event loop thread.
+     * @param request_ptr The request to start.
+     * @param role Why the client is executing the request.
+     * @param tenant The tenant that admitted the request, if fair queuing.
+     */
+    auto start_request_on_loop(request_ptr&& request_ptr, executor::role role, impl::tenant_queue* tenant = nullptr)
+        -> void;
+
+    /**
+     * @param name The tenant's name.
+     * @return The tenant's queue, created with its configured or the default share if this is its
+     *         first request.
+     */
+    auto find_tenant(std::string_view name) -> impl::tenant_queue&;
+
+    /**
+     * Queues a request in its tenant's queue until it is admitted.
+     */
+    auto enqueue_tenant(request_ptr&& request_ptr) -> void;
+
+    /**
+     * Starts queued requests while there is room, the tenants with queued requests take turns
+     * by deficit round robin.
+     */
+    auto admit_requests() -> void;
+
+    /**
+     * Samples a request being accepted for the mirror, a sampled request's copy is added to the
+     * pending shadows.
+     */
+    auto mirror_request(const request& original) -> void;
+
+    /**
+     * Starts the pending shadow copies, or drops them and aborts the executing copies if the client
+     * is shedding.
+     * @param own_requests The client's own requests, queued or executing, when they were accepted.
+     */
+    auto start_shadows(std::size_t own_requests) -> void;
+
+    /**
+     * Sets libcurl's connection cache size, the mirror's shadows share the cache so room for their
+     * connections is reserved on top to keep them from evicting the client's idle connections.
+     * @param connections The connections to cache for the client's own requests.
+     */
+    auto set_connection_cache_size(uint64_t connections) -> void;
+
+    /**
+     * Counts the request against its host's demand, creating the host if this is its first request.
+     */
+    auto track_host(executor& exe) -> void;
+
+    /**
+     * Samples every host's demand, updates the predictions and opens or keeps connections and
+     * executors to match them.
+     */
+    auto predict_pool() -> void;
+
+    /**
+     * Links an executor that was just handed to libcurl into the list of executing requests.
+     */
+    auto inflight_link(executor& exe) -> void;
+
+    /**
+     * Unlinks an executor from the list of executing requests, if it is in it.
+     */
+    auto inflight_unlink(executor& exe) -> void;
+
+    /**
+     * Describes the executing and queued requests, only called on the event loop thread.
+     * @param older_than Only requests at least this old are listed, queued requests are never listed
+     *                   unless this is zero.
+     */
+    auto collect_inflight(std::chrono::milliseconds older_than) -> std::vector<lift::inflight_request>;
+
     auto acquire_executor() -> std::unique_ptr<executor>;
     auto return_executor(std::unique_ptr<executor> executor_ptr) -> void;
 
+    /**
+     * Releases pooled executors, curl contexts and request queue capacity that went unused for the
+     * entire trim interval.
+     */
+    auto trim_pools() -> void;
+
     /**
      * This function is called by libcurl to start a timeout with duration timeout_ms.
      *
@@ -477,7 +1311,69 @@ private:
      */
     friend auto on_uv_requests_accept_async(uv_async_t* handle) -> void;
 
+    /**
+     * Runs right before the event loop blocks, it marks the loop as asleep and then picks up any
+     * requests submitted while it was awake (those submitters did not wake it).
+     * @param handle The prepare handle m_uv_prepare_wakeup.
+     */
+    friend auto on_uv_loop_prepare_callback(uv_prepare_t* handle) -> void;
+
+    /**
+     * Runs right after the event loop returns from blocking, it marks the loop as awake.
+     * @param handle The check handle m_uv_check_wakeup.
+     */
+    friend auto on_uv_loop_check_callback(uv_check_t* handle) -> void;
+
     friend auto on_uv_timesup_callback(uv_timer_t* handle) -> void;
+
+    /**
+     * libcurl calls this once the connection for a transfer is established or re-used, right before
+     * the request is sent.  Aborts the transfer if it has been orphaned under keep_until_connected.
+     */
+    friend auto curl_prereq_callback(
+        void* clientp, char* conn_primary_ip, char* conn_local_ip, int conn_primary_port, int conn_local_port) -> int;
+
+    /**
+     * This function is called by libuv every pool trim interval to release unused pooled resources.
+     * @param handle The timer object trigger, this will always be m_uv_timer_pool_trim.
+     */
+    friend auto on_uv_pool_trim_callback(uv_timer_t* handle) -> void;
+
+    /**
+     * This function is called by libuv every inflight dump interval to report long running requests.
+     * @param handle The timer object trigger, this will always be m_uv_timer_inflight_dump.
+     */
+    friend auto on_uv_inflight_dump_callback(uv_timer_t* handle) -> void;
+
+    /**
+     * This function is called by libuv every predictive pool interval to adjust the pools.
+     * @param handle The timer object trigger, this will always be m_uv_timer_predictive_pool.
+     */
+    friend auto on_uv_predictive_pool_callback(uv_timer_t* handle) -> void;
+
+    /**
+     * This function is called by libuv when the first scheduled task is due.
+     * @param handle The timer object trigger, this will always be m_uv_timer_scheduled.
+     */
+    friend auto on_uv_scheduled_callback(uv_timer_t* handle) -> void;
+
+    /**
+     * Reaps socket readiness completions from the io_uring and drives libcurl for each ready socket.
+     * @param handle The poll handle on the io_uring's file descriptor, m_uv_poll_io_uring.
+     */
+    friend auto on_uv_io_uring_ready_callback(uv_poll_t* handle, int status, int events) -> void;
+
+    /**
+     * Submits all socket interest changes queued during this loop iteration in a single syscall.
+     * @param handle The prepare handle m_uv_prepare_io_uring.
+     */
+    friend auto on_uv_io_uring_prepare_callback(uv_prepare_t* handle) -> void;
+
+    /**
+     * Resumes transfers that paused waiting for their MIME file parts to be read from disk.
+     * @param handle The async handle m_uv_async_file_reader.
+     */
+    friend auto on_uv_file_reader_ready_async(uv_async_t* handle) -> void;
 };
 
 } // namespace lift
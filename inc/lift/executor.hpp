@@ -1,5 +1,6 @@
 #pragma once
 
+#include "lift/inflight.hpp"
 #include "lift/request.hpp"
 #include "lift/response.hpp"
 
@@ -12,6 +13,14 @@ namespace lift
 class request;
 class client;
 
+namespace impl
+{
+class file_source;
+class mime_body;
+struct host_demand;
+struct tenant_queue;
+} // namespace impl
+
 /**
  * This class's design is to encapsulate executing either a synchronous
  * or asynchronous request while also maintaining ownership boundaries
@@ -41,14 +50,31 @@ public:
     ~executor();
 
 private:
+    /// Why the client is executing a request.
+    enum class role
+    {
+        /// A request the user started.
+        user,
+        /// A predictive pool warm-up, see client::options::predictive_pool.
+        warmup,
+        /// A mirrored copy of a user request, see client::options::mirror.
+        shadow
+    };
+
     /// The curl handle to execute against.
     CURL* m_curl_handle{curl_easy_init()};
     /// The mime handle if present.
     curl_mime* m_mime_handle{nullptr};
+    /// The body of a request built from a mime_template, sent instead of a mime handle.
+    std::unique_ptr<impl::mime_body> m_mime_body{nullptr};
+    /// The files backing the mime handle's or mime body's file parts, only used for async requests.
+    std::vector<std::shared_ptr<impl::file_source>> m_file_sources{};
     /// The HTTP curl request headers.
     curl_slist* m_curl_request_headers{nullptr};
     /// The HTTP curl resolve hosts.
     curl_slist* m_curl_resolve_hosts{nullptr};
+    /// The client's resolve hosts as curl connect-to entries.
+    curl_slist* m_curl_connect_to{nullptr};
     /// The curl share object to use for this request.
     CURLSH* m_curl_share_handle{nullptr};
 
@@ -63,6 +89,26 @@ private:
     std::optional<std::multimap<uint64_t, executor*>::iterator> m_timeout_iterator{};
     // Has the on complete handler already been processed?
     bool m_on_complete_handler_processed{false};
+    /// Is the transfer still running after the user received its timesup response?
+    bool m_orphaned{false};
+    /// Has libcurl established (or re-used) a connection for the transfer?  Only tracked for
+    /// requests that can be orphaned under the keep_until_connected policy.
+    bool m_connected{false};
+    /// The index of the client's source address the request's connection is bound to, if any.
+    std::optional<std::size_t> m_source_address{std::nullopt};
+    /// The event loop time the async request was started at.
+    uint64_t m_started_at{0};
+    /// The event loop time the async request times out at, if it has a timeout.
+    std::optional<uint64_t> m_deadline{std::nullopt};
+    /// The neighbours in the client's list of executing requests, see client::inflight_snapshot().
+    executor* m_inflight_prev{nullptr};
+    executor* m_inflight_next{nullptr};
+    /// The host the request counts against, only tracked with a predictive pool.
+    impl::host_demand* m_host{nullptr};
+    /// Why the client is executing the request.
+    role m_role{role::user};
+    /// The tenant that admitted the request, only with fair queuing.
+    impl::tenant_queue* m_tenant{nullptr};
 
     /// Used internally to point at one of the sync or async requests.
     request* m_request{nullptr};
@@ -106,6 +152,13 @@ private:
      */
     auto prepare() -> void;
 
+    /**
+     * @param encodings The Accept-Encoding values to join.
+     * @return The CURLOPT_ACCEPT_ENCODING value for the encodings, an empty list is an empty string
+     *         which asks libcurl for every encoding it supports.
+     */
+    static auto join_accept_encodings(const std::vector<std::string>& encodings) -> std::string;
+
     /**
      * Copies all available HTTP response fields into the lift::response from
      * the curl handle.
@@ -118,6 +171,12 @@ private:
      */
     auto set_timesup_response(std::chrono::milliseconds total_time) -> void;
 
+    /**
+     * Describes the running async request, only called on the client's event loop thread.
+     * @param now The event loop's current time.
+     */
+    auto inflight(uint64_t now) const -> inflight_request;
+
     auto reset() -> void;
 
     /**
@@ -145,6 +204,10 @@ private:
     /// For Timesup.
     friend auto on_uv_timesup_callback(uv_timer_t* handle) -> void;
 
+    /// For the keep_until_connected orphan policy.
+    friend auto curl_prereq_callback(
+        void* clientp, char* conn_primary_ip, char* conn_local_ip, int conn_primary_port, int conn_local_port) -> int;
+
     /// libcurl will call this function when the request has debug function enabled.
     friend auto curl_debug_info_callback(CURL* handle, curl_infotype type, char* data, size_t size, void* userptr)
         -> int;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory_resource>
 #include <string>
 #include <string_view>
 
@@ -12,23 +13,45 @@ class header
     friend executor;
 
 public:
+    /// Headers are allocator aware, std::pmr containers of headers pass their memory resource on.
+    using allocator_type = std::pmr::polymorphic_allocator<char>;
+
     /**
      * Creates an owned header.
      * @param name The name of the header.
      * @param value The value of the header.
+     * @param alloc The allocator for the header's storage.
      */
-    header(std::string_view name, std::string_view value);
+    header(std::string_view name, std::string_view value, const allocator_type& alloc = {});
 
     /**
      * Creates an owned header.
      * @param header_full The full "<name>: <value>" header field.
+     * @param alloc The allocator for the header's storage.
      */
-    explicit header(std::string header_full);
+    explicit header(std::string_view header_full, const allocator_type& alloc = {});
+
+    ~header() = default;
+
+    header(const header&) = default;
+    header(header&&)      = default;
+    header(const header& other, const allocator_type& alloc)
+        : m_header(other.m_header, alloc),
+          m_colon_pos(other.m_colon_pos)
+    {
+    }
+    header(header&& other, const allocator_type& alloc)
+        : m_header(std::move(other.m_header), alloc),
+          m_colon_pos(other.m_colon_pos)
+    {
+    }
+    auto operator=(const header&) -> header& = default;
+    auto operator=(header&&) -> header& = default;
 
     /**
-     * @return The entire header, e.g. "Connection: Keep-Alive"
+     * @return The entire header, e.g. "Connection: Keep-Alive".  The view is always null terminated.
      */
-    [[nodiscard]] auto data() const -> const std::string& { return m_header; }
+    [[nodiscard]] auto data() const -> std::string_view { return m_header; }
 
     /**
      * @return The header's name.
@@ -59,7 +82,7 @@ public:
 
 private:
     /// The full header data.
-    std::string m_header{};
+    std::pmr::string m_header{};
     std::size_t m_colon_pos{0};
 };
 
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
+#include <new>
 #include <optional>
+#include <type_traits>
+#include <utility>
 
 namespace lift::impl
 {
@@ -43,4 +49,135 @@ struct copy_but_actually_move
     mutable std::optional<T> m_object{std::nullopt};
 };
 
+/**
+ * Is `T` a std::pmr container, i.e. does it allocate through a std::pmr::polymorphic_allocator?
+ */
+template<typename T, typename = void>
+struct uses_polymorphic_allocator : std::false_type
+{
+};
+
+template<typename T>
+struct uses_polymorphic_allocator<T, std::void_t<typename T::allocator_type>>
+    : std::is_convertible<std::pmr::memory_resource*, typename T::allocator_type>
+{
+};
+
+/**
+ * A copy-on-write pointer, copies share the object they point to until one of them modifies it
+ * through mutate() which first copies the object if it is still shared.  Copying is a reference
+ * count increment and the copy only allocates for what it changes.  This lets a class keep its
+ * members behind pointers that make its defaulted copy constructor cheap while every copy still
+ * behaves as if it owned its own members.
+ *
+ * A std::pmr container bound to a memory resource other than the default resource is never shared,
+ * copying it copies the container into the default resource like its own copy constructor does so
+ * the copy never depends on the other object's resource.
+ *
+ * Like std::shared_ptr copies may be used from different threads, the same cow_ptr may not.
+ */
+template<typename T>
+struct cow_ptr
+{
+    cow_ptr()  = default;
+    ~cow_ptr() = default;
+
+    cow_ptr(const cow_ptr<T>& other) : m_ptr(share(other)) {}
+    cow_ptr(cow_ptr<T>&& other) noexcept = default;
+
+    auto operator=(const cow_ptr<T>& other) -> cow_ptr<T>&
+    {
+        if (std::addressof(other) != this)
+        {
+            m_ptr = share(other);
+        }
+        return *this;
+    }
+
+    auto operator=(cow_ptr<T>&& other) noexcept -> cow_ptr<T>& = default;
+
+    /**
+     * @return The object, or a shared empty object if there is none.
+     */
+    auto value_or_empty() const -> const T&
+    {
+        static const T empty{};
+        return (m_ptr != nullptr) ? *m_ptr : empty;
+    }
+
+    /**
+     * @param args The arguments to construct the object with if there is none yet.
+     * @return The object for modification, copied first if it is shared with another cow_ptr.
+     */
+    template<typename... args_type>
+    auto mutate(args_type&&... args) -> T&
+    {
+        if (m_ptr == nullptr)
+        {
+            m_ptr = std::make_shared<T>(std::forward<args_type>(args)...);
+        }
+        else if (m_ptr.use_count() > 1)
+        {
+            m_ptr = std::make_shared<T>(*m_ptr);
+        }
+        else
+        {
+            // use_count() is a relaxed load, this orders the write after the reads of the last other
+            // owner, e.g. a copy that was read and destroyed on the event loop thread.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *m_ptr;
+    }
+
+    /**
+     * Replaces the object, a shared object is left to its other owners instead of being copied.
+     * @param value The new object.
+     */
+    auto assign(T value) -> void
+    {
+        if (m_ptr != nullptr && m_ptr.use_count() == 1)
+        {
+            // See mutate(), the other owners' reads must happen before this write.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            *m_ptr = std::move(value);
+        }
+        else
+        {
+            m_ptr = std::make_shared<T>(std::move(value));
+        }
+    }
+
+    std::shared_ptr<T> m_ptr{nullptr};
+
+private:
+    static auto share(const cow_ptr<T>& other) -> std::shared_ptr<T>
+    {
+        if constexpr (uses_polymorphic_allocator<T>::value)
+        {
+            if (other.m_ptr != nullptr && other.m_ptr->get_allocator().resource() != std::pmr::get_default_resource())
+            {
+                return std::make_shared<T>(*other.m_ptr);
+            }
+        }
+        return other.m_ptr;
+    }
+};
+
+/**
+ * Moves the elements of a std::pmr container into storage from the given memory resource.
+ * Polymorphic allocators never propagate on assignment or swap, so the only way to change the
+ * resource a container allocates from is to construct a new container in its place.
+ * @param container The container to rebind, its elements are moved.
+ * @param resource The memory resource the container allocates from afterwards.
+ */
+template<typename container_type>
+auto rebind_memory_resource(container_type& container, std::pmr::memory_resource* resource) -> void
+{
+    container_type rebound{
+        std::make_move_iterator(container.begin()), std::make_move_iterator(container.end()), resource};
+    container.~container_type();
+    // The move constructor keeps the allocator of the container it moves from.
+    new (&container) container_type{std::move(rebound)};
+}
+
 } // namespace lift::impl
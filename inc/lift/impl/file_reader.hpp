@@ -0,0 +1,170 @@
+#pragma once
+
+#include <curl/curl.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lift::impl
+{
+class file_reader;
+
+/**
+ * The file backing a single MIME part of an asynchronous request.  libcurl pulls the part's bytes
+ * through read() on the event loop thread, which only ever copies out of buffers the file_reader's
+ * background thread has already filled.  When no data is buffered the transfer is paused and
+ * resumed once the next buffer arrives, so a slow disk only stalls the one upload.
+ */
+class file_source : public std::enable_shared_from_this<file_source>
+{
+public:
+    /// The size of each read-ahead buffer.
+    static constexpr std::size_t chunk_size{64 * 1024};
+    /// The number of buffers read ahead of libcurl.
+    static constexpr std::size_t read_ahead{4};
+
+    /**
+     * @param reader The background reader to fill this source's buffers.
+     * @param path The file to read.
+     * @param size The number of bytes to send, if the file is shorter the transfer fails.
+     * @param curl_handle The transfer to resume when data arrives after it paused.
+     */
+    file_source(file_reader& reader, std::filesystem::path path, uint64_t size, CURL* curl_handle);
+    ~file_source();
+
+    file_source(const file_source&) = delete;
+    file_source(file_source&&)      = delete;
+    auto operator=(const file_source&) -> file_source& = delete;
+    auto operator=(file_source&&) -> file_source& = delete;
+
+    /**
+     * Starts reading ahead, call once the source is owned by a std::shared_ptr.
+     */
+    auto start() -> void;
+
+    /**
+     * Detaches the source from its transfer, buffers still being read are discarded.  Only called
+     * from the event loop thread.
+     */
+    auto cancel() -> void;
+
+    /**
+     * @return The transfer waiting on this source, nullptr once cancelled.  Only called from the
+     *         event loop thread.
+     */
+    [[nodiscard]] auto curl_handle() const -> CURL* { return m_curl_handle; }
+
+    /// libcurl read callback for curl_mime_data_cb(), arg is the file_source.
+    static auto curl_read(char* buffer, size_t size, size_t nitems, void* arg) -> size_t;
+    /// libcurl seek callback for curl_mime_data_cb(), arg is the file_source.
+    static auto curl_seek(void* arg, curl_off_t offset, int origin) -> int;
+
+private:
+    friend file_reader;
+
+    /**
+     * Reads the next buffer, only called from the file_reader's thread.
+     * @return True if the source wants another buffer read.
+     */
+    auto fill() -> bool;
+
+    /**
+     * Queues a read on the file_reader if one is needed and none is queued, m_mutex must be held.
+     */
+    auto schedule_locked() -> void;
+
+    file_reader& m_reader;
+    /// The file to read.
+    std::filesystem::path m_path;
+    /// The number of bytes to send.
+    uint64_t m_size{0};
+    /// The open file, only used from the file_reader's thread.
+    int m_fd{-1};
+    /// The transfer to resume, only used from the event loop thread.
+    CURL* m_curl_handle{nullptr};
+
+    std::mutex m_mutex{};
+    /// Buffers read but not yet handed to libcurl.
+    std::deque<std::string> m_buffers{};
+    /// The number of bytes of the front buffer already handed to libcurl.
+    std::size_t m_front_offset{0};
+    /// The file offset of the next read.
+    uint64_t m_read_offset{0};
+    /// Incremented when libcurl seeks so a read in progress for the old position is discarded.
+    uint64_t m_generation{0};
+    /// Is a read queued or in progress on the file_reader?
+    bool m_read_queued{false};
+    /// Is the transfer paused waiting for a buffer?
+    bool m_paused{false};
+    /// Did opening or reading the file fail?
+    bool m_failed{false};
+    /// Has the source been detached from its transfer?
+    bool m_cancelled{false};
+};
+
+/**
+ * A background thread that performs all blocking file I/O for a client's MIME file parts.  Sources
+ * that have data for a paused transfer are collected and the owner is notified so it can resume
+ * them from the event loop thread.
+ */
+class file_reader
+{
+public:
+    /// Called from the reader's thread when a paused source has data, must be thread safe.
+    using on_ready_type = void (*)(void* user_data);
+
+    file_reader(on_ready_type on_ready, void* user_data);
+    ~file_reader();
+
+    file_reader(const file_reader&) = delete;
+    file_reader(file_reader&&)      = delete;
+    auto operator=(const file_reader&) -> file_reader& = delete;
+    auto operator=(file_reader&&) -> file_reader& = delete;
+
+    /**
+     * Queues a read for the source, the thread is started on first use.
+     */
+    auto enqueue(std::shared_ptr<file_source> source) -> void;
+
+    /**
+     * @return The sources that received data while their transfer was paused.
+     */
+    auto take_ready() -> std::vector<std::shared_ptr<file_source>>;
+
+    /**
+     * Stops and joins the thread, queued reads are dropped.
+     */
+    auto stop() -> void;
+
+private:
+    friend file_source;
+
+    auto run() -> void;
+
+    /**
+     * Hands a source with data for its paused transfer to the owner.
+     */
+    auto ready(std::shared_ptr<file_source> source) -> void;
+
+    on_ready_type m_on_ready{nullptr};
+    void*         m_user_data{nullptr};
+
+    std::mutex              m_mutex{};
+    std::condition_variable m_cv{};
+    /// Sources waiting for their next buffer to be read, served round robin.
+    std::deque<std::shared_ptr<file_source>> m_queue{};
+    /// Sources that received data while their transfer was paused.
+    std::vector<std::shared_ptr<file_source>> m_ready{};
+    bool                                      m_stopping{false};
+    std::thread                               m_thread{};
+};
+
+} // namespace lift::impl
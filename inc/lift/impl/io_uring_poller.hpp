@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+
+namespace lift::impl
+{
+/**
+ * Socket readiness notifications through a raw Linux io_uring instead of one uv_poll_t (and
+ * therefore one epoll_ctl) per socket interest change.  Interest changes are only written into the
+ * submission queue when libcurl requests them, they are all handed to the kernel together by
+ * submit() in a single io_uring_enter per event loop iteration.  The ring's file descriptor becomes
+ * readable whenever completions are available so the owning event loop only has to watch that one
+ * descriptor.
+ *
+ * Polls are one-shot and re-armed after every delivered event rather than multishot.  A multishot
+ * poll is edge triggered, but libcurl expects level triggered readiness and does not always drain a
+ * socket in a single action, so a multishot poll can stall a transfer until more data arrives.  A
+ * re-armed one-shot poll is checked against the socket's current state by the kernel and the re-arm
+ * rides along in the next batched submit, so it never costs an extra syscall.
+ *
+ * This class is only used from the client's background event loop thread.
+ */
+class io_uring_poller
+{
+public:
+    /// Poll mask bits reported to the ready callback, these match POLLIN/POLLOUT/POLLERR/POLLHUP.
+    static constexpr uint32_t readable = 0x001;
+    static constexpr uint32_t writable = 0x004;
+    static constexpr uint32_t error    = 0x008;
+    static constexpr uint32_t hangup   = 0x010;
+
+    /// Called for every socket that became ready, events is a mask of the above bits.
+    using on_ready_type = void (*)(void* user_data, int fd, uint32_t events);
+
+    /**
+     * @param entries The number of submission queue entries, completions are sized 4x this.
+     * @return A poller, or nullptr if the running kernel does not support io_uring (or it has
+     *         been disabled, e.g. by a seccomp profile).
+     */
+    static auto make_unique(uint32_t entries) -> std::unique_ptr<io_uring_poller>;
+
+    ~io_uring_poller();
+
+    io_uring_poller(const io_uring_poller&) = delete;
+    io_uring_poller(io_uring_poller&&)      = delete;
+    auto operator=(const io_uring_poller&) -> io_uring_poller& = delete;
+    auto operator=(io_uring_poller&&) -> io_uring_poller& = delete;
+
+    /**
+     * @return The ring's file descriptor, readable when completions are waiting to be reaped.
+     */
+    [[nodiscard]] auto ring_fd() const -> int { return m_ring_fd; }
+
+    /**
+     * Queues (or updates) interest in the given socket.
+     * @param token The value previously returned for this socket, or nullptr for a new socket.
+     * @param fd The socket.
+     * @param events A mask of readable and/or writable.
+     * @return The token identifying this socket, pass it to later watch() and unwatch() calls.
+     */
+    auto watch(void* token, int fd, uint32_t events) -> void*;
+
+    /**
+     * Queues removal of all interest in the socket identified by token, the token is invalid afterwards.
+     */
+    auto unwatch(void* token) -> void;
+
+    /**
+     * Hands all queued interest changes to the kernel in a single io_uring_enter, polls that earlier
+     * found the submission queue full are queued again first.
+     */
+    auto submit() -> void;
+
+    /**
+     * Drains every available completion, calling on_ready for each socket that is still watched.
+     */
+    auto reap(on_ready_type on_ready, void* user_data) -> void;
+
+    /// @return The number of interest changes queued since construction.
+    [[nodiscard]] auto updates() const -> uint64_t { return m_updates; }
+    /// @return The number of io_uring_enter syscalls issued since construction, this includes the rare
+    ///         flush of completions that overflowed the completion queue.
+    [[nodiscard]] auto submits() const -> uint64_t { return m_submits; }
+
+private:
+    struct socket_watch
+    {
+        /// The socket being watched.
+        int fd{-1};
+        /// The poll mask libcurl is interested in.
+        uint32_t events{0};
+        /// Incremented on every re-registration so completions for a prior poll are ignored.
+        uint32_t generation{0};
+        /// The position of this watch in m_watches, encoded into each poll's user_data.
+        uint32_t index{0};
+        /// Is a poll for this socket currently queued or pending in the kernel?
+        bool armed{false};
+        /// Is this watch in use, or waiting in the free list?
+        bool active{false};
+    };
+
+    io_uring_poller() = default;
+
+    auto setup(uint32_t entries) -> bool;
+    auto next_sqe() -> void*;
+    auto queue_poll_add(socket_watch& w) -> void;
+    auto queue_poll_remove(socket_watch& w) -> void;
+
+    int m_ring_fd{-1};
+
+    /// Mapped submission queue ring, completion queue ring and submission queue entries.
+    void*       m_sq_ring{nullptr};
+    std::size_t m_sq_ring_size{0};
+    void*       m_cq_ring{nullptr};
+    std::size_t m_cq_ring_size{0};
+    void*       m_sqes{nullptr};
+    std::size_t m_sqes_size{0};
+
+    uint32_t* m_sq_head{nullptr};
+    uint32_t* m_sq_tail{nullptr};
+    uint32_t* m_sq_flags{nullptr};
+    uint32_t* m_sq_array{nullptr};
+    uint32_t  m_sq_mask{0};
+    uint32_t  m_sq_entries{0};
+    /// Local submission tail, published to the kernel in submit().
+    uint32_t m_sq_local_tail{0};
+
+    uint32_t* m_cq_head{nullptr};
+    uint32_t* m_cq_tail{nullptr};
+    void*     m_cqes{nullptr};
+    uint32_t  m_cq_mask{0};
+
+    /// Stable storage for each watched socket, handed to libcurl as the socket's token.
+    std::deque<socket_watch> m_watches{};
+    /// Indexes of inactive watches that can be re-used.
+    std::vector<uint32_t> m_free_watches{};
+    /// Indexes of watches whose poll could not be queued because the submission queue was full.
+    std::vector<uint32_t> m_rearm_pending{};
+
+    uint64_t m_updates{0};
+    uint64_t m_submits{0};
+};
+
+} // namespace lift::impl
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "lift/mime_template.hpp"
+
+#include <curl/curl.h>
+
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lift::impl
+{
+class file_source;
+
+/**
+ * @return The content type libcurl gives a file part with this file name, libcurl only derives
+ *         one itself for parts read with curl_mime_filedata().
+ */
+auto mime_type_for_filename(std::string_view filename) -> const char*;
+
+/**
+ * The body of a single request built from a lift::mime_template.  The body is a list of segments
+ * sent in order: the template's shared encoded parts, the request's own parts and the closing
+ * delimiter.  In memory segments are referenced, never copied, libcurl pulls the bytes through
+ * read() and may rewind them through seek().
+ */
+class mime_body
+{
+public:
+    /**
+     * @param mime_template The template whose encoded parts start the body, kept alive by the body.
+     */
+    explicit mime_body(std::shared_ptr<const lift::mime_template> mime_template);
+    ~mime_body();
+
+    mime_body(const mime_body&) = delete;
+    mime_body(mime_body&&)      = delete;
+    auto operator=(const mime_body&) -> mime_body& = delete;
+    auto operator=(mime_body&&) -> mime_body& = delete;
+
+    /**
+     * Appends bytes that outlive the transfer, e.g. a request's mime field value.
+     */
+    auto append(std::string_view data) -> void;
+
+    /**
+     * Appends bytes owned by the body.
+     */
+    auto append(std::string data) -> void;
+
+    /**
+     * Appends a file read ahead by the client's file_reader, for asynchronous requests.
+     * @param source The file's source, already started.
+     * @param size The number of bytes the source sends.
+     */
+    auto append(std::shared_ptr<file_source> source, uint64_t size) -> void;
+
+    /**
+     * Appends a file read with blocking reads on the calling thread, for synchronous requests.
+     * @param path The file to read, must outlive the transfer.
+     * @param size The number of bytes to send.
+     */
+    auto append(const std::filesystem::path& path, uint64_t size) -> void;
+
+    /**
+     * Appends the template's closing delimiter, the body is complete.
+     */
+    auto finish() -> void;
+
+    /**
+     * Marks the body as unsendable, e.g. a file part whose size is unknown.  The transfer is aborted
+     * on its first read.
+     */
+    auto fail() -> void { m_failed = true; }
+
+    /**
+     * @return The total number of bytes in the body.
+     */
+    auto size() const -> uint64_t { return m_size; }
+
+    /// libcurl CURLOPT_READFUNCTION, arg is the mime_body.
+    static auto curl_read(char* buffer, size_t size, size_t nitems, void* arg) -> size_t;
+    /// libcurl CURLOPT_SEEKFUNCTION, arg is the mime_body.
+    static auto curl_seek(void* arg, curl_off_t offset, int origin) -> int;
+
+private:
+    struct segment
+    {
+        /// The bytes of an in memory segment.
+        std::string_view data{};
+        /// The source of an asynchronous file segment.
+        std::shared_ptr<file_source> source{nullptr};
+        /// The path of a synchronous file segment.
+        const std::filesystem::path* path{nullptr};
+        /// The number of bytes in the segment.
+        uint64_t size{0};
+    };
+
+    /// Keeps the template's encoded parts alive for the transfer.
+    std::shared_ptr<const lift::mime_template> m_template{nullptr};
+    /// Storage for owned segments, a deque so appending never moves the bytes already referenced.
+    std::deque<std::string> m_storage{};
+    std::vector<segment>    m_segments{};
+    /// The total number of bytes in the body.
+    uint64_t m_size{0};
+    /// The segment libcurl reads next.
+    std::size_t m_index{0};
+    /// The number of bytes of the current segment already handed to libcurl.
+    uint64_t m_offset{0};
+    /// The open file of the synchronous file segment at m_fd_index.
+    int         m_fd{-1};
+    std::size_t m_fd_index{0};
+    /// Can the body not be sent?
+    bool m_failed{false};
+};
+
+} // namespace lift::impl
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lift
+{
+/**
+ * Where a request the client is executing is in its transfer, see client::inflight_snapshot().
+ */
+enum class inflight_phase
+{
+    /// Submitted to the client, the event loop has not started it yet.
+    queued,
+    /// Resolving the host name.
+    resolving,
+    /// Establishing the TCP connection.
+    connecting,
+    /// Performing the TLS handshake.
+    tls_handshake,
+    /// Sending the request or waiting for the first byte of the response.
+    waiting_for_first_byte,
+    /// Receiving the response.
+    receiving
+};
+
+auto to_string(inflight_phase phase) -> const std::string&;
+
+/**
+ * A single request the client is executing, see client::inflight_snapshot().
+ */
+struct inflight_request
+{
+    /// The request's url.
+    std::string url{};
+    /// Where the request is in its transfer.
+    inflight_phase phase{inflight_phase::queued};
+    /// How long ago the event loop started the request, zero while queued.
+    std::chrono::milliseconds age{0};
+    /// The number of request body bytes sent so far.
+    uint64_t bytes_sent{0};
+    /// The number of response body bytes received so far.
+    uint64_t bytes_received{0};
+    /// The time left until the request times out, negative for an orphaned transfer that is past
+    /// its timesup.  Not set if the request has no timeout.
+    std::optional<std::chrono::milliseconds> time_left{std::nullopt};
+    /// Has the user already received this request's timesup response?  See lift::orphan_policy.
+    bool orphaned{false};
+};
+
+/**
+ * Periodically reports the client's long running requests, see client::options::inflight_dump.
+ */
+struct inflight_dump
+{
+    using handler_type = std::function<void(const std::vector<inflight_request>& requests)>;
+
+    /// How often the in-flight requests are checked.
+    std::chrono::milliseconds interval{std::chrono::seconds{1}};
+    /// Only requests at least this old are reported.
+    std::chrono::milliseconds older_than{std::chrono::seconds{10}};
+    /// Called on the client's event loop thread with the requests at least older_than old, it is not
+    /// called when there are none.  It must not block, every request waits on it.
+    handler_type handler{nullptr};
+};
+
+} // namespace lift
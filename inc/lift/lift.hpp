@@ -1,13 +1,17 @@
 #pragma once
 
+#include "lift/batcher.hpp"
 #include "lift/client.hpp"
 #include "lift/const.hpp"
 #include "lift/escape.hpp"
 #include "lift/executor.hpp"
 #include "lift/header.hpp"
+#include "lift/inflight.hpp"
 #include "lift/init.hpp"
 #include "lift/lift_status.hpp"
 #include "lift/mime_field.hpp"
+#include "lift/mime_template.hpp"
+#include "lift/parallel_download.hpp"
 #include "lift/query_builder.hpp"
 #include "lift/request.hpp"
 #include "lift/resolve_host.hpp"
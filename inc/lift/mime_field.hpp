@@ -1,13 +1,19 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
+#include <optional>
 #include <string>
 #include <variant>
 
 namespace lift
 {
+class executor;
+
 class mime_field
 {
+    friend executor;
+
 public:
     mime_field(std::string field_name, std::string field_value);
 
@@ -22,6 +28,8 @@ public:
 private:
     std::string                                      m_field_name{};
     std::variant<std::string, std::filesystem::path> m_field_value{};
+    /// The size of the file when the field was created, unset if it could not be determined.
+    std::optional<uint64_t> m_file_size{std::nullopt};
 };
 
 } // namespace lift
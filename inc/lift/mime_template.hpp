@@ -0,0 +1,90 @@
+#pragma once
+
+#include "lift/mime_field.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lift
+{
+class executor;
+
+namespace impl
+{
+class mime_body;
+} // namespace impl
+
+/**
+ * A multipart form whose shared parts are encoded once and reused by every request built from it.
+ * Requests given the template send its parts first followed by their own mime fields, only the
+ * per-request parts are encoded for each request.  A template is immutable once built and can be
+ * shared across requests, clients and threads.
+ */
+class mime_template
+{
+    /// Sends the template's header.
+    friend executor;
+    /// Appends the template's trailer.
+    friend impl::mime_body;
+
+public:
+    /**
+     * @param fields The parts every request sends, file parts are read into memory here.
+     * @param content_length If true the total size of each request's body is computed before it
+     *                       is sent and sent as its Content-Length, if false the body is sent with
+     *                       chunked transfer encoding.
+     * @throw std::runtime_error If a file part cannot be read.
+     */
+    explicit mime_template(std::vector<lift::mime_field> fields, bool content_length = true);
+    ~mime_template() = default;
+
+    mime_template(const mime_template&) = delete;
+    mime_template(mime_template&&)      = delete;
+    auto operator=(const mime_template&) -> mime_template& = delete;
+    auto operator=(mime_template&&) -> mime_template& = delete;
+
+    static auto make_shared(std::vector<lift::mime_field> fields, bool content_length = true)
+        -> std::shared_ptr<const mime_template>
+    {
+        return std::make_shared<const mime_template>(std::move(fields), content_length);
+    }
+
+    /**
+     * @return The boundary separating the parts of every request built from this template.
+     */
+    auto boundary() const -> const std::string& { return m_boundary; }
+
+    /**
+     * @return The encoded shared parts, sent at the start of every request's body.
+     */
+    auto encoded() const -> std::string_view { return m_encoded; }
+
+    /**
+     * @return True if requests send their body's Content-Length instead of chunked encoding.
+     */
+    auto content_length() const -> bool { return m_content_length; }
+
+private:
+    /// The random part boundary.
+    std::string m_boundary{};
+    /// The "Content-Type: multipart/form-data; boundary=..." request header.
+    std::string m_content_type_header{};
+    /// The shared parts, each with its delimiter and part headers.
+    std::string m_encoded{};
+    /// The closing delimiter that ends every body.
+    std::string m_trailer{};
+    /// Should the body's Content-Length be sent?
+    bool m_content_length{true};
+
+    /**
+     * Encodes the delimiter and part headers that precede a part's data, the data must be
+     * followed by "\r\n".
+     * @param field The part to encode.
+     */
+    auto part_header(const lift::mime_field& field) const -> std::string;
+};
+
+} // namespace lift
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "lift/header.hpp"
+#include "lift/http.hpp"
+#include "lift/lift_status.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lift
+{
+class client;
+
+/**
+ * The destination of a parallel download.  Byte ranges complete out of order and each one is
+ * written at its offset as soon as it arrives, all calls are made from the thread that called
+ * lift::parallel_download().
+ */
+class download_sink
+{
+public:
+    download_sink()          = default;
+    virtual ~download_sink() = default;
+
+    download_sink(const download_sink&) = delete;
+    download_sink(download_sink&&)      = delete;
+    auto operator=(const download_sink&) -> download_sink& = delete;
+    auto operator=(download_sink&&) -> download_sink& = delete;
+
+    /**
+     * Called once before any data is written.
+     * @param size The total size of the object in bytes.
+     * @return True if the sink is ready to receive `size` bytes.
+     */
+    virtual auto prepare(uint64_t size) -> bool = 0;
+
+    /**
+     * Called instead of prepare() when a download resumes from a checkpoint, the data previously
+     * written must be kept.  Sinks that cannot resume return false and the download starts over.
+     * @param size The total size of the object in bytes.
+     * @return True if the sink is ready to receive the remaining ranges.
+     */
+    virtual auto resume(uint64_t /*size*/) -> bool { return false; }
+
+    /**
+     * Reads back previously written data so it can be verified before a resumed download reuses it.
+     * @param offset The offset into the object of the first byte to read.
+     * @param length The number of bytes to read.
+     * @param out Receives the bytes read.
+     * @return True if all `length` bytes were read.
+     */
+    virtual auto read(uint64_t /*offset*/, uint64_t /*length*/, std::string& /*out*/) -> bool { return false; }
+
+    /**
+     * @param offset The offset into the object of the first byte in `data`.
+     * @param data The bytes to write.
+     * @return True if all of `data` was written.
+     */
+    virtual auto write(uint64_t offset, std::string_view data) -> bool = 0;
+
+    /**
+     * Called once after every range has been written successfully.
+     * @return True if the sink flushed successfully.
+     */
+    virtual auto finish() -> bool { return true; }
+};
+
+/**
+ * Writes the download into a file with pwrite(), the file is created or truncated.
+ */
+class file_download_sink : public download_sink
+{
+public:
+    explicit file_download_sink(std::filesystem::path path);
+    ~file_download_sink() override;
+
+    file_download_sink(const file_download_sink&) = delete;
+    file_download_sink(file_download_sink&&)      = delete;
+    auto operator=(const file_download_sink&) -> file_download_sink& = delete;
+    auto operator=(file_download_sink&&) -> file_download_sink& = delete;
+
+    auto prepare(uint64_t size) -> bool override;
+    auto resume(uint64_t size) -> bool override;
+    auto read(uint64_t offset, uint64_t length, std::string& out) -> bool override;
+    auto write(uint64_t offset, std::string_view data) -> bool override;
+    auto finish() -> bool override;
+
+private:
+    /// The file to write into.
+    std::filesystem::path m_path;
+    /// The open file descriptor, -1 until prepare() succeeds.
+    int m_fd{-1};
+};
+
+/**
+ * Writes the download into a file through a shared memory mapping of the whole file, the file is
+ * created or truncated and sized up front.
+ */
+class mmap_download_sink : public download_sink
+{
+public:
+    explicit mmap_download_sink(std::filesystem::path path);
+    ~mmap_download_sink() override;
+
+    mmap_download_sink(const mmap_download_sink&) = delete;
+    mmap_download_sink(mmap_download_sink&&)      = delete;
+    auto operator=(const mmap_download_sink&) -> mmap_download_sink& = delete;
+    auto operator=(mmap_download_sink&&) -> mmap_download_sink& = delete;
+
+    auto prepare(uint64_t size) -> bool override;
+    auto resume(uint64_t size) -> bool override;
+    auto read(uint64_t offset, uint64_t length, std::string& out) -> bool override;
+    auto write(uint64_t offset, std::string_view data) -> bool override;
+    auto finish() -> bool override;
+
+private:
+    /// The file to write into.
+    std::filesystem::path m_path;
+    /// The open file descriptor, -1 until prepare() succeeds.
+    int m_fd{-1};
+    /// The mapping of the whole file, nullptr until prepare() succeeds or for empty objects.
+    char* m_data{nullptr};
+    /// The size of the mapping in bytes.
+    uint64_t m_size{0};
+
+    /**
+     * Opens, sizes and maps the file.
+     * @param size The total size of the object in bytes.
+     * @param flags Additional open() flags, O_TRUNC to discard the previous contents.
+     */
+    auto map(uint64_t size, int flags) -> bool;
+};
+
+struct parallel_download_options
+{
+    /// The client to issue the requests through, if nullptr a client is created for the download.
+    lift::client* client{nullptr};
+    /// The number of byte ranges downloaded concurrently, each over its own connection for HTTP/1.1.
+    uint64_t chunks{4};
+    /// If set the object is split into more ranges than `chunks` so none is larger than this,
+    /// every range is held in memory until it is written so this bounds the memory used.  Unset
+    /// only for objects known to fit in memory, each range is then up to a `chunks`th of the object.
+    std::optional<uint64_t> max_chunk_size{8 * 1024 * 1024};
+    /// Objects smaller than this are downloaded with a single request.
+    uint64_t min_chunk_size{64 * 1024};
+    /// The timeout for the probe and for each individual range request.
+    std::chrono::milliseconds timeout{std::chrono::seconds{60}};
+    /// The number of times a single failed range is retried before the download fails.
+    uint64_t max_retries{3};
+    /// Additional headers sent with every request, e.g. authorization.
+    std::vector<lift::header> headers{};
+    /// If set the download's progress is persisted to this file as every range is written, a later
+    /// download of the same unchanged object into the same sink resumes from it.  Removed once the
+    /// download succeeds.  Progress is tracked per range so `max_chunk_size` sets how much can be lost.
+    std::optional<std::filesystem::path> checkpoint{std::nullopt};
+};
+
+struct parallel_download_result
+{
+    /// The status of the download, success only if every byte was written to the sink.  A sink
+    /// failure or an object that changed while it was being downloaded is reported as error.
+    lift::lift_status lift_status{lift::lift_status::building};
+    /// The status code of the failed request, or of the probe on success.
+    http::status_code status_code{http::status_code::http_unknown};
+    /// The total size of the object in bytes.
+    uint64_t size{0};
+    /// True if the object was downloaded in byte ranges, false if the server does not support them.
+    bool ranged{false};
+    /// The number of range requests the object was split into.
+    uint64_t ranges{0};
+    /// The number of range requests that were retried.
+    uint64_t retries{0};
+    /// The number of bytes reused from a checkpoint after verifying them, not downloaded again.
+    uint64_t resumed_bytes{0};
+    /// The wall clock time of the whole download, including the probe.
+    std::chrono::milliseconds total_time{0};
+};
+
+/**
+ * Downloads `url` into `sink` over several connections at once.  The object's size and range
+ * support are probed with a HEAD request, then the object is split into byte ranges that are
+ * issued through a lift::client and written into the sink at their offsets as they complete.  A
+ * range that fails is retried on its own up to `max_retries` times.  If the server does not
+ * support byte ranges or does not report the size the object is downloaded with a single request.
+ * The ranges are conditional on the probed ETag or Last-Modified, if the object changes during the
+ * download it fails instead of mixing two versions.  With `checkpoint` set the ranges written so
+ * far survive a failure or process restart, their data is verified against the checkpoint's
+ * checksums before a resumed download reuses it.
+ *
+ * This function blocks until the download completes or fails.
+ *
+ * @param url The url of the object to download.
+ * @param sink The destination of the object's bytes.
+ * @param options How to split and issue the download.
+ * @return The result of the download.
+ */
+auto parallel_download(std::string url, download_sink& sink, parallel_download_options options = {})
+    -> parallel_download_result;
+
+} // namespace lift
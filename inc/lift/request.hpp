@@ -4,6 +4,7 @@
 #include "lift/http.hpp"
 #include "lift/impl/copy_util.hpp"
 #include "lift/mime_field.hpp"
+#include "lift/mime_template.hpp"
 #include "lift/resolve_host.hpp"
 #include "lift/response.hpp"
 #include "lift/share.hpp"
@@ -11,6 +12,7 @@
 #include <chrono>
 #include <functional>
 #include <future>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -138,6 +140,24 @@ public:
      */
     explicit request(std::string url, std::optional<std::chrono::milliseconds> timeout = std::nullopt);
 
+    /**
+     * Creates a new request whose headers, mime field list and response allocate from the given
+     * memory resource, e.g. a std::pmr::monotonic_buffer_resource per inbound call that is released
+     * all at once.  The url and POST data are moved in from the caller and are not re-allocated.
+     *
+     * The resource must outlive the request and its response.  Copies of the request (including the
+     * one handed back on timesup) allocate from the std::pmr default resource, but their responses
+     * still use this resource.
+     *
+     * @param url The url to request.
+     * @param timeout An optional timeout for this request.
+     * @param resource The memory resource to allocate from, std::pmr default if nullptr.
+     */
+    request(
+        std::string                              url,
+        std::optional<std::chrono::milliseconds> timeout,
+        std::pmr::memory_resource*               resource);
+
     /**
      * Creates a new request on the heap, this is a useful utility for asynchronous requests.
      *
@@ -160,6 +180,16 @@ public:
     auto operator=(const request&) noexcept -> request& = default;
     auto operator=(request&&) noexcept -> request& = default;
 
+    /**
+     * Copies this request for fan-out, retries or hedging.  Copying a request is cheap, the copy
+     * shares the url, headers, body and rarely used settings with this request and only allocates
+     * for the ones either request changes afterwards.  Unlike the copy constructor the copy never
+     * takes over this request's asynchronous completion handler.
+     *
+     * @return The copy on the heap, ready to be changed and started on a client.
+     */
+    auto clone() const -> std::unique_ptr<request>;
+
     /**
      * Synchronously executes this request.
      *
@@ -209,11 +239,11 @@ public:
     /**
      * @return The URL of the HTTP request.
      */
-    auto url() const -> const std::string& { return m_url; }
+    auto url() const -> const std::string& { return m_url.value_or_empty(); }
     /**
      * @param url The URL of the HTTP request.
      */
-    auto url(std::string url) -> void { m_url = std::move(url); }
+    auto url(std::string url) -> void { m_url.assign(std::move(url)); }
 
     /**
      * @return The HTTP method this request will use.
@@ -228,7 +258,7 @@ public:
     /**
      * @return The HTTP version this request will use.
      */
-    auto version() const -> http::version { return m_version; }
+    auto version() const -> http::version { return m_version.value_or(http::version::use_best); }
 
     /**
      * @param version The HTTP version this request should use.
@@ -238,7 +268,7 @@ public:
     /**
      * @return Is the HTTP request automatically following redirects?
      */
-    auto follow_redirects() const -> bool { return m_follow_redirects; }
+    auto follow_redirects() const -> bool { return m_follow_redirects.value_or(true); }
 
     /**
      * @return If following HTTP redirects, what is the maximum allowed to follow?
@@ -256,7 +286,7 @@ public:
     /**
      * @return Is the peer SSL/TLS verified?
      */
-    auto verify_ssl_peer() const -> bool { return m_verify_ssl_peer; }
+    auto verify_ssl_peer() const -> bool { return m_verify_ssl_peer.value_or(true); }
 
     /**
      * This feature defaults to enabled.
@@ -268,7 +298,7 @@ public:
      * This feature defaultes to enabled.
      * @return Is the SSL/TLS host verified?
      */
-    auto verify_ssl_host() const -> bool { return m_verify_ssl_host; }
+    auto verify_ssl_host() const -> bool { return m_verify_ssl_host.value_or(true); }
 
     /**
      * @param verify_ssl_host Should the SSL/TLS host be verified?
@@ -283,52 +313,55 @@ public:
     /**
      * @return Is the SSL/TLS certificate status be checked?
      */
-    auto verify_ssl_status() const -> bool { return m_verify_ssl_status; }
+    auto verify_ssl_status() const -> bool { return m_verify_ssl_status.value_or(false); }
 
     /**
      * @param cert_file The SSL/TLS certificate file to use.
      */
-    auto ssl_cert(std::filesystem::path cert_file) -> void { m_cert_file = std::move(cert_file); }
+    auto ssl_cert(std::filesystem::path cert_file) -> void { mutable_extensions().cert_file = std::move(cert_file); }
 
     /**
      * @return The SSL/TLS certificate file being used.
      */
-    auto ssl_cert() const -> const std::optional<std::filesystem::path>& { return m_cert_file; }
+    auto ssl_cert() const -> const std::optional<std::filesystem::path>& { return extensions_or_empty().cert_file; }
 
     /**
      * @param type The SSL/TLS certificate type.
      */
-    auto ssl_cert_type(ssl_certificate_type type) -> void { m_ssl_cert_type = type; }
+    auto ssl_cert_type(ssl_certificate_type type) -> void { mutable_extensions().ssl_cert_type = type; }
 
     /**
      * @return The SSL/TSL certificate type being used.
      */
-    auto ssl_cert_type() const -> const std::optional<ssl_certificate_type>& { return m_ssl_cert_type; }
+    auto ssl_cert_type() const -> const std::optional<ssl_certificate_type>&
+    {
+        return extensions_or_empty().ssl_cert_type;
+    }
 
     /**
      * @param key_file The SSL/TLS key file to use.
      */
-    auto ssl_key(std::filesystem::path key_file) -> void { m_ssl_key_file = std::move(key_file); }
+    auto ssl_key(std::filesystem::path key_file) -> void { mutable_extensions().ssl_key_file = std::move(key_file); }
 
     /**
      * @return The SSL/TLS key file being used.
      */
-    auto ssl_key() const -> const std::optional<std::filesystem::path>& { return m_ssl_key_file; }
+    auto ssl_key() const -> const std::optional<std::filesystem::path>& { return extensions_or_empty().ssl_key_file; }
 
     /**
      * @param password The pass phrase for the private key.
      */
-    auto key_password(std::string password) -> void { m_password = std::move(password); }
+    auto key_password(std::string password) -> void { mutable_extensions().password = std::move(password); }
 
     /**
      * @return The pass phrase for the private key.
      */
-    auto key_password() const -> const std::optional<std::string>& { return m_password; }
+    auto key_password() const -> const std::optional<std::string>& { return extensions_or_empty().password; }
 
     /**
      * @return The proxy information for this request.
      */
-    auto proxy() const -> const std::optional<proxy_data>& { return m_proxy_data; }
+    auto proxy() const -> const std::optional<proxy_data>& { return extensions_or_empty().proxy; }
 
     /**
      * Sets proxy information for this request.
@@ -348,7 +381,7 @@ public:
         std::optional<std::string>                 password   = std::nullopt,
         std::optional<std::vector<http_auth_type>> auth_types = std::nullopt) -> void
     {
-        m_proxy_data =
+        mutable_extensions().proxy =
             proxy_data{type, std::move(host), port, std::move(username), std::move(password), std::move(auth_types)};
     }
 
@@ -356,44 +389,56 @@ public:
      * Sets proxy information for this request.
      * @param data The full proxy data to set for this request, @see `proxy_data`.
      */
-    auto proxy(proxy_data data) -> void { m_proxy_data = std::move(data); }
+    auto proxy(proxy_data data) -> void { mutable_extensions().proxy = std::move(data); }
 
     /**
      * @return The list of currently set HTTP Accept-Encoding values.  Note that if set via
      *         `AcceptEndcodingAllAvaliable()` this function will return an empty list.
      */
-    auto accept_encodings() const -> const std::optional<std::vector<std::string>>& { return m_accept_encodings; }
+    auto accept_encodings() const -> const std::optional<std::vector<std::string>>&
+    {
+        return extensions_or_empty().accept_encodings;
+    }
     /**
      * IMPORTANT: Using this is mutually exclusive with adding your own Accept-Encoding header.
      * @param encodings A list of accept encodings to send in the request.
      */
     auto accept_encoding(std::optional<std::vector<std::string>> encodings) -> void
     {
-        m_accept_encodings = std::move(encodings);
+        if (encodings.has_value() || m_extensions.m_ptr != nullptr)
+        {
+            mutable_extensions().accept_encodings = std::move(encodings);
+        }
     }
 
     /**
      * Sets the accept encoding header to all supported encodings that this platform was built with.
      */
-    auto accept_encoding_all_available() -> void { m_accept_encodings = std::vector<std::string>{}; }
+    auto accept_encoding_all_available() -> void { mutable_extensions().accept_encodings = std::vector<std::string>{}; }
 
     /**
      * @return Custom `host:port => ip_addr` resolve hosts for this request.
      */
-    auto resolve_hosts() const -> const std::vector<lift::resolve_host>& { return m_resolve_hosts; }
+    auto resolve_hosts() const -> const std::vector<lift::resolve_host>& { return extensions_or_empty().resolve_hosts; }
 
     /**
      * @param resolve_host Adds a resolve host to this request to bypass DNS lookups.
      */
     auto resolve_host(lift::resolve_host resolve_host) -> void
     {
-        m_resolve_hosts.emplace_back(std::move(resolve_host));
+        mutable_extensions().resolve_hosts.emplace_back(std::move(resolve_host));
     }
 
     /**
      * Clears all set resolve hosts on this request.
      */
-    auto clear_resolve_hosts() -> void { m_resolve_hosts.clear(); }
+    auto clear_resolve_hosts() -> void
+    {
+        if (!extensions_or_empty().resolve_hosts.empty())
+        {
+            mutable_extensions().resolve_hosts.clear();
+        }
+    }
 
     /**
      * Specifically removes the header from the request.  There are a few
@@ -413,17 +458,17 @@ public:
      * @return The current list of headers added to this request.  Note that if more headers are added
      *         the header classes Name() and Value() string_views might become invalidated.
      */
-    auto headers() const -> const std::vector<lift::header>& { return m_request_headers; }
+    auto headers() const -> const std::pmr::vector<lift::header>& { return m_request_headers.value_or_empty(); }
 
     /**
      * Clears the current set of headers for this request.
      */
-    auto clear_headers() -> void { m_request_headers.clear(); }
+    auto clear_headers() -> void { m_request_headers.m_ptr = nullptr; }
 
     /**
      * @return The HTTP body data for this request, if it was never set this will be an empty string.
      */
-    auto data() const -> const std::string& { return m_request_data; }
+    auto data() const -> const std::string& { return m_request_data.value_or_empty(); }
 
     /**
      * Sets the request to HTTP POST and the body of the request
@@ -440,90 +485,180 @@ public:
     /**
      * @return The set mime fields for this request.
      */
-    auto mime_fields() const -> const std::vector<lift::mime_field>& { return m_mime_fields; }
+    auto mime_fields() const -> const std::pmr::vector<lift::mime_field>& { return m_mime_fields.value_or_empty(); }
 
     /**
      * @param mf Adds this mime field to this mime HTTP request.
      */
     auto mime_field(lift::mime_field mf) -> void;
 
+    /**
+     * Builds this request's body from a compiled multipart template, the template's shared parts
+     * are sent first followed by this request's mime fields.  The request is sent as an HTTP POST.
+     *
+     * NOTE: this is mutually exclusive with POST data, like mime_field().
+     *
+     * @param mime_template The template to build the body from, nullptr to stop using one.
+     * @throw std::logic_error If called after using data().
+     */
+    auto mime_template(std::shared_ptr<const lift::mime_template> mime_template) -> void;
+
+    /**
+     * @return The compiled multipart template this request's body is built from, if any.
+     */
+    auto mime_template() const -> const std::shared_ptr<const lift::mime_template>&
+    {
+        return extensions_or_empty().mime_template;
+    }
+
+    /**
+     * @return The memory resource this request was created with, or nullptr if it uses the std::pmr default.
+     */
+    auto memory_resource() const -> std::pmr::memory_resource* { return m_memory_resource; }
+
     /**
      * https://en.wikipedia.org/wiki/Happy_Eyeballs
      * @param timeout Sets the happy eyeballs algorithm timeout.
      */
-    auto happy_eyeballs_timeout(std::chrono::milliseconds timeout) -> void { m_happy_eyeballs_timeout = timeout; }
+    auto happy_eyeballs_timeout(std::chrono::milliseconds timeout) -> void
+    {
+        mutable_extensions().happy_eyeballs_timeout = timeout;
+    }
 
     /**
      * @return Gets the setting of the happy eyeballs timeout if set.
      */
     auto happy_eyeballs_timeout() const -> const std::optional<std::chrono::milliseconds>&
     {
-        return m_happy_eyeballs_timeout;
+        return extensions_or_empty().happy_eyeballs_timeout;
+    }
+
+    /**
+     * @param tenant The tenant this request is scheduled as by a client with fair queuing, see
+     *               client::options::fair_queuing.  Empty is the default tenant.
+     */
+    auto tenant(std::string tenant) -> void
+    {
+        if (!tenant.empty() || m_extensions.m_ptr != nullptr)
+        {
+            mutable_extensions().tenant = std::move(tenant);
+        }
     }
 
+    /**
+     * @return The tenant this request is scheduled as, empty for the default tenant.
+     */
+    auto tenant() const -> const std::string& { return extensions_or_empty().tenant; }
+
     /**
      * @param callback_functor The callback for `debug_info_type` set of information about this
      *                         http request.  To un-set this for a request pass in nullptr for the
      *                         functor.
      */
-    auto debug_info_handler(debug_info_callback_type callback_functor) -> void
-    {
-        m_debug_info_handler = std::move(callback_functor);
-    }
+    auto debug_info_handler(debug_info_callback_type callback_functor) -> void;
 
 private:
     /// The on complete handler callback or promise to fulfill, this is only used for async requests.
     impl::copy_but_actually_move<async_handlers_type> m_on_complete_handler{std::monostate{}};
-    /// The transfer progress handler callback.
-    transfer_progress_handler_type m_on_transfer_progress_handler{nullptr};
     /// The timeout to connect, or none.
     std::optional<std::chrono::milliseconds> m_connect_timeout{};
     /// The timeout for the request, or none.
     std::optional<std::chrono::milliseconds> m_timeout{};
     /// The timesup for the request, or none.
     std::optional<std::chrono::milliseconds> m_timesup{};
+    // The url, headers, body and extensions are copy-on-write so copying a request for fan-out or
+    // a retry only bumps reference counts, a copy allocates for the fields it changes.
+
     /// The URL.
-    std::string m_url{};
+    impl::cow_ptr<std::string> m_url{};
     /// The HTTP request method.
     http::method m_method{http::method::get};
+    // The following settings are only set when the user sets them so that a client's
+    // request_defaults can fill in the rest, the getters report the library defaults otherwise.
+
     /// The HTTP version to use for this request.
-    http::version m_version{http::version::use_best};
+    std::optional<http::version> m_version{};
     /// Should this request automatically follow redirects?
-    bool m_follow_redirects{true};
+    std::optional<bool> m_follow_redirects{};
     /// How many redirects should be followed? -1 infinite, 0 none, <num>.
     int64_t m_max_redirects{-1};
     /// Should the peer be ssl verified?
-    bool m_verify_ssl_peer{true};
+    std::optional<bool> m_verify_ssl_peer{};
     /// Should the host be ssl verified?
-    bool m_verify_ssl_host{true};
+    std::optional<bool> m_verify_ssl_host{};
     /// Should the ssl certificate status be verified?
-    bool m_verify_ssl_status{false};
-    /// The SSL/TLS certificate file to use.
-    std::optional<std::filesystem::path> m_cert_file{};
-    /// The SSL/TLS certificate type.
-    std::optional<ssl_certificate_type> m_ssl_cert_type{};
-    /// The SSL/TLS key file.
-    std::optional<std::filesystem::path> m_ssl_key_file{};
-    /// The SSL/TLS key file's pass phrase.
-    std::optional<std::string> m_password{};
-    /// Proxy information.
-    std::optional<proxy_data> m_proxy_data{};
-    /// Specific Accept-Encoding header fields.
-    std::optional<std::vector<std::string>> m_accept_encodings{};
-    /// A set of host:port to ip addresses that will be resolved before DNS.
-    std::vector<lift::resolve_host> m_resolve_hosts{};
-    /// The request headers preformatted into the curl "Header: value\0" format.
-    std::vector<lift::header> m_request_headers{};
+    std::optional<bool> m_verify_ssl_status{};
+    /// The request headers preformatted into the curl "Header: value\0" format, created with the
+    /// request's memory resource by the first header.
+    impl::cow_ptr<std::pmr::vector<lift::header>> m_request_headers{};
     /// The POST request body data, mutually exclusive with mime field requests.
-    bool        m_request_data_set{false};
-    std::string m_request_data{};
-    /// The Mime request fields, mutually exclusive with POST request body data.
-    bool                          m_mime_fields_set{false};
-    std::vector<lift::mime_field> m_mime_fields{};
-    /// Happy eyeballs algorithm timeout https://curl.haxx.se/libcurl/c/CURLOPT_HAPPY_EYEBALLS_TIMEOUT_MS.html
-    std::optional<std::chrono::milliseconds> m_happy_eyeballs_timeout{};
-    /// The debug callback functor for `debug_info_type` information.  If nullptr will not be set.
-    debug_info_callback_type m_debug_info_handler{nullptr};
+    bool                       m_request_data_set{false};
+    impl::cow_ptr<std::string> m_request_data{};
+    /// The Mime request fields, mutually exclusive with POST request body data.  Created with the
+    /// request's memory resource by the first field.
+    bool                                              m_mime_fields_set{false};
+    impl::cow_ptr<std::pmr::vector<lift::mime_field>> m_mime_fields{};
+    /// The memory resource given at construction, also used for this request's response.
+    std::pmr::memory_resource* m_memory_resource{nullptr};
+
+    /**
+     * Settings that almost every request leaves unset.  They live out of line so that requests which
+     * never set them do not pay for their size when being constructed, moved or copied, the block is
+     * only allocated by the first setter that needs it.
+     */
+    struct extensions
+    {
+        /// The transfer progress handler callback.
+        transfer_progress_handler_type transfer_progress_handler{nullptr};
+        /// The debug callback functor for `debug_info_type` information.  If nullptr will not be set.
+        debug_info_callback_type debug_info_handler{nullptr};
+        /// The SSL/TLS certificate file to use.
+        std::optional<std::filesystem::path> cert_file{};
+        /// The SSL/TLS certificate type.
+        std::optional<ssl_certificate_type> ssl_cert_type{};
+        /// The SSL/TLS key file.
+        std::optional<std::filesystem::path> ssl_key_file{};
+        /// The SSL/TLS key file's pass phrase.
+        std::optional<std::string> password{};
+        /// Proxy information.
+        std::optional<proxy_data> proxy{};
+        /// A set of host:port to ip addresses that will be resolved before DNS.
+        std::vector<lift::resolve_host> resolve_hosts{};
+        /// Happy eyeballs algorithm timeout https://curl.haxx.se/libcurl/c/CURLOPT_HAPPY_EYEBALLS_TIMEOUT_MS.html
+        std::optional<std::chrono::milliseconds> happy_eyeballs_timeout{};
+        /// The compiled multipart template the body is built from.
+        std::shared_ptr<const lift::mime_template> mime_template{};
+        /// Specific Accept-Encoding header fields.
+        std::optional<std::vector<std::string>> accept_encodings{};
+        /// The tenant a client with fair queuing schedules this request as.
+        std::string tenant{};
+    };
+
+    /// The rarely used settings, nullptr until one of them is set.
+    impl::cow_ptr<extensions> m_extensions{};
+
+    /**
+     * @return The rarely used settings, or a shared empty set if none have been set on this request.
+     */
+    auto extensions_or_empty() const -> const extensions&;
+
+    /**
+     * @return The rarely used settings for modification, allocated on first use and copied first if
+     *         they are still shared with a copy of this request.
+     */
+    auto mutable_extensions() -> extensions&;
+
+    /**
+     * @return The memory resource new headers and mime field lists are created with.
+     */
+    auto memory_resource_or_default() const -> std::pmr::memory_resource*;
+
+    /**
+     * Moves the headers and mime fields to the std::pmr default resource and forgets the request's
+     * memory resource.  Used for a request the client must keep alive after handing a copy of it
+     * back to the user, the user is free to release the resource at that point.
+     */
+    auto detach_memory_resource() -> void;
 
     /**
      * Used by the client to set an async callback for on completion notification to the user.
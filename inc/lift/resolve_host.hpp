@@ -51,11 +51,21 @@ private:
 
     /// A curl formatted version of the host + port + resolved ip address.
     std::string m_curl_formatted{};
+    /// A curl formatted version of the host + port + resolved ip address + port for connect-to.
+    std::string m_curl_formatted_connect_to{};
 
     /**
      * @return Gets the "host:port:ipaddress" curl formatted resolve host.
      */
     [[nodiscard]] auto curl_formatted_resolve_host() const noexcept -> const std::string& { return m_curl_formatted; }
+
+    /**
+     * @return Gets the "host:port:ipaddress:port" curl formatted connect-to.
+     */
+    [[nodiscard]] auto curl_formatted_connect_to() const noexcept -> const std::string&
+    {
+        return m_curl_formatted_connect_to;
+    }
 };
 
 } // namespace lift
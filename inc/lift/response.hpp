@@ -3,12 +3,14 @@
 #include "lift/header.hpp"
 #include "lift/http.hpp"
 #include "lift/lift_status.hpp"
+#include "lift/impl/copy_util.hpp"
 
 #include <curl/curl.h>
 #include <uv.h>
 
 #include <chrono>
 #include <iostream>
+#include <memory_resource>
 #include <optional>
 #include <string>
 #include <vector>
@@ -25,6 +27,10 @@ class response
 
 public:
     response();
+    /**
+     * @param resource The memory resource for the response's headers and data, std::pmr default if nullptr.
+     */
+    explicit response(std::pmr::memory_resource* resource);
     ~response() = default;
 
     response(const response&) = default;
@@ -55,7 +61,7 @@ public:
     /**
      * @return The HTTP response headers.
      */
-    [[nodiscard]] auto headers() const -> const std::vector<header>& { return m_headers; }
+    [[nodiscard]] auto headers() const -> const std::pmr::vector<header>& { return m_headers; }
 
     /**
      * @return The header if it exists on this response, otherwise std::nullopt.
@@ -94,9 +100,9 @@ private:
     /// Ordered by sizeof() since response gets std::moved()'ed back to the client.
 
     /// The response headers.
-    std::vector<lift::header> m_headers{};
+    std::pmr::vector<lift::header> m_headers{};
     /// The response data if any.
-    std::vector<char> m_data{};
+    std::pmr::vector<char> m_data{};
     /// The total time in milliseconds to execute the request, stored as uint32_t since that is enough
     /// time for 49~ days and saves 4 bytes from std::chrono::milliseconds.
     uint32_t m_total_time{0};
@@ -111,6 +117,17 @@ private:
     /// The number of redirects traversed while processing the request.
     uint8_t m_num_redirects{0};
 
+    /**
+     * @return The memory resource this response's headers and data allocate from.
+     */
+    auto memory_resource() const -> std::pmr::memory_resource* { return m_headers.get_allocator().resource(); }
+
+    /**
+     * Moves the response's headers and data into storage from the given memory resource.
+     * @param resource The memory resource to allocate from, std::pmr default if nullptr.
+     */
+    auto memory_resource(std::pmr::memory_resource* resource) -> void;
+
     /// libcurl will call this function when a header is received for the HTTP request.
     friend auto curl_write_header(char* buffer, size_t size, size_t nitems, void* user_ptr) -> size_t;
 
@@ -0,0 +1,170 @@
+#include "lift/batcher.hpp"
+#include "lift/client.hpp"
+
+#include <algorithm>
+#include <future>
+#include <iterator>
+
+namespace lift
+{
+auto on_uv_batcher_timer_callback(uv_timer_t* handle) -> void
+{
+    auto* b = static_cast<batcher*>(handle->data);
+    b->flush(false);
+}
+
+batcher::batcher(lift::client& client, options opts)
+    : m_client(client),
+      m_window_ms(static_cast<uint64_t>(std::max(opts.window.count(), std::chrono::milliseconds::rep{0}))),
+      m_max_batch_size(std::max(std::size_t{1}, opts.max_batch_size)),
+      m_merge(std::move(opts.merge))
+{
+    if (m_merge == nullptr)
+    {
+        throw std::runtime_error{"lift::batcher The merge function cannot be nullptr."};
+    }
+    if (opts.split == nullptr)
+    {
+        throw std::runtime_error{"lift::batcher The split function cannot be nullptr."};
+    }
+
+    m_split = std::make_shared<const split_type>(std::move(opts.split));
+
+    // The timer belongs to the client's event loop, it must be initialized on its thread.
+    m_client.post(
+        [this]()
+        {
+            uv_timer_init(&m_client.m_uv_loop, &m_timer);
+            m_timer.data = this;
+        });
+}
+
+batcher::~batcher()
+{
+    std::promise<void> closed{};
+    auto               future = closed.get_future();
+
+    m_client.post(
+        [this, &closed]()
+        {
+            flush(false);
+            uv_timer_stop(&m_timer);
+            m_timer.data = &closed;
+            uv_close(
+                reinterpret_cast<uv_handle_t*>(&m_timer),
+                [](uv_handle_t* handle) { static_cast<std::promise<void>*>(handle->data)->set_value(); });
+        });
+
+    future.wait();
+}
+
+auto batcher::submit(std::string item, item_callback_type callback) -> void
+{
+    if (callback == nullptr)
+    {
+        throw std::runtime_error{"lift::batcher::submit The callback cannot be nullptr."};
+    }
+
+    bool first{false};
+    bool full{false};
+    {
+        std::lock_guard<std::mutex> guard{m_items_lock};
+        first = m_items.empty();
+        m_items.push_back(pending_item{std::move(item), std::move(callback)});
+        full = m_items.size() >= m_max_batch_size;
+    }
+    m_items_submitted.fetch_add(1, std::memory_order_relaxed);
+
+    if (full)
+    {
+        m_client.post([this]() { flush(true); });
+    }
+    else if (first)
+    {
+        // A stale start after the batch was already sent only fires on an empty batch.
+        m_client.post([this]() { uv_timer_start(&m_timer, on_uv_batcher_timer_callback, m_window_ms, 0); });
+    }
+}
+
+auto batcher::flush(bool full_only) -> void
+{
+    std::vector<pending_item> items{};
+    {
+        std::lock_guard<std::mutex> guard{m_items_lock};
+        if (full_only)
+        {
+            // A partial batch behind the full ones keeps waiting for more items or its window.
+            auto full = m_items.size() - (m_items.size() % m_max_batch_size);
+            items.assign(std::make_move_iterator(m_items.begin()), std::make_move_iterator(m_items.begin() + full));
+            m_items.erase(m_items.begin(), m_items.begin() + full);
+            if (!m_items.empty() && uv_is_active(reinterpret_cast<uv_handle_t*>(&m_timer)) == 0)
+            {
+                uv_timer_start(&m_timer, on_uv_batcher_timer_callback, m_window_ms, 0);
+            }
+        }
+        else
+        {
+            items.swap(m_items);
+        }
+    }
+    if (!full_only)
+    {
+        uv_timer_stop(&m_timer);
+    }
+
+    for (std::size_t begin = 0; begin < items.size(); begin += m_max_batch_size)
+    {
+        auto end = std::min(items.size(), begin + m_max_batch_size);
+
+        std::vector<std::string>        payloads{};
+        std::vector<item_callback_type> callbacks{};
+        payloads.reserve(end - begin);
+        callbacks.reserve(end - begin);
+        for (auto i = begin; i < end; ++i)
+        {
+            payloads.emplace_back(std::move(items[i].item));
+            callbacks.emplace_back(std::move(items[i].callback));
+        }
+
+        auto request = m_merge(payloads);
+        if (request == nullptr)
+        {
+            for (auto& callback : callbacks)
+            {
+                callback(lift_status::error_failed_to_start, std::string{});
+            }
+            continue;
+        }
+
+        m_batches_sent.fetch_add(1, std::memory_order_relaxed);
+        m_client.start_request(
+            std::move(request),
+            [split = m_split, payloads = std::move(payloads), callbacks = std::move(callbacks)](
+                request_ptr, response response)
+            {
+                if (response.lift_status() != lift_status::success)
+                {
+                    for (auto& callback : callbacks)
+                    {
+                        callback(response.lift_status(), std::string{});
+                    }
+                    return;
+                }
+
+                auto results = (*split)(response, payloads);
+                for (std::size_t i = 0; i < callbacks.size(); ++i)
+                {
+                    if (i < results.size() && results[i].has_value())
+                    {
+                        callbacks[i](lift_status::success, std::move(results[i].value()));
+                    }
+                    else
+                    {
+                        callbacks[i](lift_status::error, std::string{});
+                    }
+                }
+            });
+    }
+}
+
+} // namespace lift
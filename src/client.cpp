@@ -1,10 +1,15 @@
 #include "lift/client.hpp"
+#include "lift/impl/file_reader.hpp"
+#include "lift/impl/io_uring_poller.hpp"
 #include "lift/init.hpp"
 
 #include <curl/curl.h>
 #include <curl/multi.h>
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <sys/syscall.h>
 #include <thread>
 #include <unistd.h>
@@ -58,7 +63,9 @@ public:
          * uv has signaled that it is finished with the m_poll_handle,
          * we can now safely tell the event loop to re-use this curl context.
          */
-        cc->lift_client().m_curl_context_ready.emplace_back(cc);
+        auto& c = cc->lift_client();
+        c.m_curl_context_ready.emplace_back(cc);
+        c.m_metrics.curl_contexts_pooled.store(c.m_curl_context_ready.size(), std::memory_order_relaxed);
     }
 
 private:
@@ -79,33 +86,183 @@ auto on_uv_curl_perform_callback(uv_poll_t* req, int status, int events) -> void
 
 auto on_uv_requests_accept_async(uv_async_t* handle) -> void;
 
+auto on_uv_loop_prepare_callback(uv_prepare_t* handle) -> void;
+
+auto on_uv_loop_check_callback(uv_check_t* handle) -> void;
+
 auto on_uv_timesup_callback(uv_timer_t* handle) -> void;
 
+auto curl_prereq_callback(
+    void* clientp, char* conn_primary_ip, char* conn_local_ip, int conn_primary_port, int conn_local_port) -> int;
+
+auto on_uv_pool_trim_callback(uv_timer_t* handle) -> void;
+
+auto on_uv_inflight_dump_callback(uv_timer_t* handle) -> void;
+
+auto on_uv_predictive_pool_callback(uv_timer_t* handle) -> void;
+
+auto on_uv_scheduled_callback(uv_timer_t* handle) -> void;
+
+auto on_uv_io_uring_ready_callback(uv_poll_t* handle, int status, int events) -> void;
+
+auto on_uv_io_uring_prepare_callback(uv_prepare_t* handle) -> void;
+
+auto on_uv_file_reader_ready_async(uv_async_t* handle) -> void;
+
+static auto on_file_reader_ready(void* user_data) -> void;
+
+/// Submission queue size for the io_uring socket backend, the ring flushes early if it fills up.
+static constexpr uint32_t io_uring_entries{1024};
+
+/// Predicted demand below this is treated as none, otherwise a host is kept warm forever.
+static constexpr double predictive_pool_idle_average{0.1};
+
+/// How long a predictive pool warm-up request may take.
+static constexpr std::chrono::milliseconds predictive_pool_warmup_timeout{10s};
+
+/**
+ * @param url The request's url.
+ * @return The url's scheme://host:port, empty if the url has no scheme.
+ */
+static auto url_origin(std::string_view url) -> std::string_view
+{
+    auto scheme_end = url.find("://");
+    if (scheme_end == std::string_view::npos)
+    {
+        return std::string_view{};
+    }
+
+    auto authority_end = url.find_first_of("/?#", scheme_end + 3);
+    return url.substr(0, authority_end);
+}
+
 client::client(options opts)
     : m_connect_timeout(std::move(opts.connect_timeout)),
+      m_spin_budget(std::move(opts.spin_budget)),
       m_curl_context_ready(),
+      m_executors_reserved(opts.reserve_connections.value_or(0)),
+      m_pool_trim_interval(std::move(opts.pool_trim_interval)),
+      m_source_addresses(std::move(opts.source_addresses)),
+      m_source_address_counters(m_source_addresses.size()),
+      m_inflight_dump(std::move(opts.inflight_dump)),
+      m_predictive_pool(std::move(opts.predictive_pool)),
+      m_warm_connections(m_predictive_pool.has_value() && opts.share == nullptr),
+      m_max_connections(opts.max_connections),
+      m_max_host_connections(opts.max_host_connections),
+      m_fair_queuing(std::move(opts.fair_queuing)),
+      m_mirror(std::move(opts.mirror)),
       m_resolve_hosts(std::move(opts.resolve_hosts).value_or(std::vector<resolve_host>{})),
+      m_request_defaults(std::move(opts.request_defaults)),
+      m_memory_resource(opts.memory_resource),
+      m_orphan_policy(opts.orphan_policy),
+      m_max_orphans(std::move(opts.max_orphans)),
       m_share_ptr(std::move(opts.share)),
       m_on_thread_callback(std::move(opts.on_thread_callback))
 {
     global_init();
 
-    for (std::size_t i = 0; i < opts.reserve_connections.value_or(0); ++i)
+    // Anything the defaults need per request is built once here rather than by every executor.
+    if (m_request_defaults.has_value())
+    {
+        const auto& defaults = m_request_defaults.value();
+        if (defaults.accept_encodings.has_value())
+        {
+            m_default_accept_encoding = executor::join_accept_encodings(defaults.accept_encodings.value());
+        }
+
+        for (const auto& header : defaults.headers)
+        {
+            m_default_headers = curl_slist_append(m_default_headers, header.data().data());
+        }
+    }
+
+    // Configured tenants are listed in the metrics before their first request.
+    if (m_fair_queuing.has_value())
+    {
+        for (const auto& tenant : m_fair_queuing.value().tenants)
+        {
+            find_tenant(tenant.name);
+        }
+    }
+
+    for (std::size_t i = 0; i < m_executors_reserved; ++i)
     {
         m_executors.push_back(executor::make_unique(this));
     }
+    m_executors_total = m_executors.size();
+    m_metrics.executors_total.store(m_executors_total, std::memory_order_relaxed);
+    m_metrics.executors_pooled.store(m_executors.size(), std::memory_order_relaxed);
 
     uv_loop_init(&m_uv_loop);
 
     uv_async_init(&m_uv_loop, &m_uv_async, on_uv_requests_accept_async);
     m_uv_async.data = this;
 
+    uv_async_init(&m_uv_loop, &m_uv_async_file_reader, on_uv_file_reader_ready_async);
+    m_uv_async_file_reader.data = this;
+    m_file_reader = std::make_unique<impl::file_reader>(on_file_reader_ready, &m_uv_async_file_reader);
+
+    uv_prepare_init(&m_uv_loop, &m_uv_prepare_wakeup);
+    m_uv_prepare_wakeup.data = this;
+    uv_prepare_start(&m_uv_prepare_wakeup, on_uv_loop_prepare_callback);
+
+    uv_check_init(&m_uv_loop, &m_uv_check_wakeup);
+    m_uv_check_wakeup.data = this;
+    uv_check_start(&m_uv_check_wakeup, on_uv_loop_check_callback);
+
     uv_timer_init(&m_uv_loop, &m_uv_timer_curl);
     m_uv_timer_curl.data = this;
 
     uv_timer_init(&m_uv_loop, &m_uv_timer_timeout);
     m_uv_timer_timeout.data = this;
 
+    uv_timer_init(&m_uv_loop, &m_uv_timer_pool_trim);
+    m_uv_timer_pool_trim.data = this;
+    if (m_pool_trim_interval.has_value())
+    {
+        auto interval = static_cast<uint64_t>(m_pool_trim_interval.value().count());
+        uv_timer_start(&m_uv_timer_pool_trim, on_uv_pool_trim_callback, interval, interval);
+    }
+
+    uv_timer_init(&m_uv_loop, &m_uv_timer_inflight_dump);
+    m_uv_timer_inflight_dump.data = this;
+    if (m_inflight_dump.has_value() && m_inflight_dump.value().handler != nullptr)
+    {
+        auto interval = static_cast<uint64_t>(std::max(1ms, m_inflight_dump.value().interval).count());
+        uv_timer_start(&m_uv_timer_inflight_dump, on_uv_inflight_dump_callback, interval, interval);
+    }
+
+    uv_timer_init(&m_uv_loop, &m_uv_timer_scheduled);
+    m_uv_timer_scheduled.data = this;
+
+    uv_timer_init(&m_uv_loop, &m_uv_timer_predictive_pool);
+    m_uv_timer_predictive_pool.data = this;
+    if (m_predictive_pool.has_value())
+    {
+        auto interval = static_cast<uint64_t>(std::max(1ms, m_predictive_pool.value().interval).count());
+        uv_timer_start(&m_uv_timer_predictive_pool, on_uv_predictive_pool_callback, interval, interval);
+    }
+
+#if defined(LIFT_IO_URING)
+    if (opts.socket_backend == socket_backend::io_uring)
+    {
+        // If the kernel refuses io_uring the client quietly keeps using uv_poll.
+        m_io_uring = impl::io_uring_poller::make_unique(io_uring_entries);
+        if (m_io_uring != nullptr)
+        {
+            m_socket_backend = socket_backend::io_uring;
+
+            uv_poll_init(&m_uv_loop, &m_uv_poll_io_uring, m_io_uring->ring_fd());
+            m_uv_poll_io_uring.data = this;
+            uv_poll_start(&m_uv_poll_io_uring, UV_READABLE, on_uv_io_uring_ready_callback);
+
+            uv_prepare_init(&m_uv_loop, &m_uv_prepare_io_uring);
+            m_uv_prepare_io_uring.data = this;
+            uv_prepare_start(&m_uv_prepare_io_uring, on_uv_io_uring_prepare_callback);
+        }
+    }
+#endif
+
     curl_multi_setopt(m_cmh, CURLMOPT_SOCKETFUNCTION, curl_handle_socket_actions);
     curl_multi_setopt(m_cmh, CURLMOPT_SOCKETDATA, this);
     curl_multi_setopt(m_cmh, CURLMOPT_TIMERFUNCTION, curl_start_timeout);
@@ -113,7 +270,12 @@ client::client(options opts)
 
     if (opts.max_connections.has_value())
     {
-        curl_multi_setopt(m_cmh, CURLMOPT_MAXCONNECTS, static_cast<long>(opts.max_connections.value()));
+        set_connection_cache_size(opts.max_connections.value());
+    }
+    if (opts.max_host_connections.has_value())
+    {
+        curl_multi_setopt(
+            m_cmh, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(opts.max_host_connections.value()));
     }
 
     m_background_thread = std::thread{[this] { run(); }};
@@ -133,16 +295,50 @@ client::~client()
 {
     m_is_stopping.exchange(true, std::memory_order_release);
 
+    // Requests scheduled for later would hold the client open until they are due, wake the loop so
+    // it fails them now.  Any scheduled after this check wake it themselves.
+    if (m_metrics.requests_scheduled.load(std::memory_order_acquire) > 0)
+    {
+        {
+            std::lock_guard<std::mutex> guard{m_pending_requests_lock};
+            m_requests_pending.store(true, std::memory_order_seq_cst);
+        }
+        wake_event_loop();
+    }
+
     while (!empty())
     {
         std::this_thread::sleep_for(1ms);
     }
 
+    // Nothing is waiting on file reads anymore, the thread must be gone before its async handle.
+    m_file_reader->stop();
+
     uv_timer_stop(&m_uv_timer_curl);
     uv_timer_stop(&m_uv_timer_timeout);
+    uv_timer_stop(&m_uv_timer_pool_trim);
+    uv_timer_stop(&m_uv_timer_inflight_dump);
+    uv_timer_stop(&m_uv_timer_predictive_pool);
+    uv_timer_stop(&m_uv_timer_scheduled);
     uv_close(uv_type_cast<uv_handle_t>(&m_uv_timer_curl), uv_close_callback);
     uv_close(uv_type_cast<uv_handle_t>(&m_uv_timer_timeout), uv_close_callback);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_timer_pool_trim), uv_close_callback);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_timer_inflight_dump), uv_close_callback);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_timer_predictive_pool), uv_close_callback);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_timer_scheduled), uv_close_callback);
     uv_close(uv_type_cast<uv_handle_t>(&m_uv_async), uv_close_callback);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_async_file_reader), uv_close_callback);
+    uv_prepare_stop(&m_uv_prepare_wakeup);
+    uv_check_stop(&m_uv_check_wakeup);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_prepare_wakeup), uv_close_callback);
+    uv_close(uv_type_cast<uv_handle_t>(&m_uv_check_wakeup), uv_close_callback);
+    if (m_io_uring != nullptr)
+    {
+        uv_prepare_stop(&m_uv_prepare_io_uring);
+        uv_poll_stop(&m_uv_poll_io_uring);
+        uv_close(uv_type_cast<uv_handle_t>(&m_uv_prepare_io_uring), uv_close_callback);
+        uv_close(uv_type_cast<uv_handle_t>(&m_uv_poll_io_uring), uv_close_callback);
+    }
 
     while (uv_loop_alive(&m_uv_loop))
     {
@@ -156,9 +352,212 @@ client::~client()
     m_executors.clear();
 
     curl_multi_cleanup(m_cmh);
+
+    // Only freed once every executor that could reference it is gone.
+    curl_slist_free_all(m_default_headers);
+
     global_cleanup();
 }
 
+auto client::metrics() const -> metrics_snapshot
+{
+    metrics_snapshot snapshot{};
+    snapshot.executors_total        = m_metrics.executors_total.load(std::memory_order_relaxed);
+    snapshot.executors_pooled       = m_metrics.executors_pooled.load(std::memory_order_relaxed);
+    snapshot.curl_contexts_pooled   = m_metrics.curl_contexts_pooled.load(std::memory_order_relaxed);
+    snapshot.request_queue_capacity = m_metrics.request_queue_capacity.load(std::memory_order_relaxed);
+    snapshot.timeouts_pending       = m_metrics.timeouts_pending.load(std::memory_order_relaxed);
+    snapshot.socket_poll_updates    = m_metrics.socket_poll_updates.load(std::memory_order_relaxed);
+    snapshot.socket_poll_syscalls   = m_metrics.socket_poll_syscalls.load(std::memory_order_relaxed);
+    snapshot.loop_sleeps            = m_metrics.loop_sleeps.load(std::memory_order_relaxed);
+    snapshot.requests_accepted      = m_metrics.requests_accepted.load(std::memory_order_relaxed);
+    snapshot.loop_wakeups           = m_metrics.loop_wakeups.load(std::memory_order_relaxed);
+    snapshot.orphans_active         = m_metrics.orphans_active.load(std::memory_order_relaxed);
+    snapshot.orphans_aborted        = m_metrics.orphans_aborted.load(std::memory_order_relaxed);
+    snapshot.orphans_connected      = m_metrics.orphans_connected.load(std::memory_order_relaxed);
+    snapshot.orphans_completed      = m_metrics.orphans_completed.load(std::memory_order_relaxed);
+    snapshot.warm_requests          = m_metrics.warm_requests.load(std::memory_order_relaxed);
+    snapshot.cold_requests          = m_metrics.cold_requests.load(std::memory_order_relaxed);
+    snapshot.warmup_requests        = m_metrics.warmup_requests.load(std::memory_order_relaxed);
+    snapshot.shadow_requests        = m_metrics.shadow_requests.load(std::memory_order_relaxed);
+    snapshot.shadow_completed       = m_metrics.shadow_completed.load(std::memory_order_relaxed);
+    snapshot.shadow_dropped         = m_metrics.shadow_dropped.load(std::memory_order_relaxed);
+    snapshot.shadow_aborted         = m_metrics.shadow_aborted.load(std::memory_order_relaxed);
+    snapshot.tasks_scheduled        = m_metrics.tasks_scheduled.load(std::memory_order_relaxed);
+    snapshot.requests_scheduled     = m_metrics.requests_scheduled.load(std::memory_order_relaxed);
+
+    snapshot.source_addresses.reserve(m_source_address_counters.size());
+    for (const auto& counters : m_source_address_counters)
+    {
+        snapshot.source_addresses.push_back(source_address_metrics{
+            counters.requests.load(std::memory_order_relaxed), counters.connections.load(std::memory_order_relaxed)});
+    }
+
+    if (m_fair_queuing.has_value())
+    {
+        std::lock_guard<std::mutex> guard{m_tenants_lock};
+        snapshot.tenants.reserve(m_tenants.size());
+        for (const auto& [name, tenant] : m_tenants)
+        {
+            auto& counts         = snapshot.tenants.emplace_back();
+            counts.name          = name;
+            counts.queued        = tenant.queued_count.load(std::memory_order_relaxed);
+            counts.in_flight     = tenant.in_flight_count.load(std::memory_order_relaxed);
+            counts.admitted      = tenant.admitted.load(std::memory_order_relaxed);
+            counts.completed     = tenant.completed.load(std::memory_order_relaxed);
+            counts.wait_time     = std::chrono::milliseconds{tenant.wait_time_ms.load(std::memory_order_relaxed)};
+            counts.max_wait_time = std::chrono::milliseconds{tenant.max_wait_time_ms.load(std::memory_order_relaxed)};
+        }
+    }
+    return snapshot;
+}
+
+auto client::update_resolve_hosts(std::vector<lift::resolve_host> resolve_hosts) -> void
+{
+    post(
+        [this, resolve_hosts = std::move(resolve_hosts)]() mutable
+        {
+            auto same_host = [](const resolve_host& a, const resolve_host& b)
+            { return a.port() == b.port() && a.host() == b.host(); };
+            auto purge_entry = [](const resolve_host& r) { return "-" + r.host() + ":" + std::to_string(r.port()); };
+
+            for (const auto& old : m_resolve_hosts)
+            {
+                auto kept = std::any_of(
+                    resolve_hosts.begin(),
+                    resolve_hosts.end(),
+                    [&](const resolve_host& r) { return same_host(r, old); });
+                auto entry = purge_entry(old);
+                if (!kept &&
+                    std::find(m_resolve_hosts_removed.begin(), m_resolve_hosts_removed.end(), entry) ==
+                        m_resolve_hosts_removed.end())
+                {
+                    m_resolve_hosts_removed.emplace_back(std::move(entry));
+                }
+            }
+
+            // A host added back is resolved by its new entry again.
+            for (const auto& r : resolve_hosts)
+            {
+                m_resolve_hosts_removed.erase(
+                    std::remove(m_resolve_hosts_removed.begin(), m_resolve_hosts_removed.end(), purge_entry(r)),
+                    m_resolve_hosts_removed.end());
+            }
+
+            m_resolve_hosts = std::move(resolve_hosts);
+        });
+}
+
+auto client::reconfigure(limits new_limits) -> void
+{
+    post(
+        [this, new_limits = std::move(new_limits)]()
+        {
+            if (new_limits.max_connections.has_value())
+            {
+                m_max_connections = new_limits.max_connections;
+                set_connection_cache_size(new_limits.max_connections.value());
+            }
+            if (new_limits.max_host_connections.has_value())
+            {
+                m_max_host_connections = new_limits.max_host_connections;
+                curl_multi_setopt(
+                    m_cmh, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(new_limits.max_host_connections.value()));
+            }
+            if (new_limits.connect_timeout.has_value())
+            {
+                m_connect_timeout = new_limits.connect_timeout;
+            }
+            if (new_limits.max_orphans.has_value())
+            {
+                m_max_orphans = new_limits.max_orphans;
+            }
+
+            if (!m_fair_queuing.has_value())
+            {
+                return;
+            }
+
+            auto& config = m_fair_queuing.value();
+            if (new_limits.max_in_flight.has_value())
+            {
+                config.max_in_flight = new_limits.max_in_flight.value();
+            }
+            for (const auto& tenant : new_limits.tenants)
+            {
+                auto configured = std::find_if(
+                    config.tenants.begin(),
+                    config.tenants.end(),
+                    [&](const lift::tenant& t) { return t.name == tenant.name; });
+                if (configured != config.tenants.end())
+                {
+                    *configured = tenant;
+                }
+                else
+                {
+                    config.tenants.push_back(tenant);
+                }
+
+                // A tenant already seen keeps its queue and in-flight count, only its share changes.
+                auto& queue         = find_tenant(tenant.name);
+                queue.weight        = std::max<uint64_t>(tenant.weight, 1);
+                queue.max_in_flight = tenant.max_in_flight;
+            }
+        });
+}
+
+auto client::post(std::function<void()> task) -> void
+{
+    if (task == nullptr)
+    {
+        throw std::runtime_error{"lift::client::post The task cannot be nullptr."};
+    }
+
+    {
+        std::lock_guard<std::mutex> guard{m_pending_requests_lock};
+        m_loop_tasks.emplace_back(std::move(task));
+        m_requests_pending.store(true, std::memory_order_seq_cst);
+    }
+    wake_event_loop();
+}
+
+auto client::schedule(std::chrono::milliseconds delay, std::function<void()> task) -> void
+{
+    if (task == nullptr)
+    {
+        throw std::runtime_error{"lift::client::schedule The task cannot be nullptr."};
+    }
+
+    // The delay counts from now rather than from when the event loop picks the task up.
+    auto due = uv_hrtime() / 1'000'000 + static_cast<time_point>(std::max(delay, 0ms).count());
+    post(
+        [this, due, task = std::move(task)]() mutable
+        {
+            m_scheduled_tasks.emplace(due, std::move(task));
+            m_metrics.tasks_scheduled.store(m_scheduled_tasks.size(), std::memory_order_relaxed);
+            update_scheduled();
+        });
+}
+
+auto client::inflight_snapshot() -> std::vector<lift::inflight_request>
+{
+    if (std::this_thread::get_id() == m_background_thread.get_id())
+    {
+        return collect_inflight(0ms);
+    }
+
+    std::promise<std::vector<lift::inflight_request>> promise{};
+    auto                                              future = promise.get_future();
+    {
+        std::lock_guard<std::mutex> guard{m_pending_requests_lock};
+        m_inflight_waiters.emplace_back(std::move(promise));
+        m_requests_pending.store(true, std::memory_order_seq_cst);
+    }
+    wake_event_loop();
+
+    return future.get();
+}
+
 auto client::start_request(request_ptr&& request_ptr) -> request::async_future_type
 {
     if (request_ptr == nullptr)
@@ -186,6 +585,59 @@ auto client::start_request(request_ptr&& request_ptr, request::async_callback_ty
     start_request_common(std::move(request_ptr));
 }
 
+auto client::start_request_at(request_ptr&& request_ptr, std::chrono::steady_clock::time_point when)
+    -> request::async_future_type
+{
+    if (request_ptr == nullptr)
+    {
+        throw std::runtime_error{"lift::client::start_request_at (future) The request_ptr cannot be nullptr."};
+    }
+
+    auto future = request_ptr->async_future();
+    start_request_at_common(std::move(request_ptr), when);
+    return future;
+}
+
+auto client::start_request_at(
+    request_ptr&& request_ptr, std::chrono::steady_clock::time_point when, request::async_callback_type callback)
+    -> void
+{
+    if (request_ptr == nullptr)
+    {
+        throw std::runtime_error{"lift::client::start_request_at (callback) The request_ptr cannot be nullptr."};
+    }
+    if (callback == nullptr)
+    {
+        throw std::runtime_error{"lift::client::start_request_at (callback) The callback cannot be nullptr."};
+    }
+
+    request_ptr->async_callback(std::move(callback));
+    start_request_at_common(std::move(request_ptr), when);
+}
+
+auto client::start_request_at_common(request_ptr&& request_ptr, std::chrono::steady_clock::time_point when) -> void
+{
+    if (m_is_stopping.load(std::memory_order_acquire))
+    {
+        start_request_notify_failed_start(std::move(request_ptr));
+        return;
+    }
+
+    // The event loop's clock is uv_hrtime() in milliseconds, rounded up so the request is never early.
+    auto delay = std::chrono::ceil<std::chrono::milliseconds>(when - std::chrono::steady_clock::now());
+    auto due   = uv_hrtime() / 1'000'000 + static_cast<time_point>(std::max(delay, 0ms).count());
+
+    m_active_request_count.fetch_add(1, std::memory_order_release);
+    m_metrics.requests_scheduled.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> guard{m_pending_requests_lock};
+        m_pending_scheduled.emplace_back(due, std::move(request_ptr));
+        m_requests_pending.store(true, std::memory_order_seq_cst);
+    }
+    wake_event_loop();
+}
+
 auto client::start_request_common(request_ptr&& request_ptr) -> void
 {
     if (m_is_stopping.load(std::memory_order_acquire))
@@ -200,8 +652,9 @@ auto client::start_request_common(request_ptr&& request_ptr) -> void
     {
         std::lock_guard<std::mutex> guard{m_pending_requests_lock};
         m_pending_requests.emplace_back(std::move(request_ptr));
+        m_requests_pending.store(true, std::memory_order_seq_cst);
     }
-    uv_async_send(&m_uv_async);
+    wake_event_loop();
 }
 
 auto client::run() -> void
@@ -212,7 +665,14 @@ auto client::run() -> void
     }
 
     m_is_running.exchange(true, std::memory_order_release);
-    uv_run(&m_uv_loop, UV_RUN_DEFAULT);
+    if (m_spin_budget.has_value())
+    {
+        run_spin();
+    }
+    else
+    {
+        uv_run(&m_uv_loop, UV_RUN_DEFAULT);
+    }
     m_is_running.exchange(false, std::memory_order_release);
 
     if (m_on_thread_callback != nullptr)
@@ -221,6 +681,45 @@ auto client::run() -> void
     }
 }
 
+auto client::run_spin() -> void
+{
+    const auto budget        = m_spin_budget.value();
+    auto       last_activity = std::chrono::steady_clock::now();
+    auto       last_count    = m_loop_activity;
+
+    // While spinning the loop checks for new requests every iteration, submitters never need to wake it.
+    m_spinning = true;
+    m_loop_awake.store(true, std::memory_order_seq_cst);
+
+    while (uv_loop_alive(&m_uv_loop) != 0)
+    {
+        // Pick up new requests directly instead of waiting for the async handle to be polled.
+        if (m_requests_pending.load(std::memory_order_acquire))
+        {
+            on_uv_requests_accept_async(&m_uv_async);
+        }
+
+        uv_run(&m_uv_loop, UV_RUN_NOWAIT);
+
+        auto now = std::chrono::steady_clock::now();
+        if (m_loop_activity != last_count)
+        {
+            last_count    = m_loop_activity;
+            last_activity = now;
+        }
+        else if (now - last_activity >= budget)
+        {
+            // Nothing happened for the whole budget, block until the next event.
+            m_metrics.loop_sleeps.fetch_add(1, std::memory_order_relaxed);
+            m_spinning = false;
+            uv_run(&m_uv_loop, UV_RUN_ONCE);
+            m_spinning    = true;
+            last_count    = m_loop_activity;
+            last_activity = std::chrono::steady_clock::now();
+        }
+    }
+}
+
 auto client::check_actions() -> void
 {
     check_actions(CURL_SOCKET_TIMEOUT, 0);
@@ -228,6 +727,8 @@ auto client::check_actions() -> void
 
 auto client::check_actions(curl_socket_t socket, int event_bitmask) -> void
 {
+    ++m_loop_activity;
+
     int       running_handles = 0;
     CURLMcode curl_code       = CURLM_OK;
     do
@@ -257,11 +758,67 @@ auto client::check_actions(curl_socket_t socket, int event_bitmask) -> void
             complete_request_normal(std::move(executor_ptr), executor::convert(easy_result));
         }
     }
+
+    // Completed requests made room for queued ones.
+    if (m_fair_queuing.has_value())
+    {
+        admit_requests();
+    }
 }
 
 auto client::complete_request_normal(executor_ptr exe_ptr, lift_status status) -> void
 {
     auto& exe = *exe_ptr.get();
+    inflight_unlink(exe);
+
+    // Counted before the user is notified so the metrics already include this request.
+    long connects{0};
+    curl_easy_getinfo(exe.m_curl_handle, CURLINFO_NUM_CONNECTS, &connects);
+    if (exe.m_source_address.has_value())
+    {
+        auto& counters = m_source_address_counters[exe.m_source_address.value()];
+        counters.requests.fetch_add(1, std::memory_order_relaxed);
+        counters.connections.fetch_add(static_cast<uint64_t>(connects), std::memory_order_relaxed);
+    }
+
+    if (exe.m_role == executor::role::warmup)
+    {
+        --exe.m_host->warming;
+    }
+    else if (exe.m_role == executor::role::shadow)
+    {
+        --m_shadows_in_flight;
+        if (status == lift_status::success)
+        {
+            m_metrics.shadow_completed.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    else
+    {
+        if (exe.m_host != nullptr)
+        {
+            --exe.m_host->in_flight;
+        }
+
+        if (connects > 0)
+        {
+            m_metrics.cold_requests.fetch_add(1, std::memory_order_relaxed);
+        }
+        else if (status == lift_status::success)
+        {
+            m_metrics.warm_requests.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // The slot is only freed here, an orphaned transfer still holds its connection.
+    if (exe.m_tenant != nullptr)
+    {
+        auto& tenant = *exe.m_tenant;
+        --tenant.in_flight;
+        --m_tenants_in_flight;
+        tenant.in_flight_count.store(tenant.in_flight, std::memory_order_relaxed);
+        tenant.completed.fetch_add(1, std::memory_order_relaxed);
+    }
 
     if (exe.m_on_complete_handler_processed == false)
     {
@@ -289,8 +846,17 @@ auto client::complete_request_normal(executor_ptr exe_ptr, lift_status status) -
             auto& promise = std::get<request::async_promise_type>(on_complete_handler);
             promise.set_value(std::make_pair(std::move(exe.m_request_async), std::move(exe.m_response)));
         }
-        // else do nothing for std::monostate, the user doesn't want to be notified or this request
-        // has timedout but was allowed to finish establishing a connection.
+        // else do nothing for std::monostate, the user doesn't want to be notified.
+    }
+    else if (exe.m_orphaned)
+    {
+        // This request has timedout but was allowed to keep running.
+        --m_orphans_active;
+        m_metrics.orphans_active.store(m_orphans_active, std::memory_order_relaxed);
+        if (status == lift_status::success)
+        {
+            m_metrics.orphans_completed.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     return_executor(std::move(exe_ptr));
@@ -337,6 +903,8 @@ auto client::complete_request_timeout(executor& exe) -> void
 
             auto& callback = std::get<request::async_callback_type>(on_complete_handler);
             callback(std::move(copy), std::move(exe.m_response));
+            // libcurl keeps writing into the response until it times out as well.
+            exe.m_response.memory_resource(nullptr);
         }
         else if (std::holds_alternative<request::async_promise_type>(on_complete_handler))
         {
@@ -344,6 +912,7 @@ auto client::complete_request_timeout(executor& exe) -> void
 
             auto& promise = std::get<request::async_promise_type>(on_complete_handler);
             promise.set_value(std::make_pair(std::move(copy), std::move(exe.m_response)));
+            exe.m_response.memory_resource(nullptr);
         }
         // else do nothing for std::monostate, the user doesn't want to be notified.
     }
@@ -352,7 +921,7 @@ auto client::complete_request_timeout(executor& exe) -> void
 auto client::complete_request_timeout_common(executor& exe) -> request_ptr
 {
     exe.m_response.m_lift_status = lift::lift_status::timeout;
-    exe.set_timesup_response(exe.m_request->timeout().value());
+    exe.set_timesup_response(request_timeout(*exe.m_request).value());
 
     // IMPORTANT! Copying here is required _OR_ shared ownership must be added as libcurl
     // maintains char* type pointers into the request data structure.  There is no guarantee
@@ -365,15 +934,29 @@ auto client::complete_request_timeout_common(executor& exe) -> request_ptr
     // object into the copied object.  After making this copy the original object must not invoke
     // any async handlers (future or callback).
     auto copy_ptr = std::make_unique<request>(*exe.m_request_async);
+
+    // The user owns the request's memory resource and may release it as soon as the copy is handed
+    // back, the original that stays with libcurl must not allocate from it anymore.
+    exe.m_request_async->detach_memory_resource();
+
     return copy_ptr;
 }
 
+auto client::request_timeout(const request& req) const -> std::optional<std::chrono::milliseconds>
+{
+    if (req.timeout().has_value() || !m_request_defaults.has_value())
+    {
+        return req.timeout();
+    }
+    return m_request_defaults.value().timeout;
+}
+
 auto client::add_timeout(executor& exe) -> void
 {
     auto* request = exe.m_request;
-    if (request->timeout().has_value())
+    if (auto request_timeout_ms = request_timeout(*request); request_timeout_ms.has_value())
     {
-        auto timeout = exe.m_request->timeout().value();
+        auto timeout = request_timeout_ms.value();
 
         std::optional<std::chrono::milliseconds> connect_timeout{std::nullopt};
         if (request->connect_timeout().has_value())
@@ -393,21 +976,34 @@ auto client::add_timeout(executor& exe) -> void
                 auto       now         = uv_now(&m_uv_loop);
                 time_point tp          = now + static_cast<time_point>(timeout.count());
                 exe.m_timeout_iterator = m_timeouts.emplace(tp, &exe);
+                exe.m_deadline         = tp;
+                m_metrics.timeouts_pending.store(m_timeouts.size(), std::memory_order_relaxed);
 
                 update_timeouts();
 
                 curl_easy_setopt(
                     exe.m_curl_handle, CURLOPT_TIMEOUT_MS, static_cast<long>(connect_timeout.value().count()));
+
+#if LIBCURL_VERSION_NUM >= 0x075000
+                // This transfer can outlive its timesup, track when its connection is ready.
+                if (m_orphan_policy == orphan_policy::keep_until_connected)
+                {
+                    curl_easy_setopt(exe.m_curl_handle, CURLOPT_PREREQFUNCTION, curl_prereq_callback);
+                    curl_easy_setopt(exe.m_curl_handle, CURLOPT_PREREQDATA, &exe);
+                }
+#endif
             }
             else
             {
                 // If the user set a longer timeout on the individual request, just let curl handle it.
                 curl_easy_setopt(exe.m_curl_handle, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
+                exe.m_deadline = uv_now(&m_uv_loop) + static_cast<time_point>(timeout.count());
             }
         }
         else
         {
             curl_easy_setopt(exe.m_curl_handle, CURLOPT_TIMEOUT_MS, static_cast<long>(timeout.count()));
+            exe.m_deadline = uv_now(&m_uv_loop) + static_cast<time_point>(timeout.count());
         }
     }
 }
@@ -419,6 +1015,7 @@ auto client::remove_timeout(executor& exe) -> std::multimap<uint64_t, executor*>
         auto iter = exe.m_timeout_iterator.value();
         auto next = m_timeouts.erase(iter);
         exe.m_timeout_iterator.reset();
+        m_metrics.timeouts_pending.store(m_timeouts.size(), std::memory_order_relaxed);
 
         // Anytime an item is removed the timesup timer might need to be adjusted.
         update_timeouts();
@@ -436,49 +1033,564 @@ auto client::remove_timeout(executor& exe) -> std::multimap<uint64_t, executor*>
     }
 }
 
-auto client::update_timeouts() -> void
+auto client::orphan(executor& exe) -> void
 {
-    // TODO only change if it needs to change, this will probably require
-    // an iterator to the item just added or removed to properly skip
-    // setting the timer every single time.
-
-    if (!m_timeouts.empty())
+    if (m_orphan_policy == orphan_policy::keep_until_connected && exe.m_connected)
     {
-        auto now   = uv_now(&m_uv_loop);
-        auto first = m_timeouts.begin()->first;
-
-        // If the first item is already 'expired' setting the timer to zero
-        // will trigger uv to call its callback on the next loop iteration.
-        // Otherwise set the difference to how many milliseconds are between
-        // first and now.
-        uint64_t timer_value{0};
-        if (first > now)
-        {
-            timer_value = first - now;
-        }
-
-        uv_timer_stop(&m_uv_timer_timeout);
-        uv_timer_start(&m_uv_timer_timeout, on_uv_timesup_callback, timer_value, 0);
+        // The connection is already established, there is nothing left to wait for.
+        m_metrics.orphans_connected.fetch_add(1, std::memory_order_relaxed);
+    }
+    else if (
+        m_orphan_policy == orphan_policy::abort ||
+        (m_max_orphans.has_value() && m_orphans_active >= m_max_orphans.value()))
+    {
+        m_metrics.orphans_aborted.fetch_add(1, std::memory_order_relaxed);
     }
     else
     {
-        uv_timer_stop(&m_uv_timer_timeout);
+        exe.m_orphaned = true;
+        ++m_orphans_active;
+        m_metrics.orphans_active.store(m_orphans_active, std::memory_order_relaxed);
+        return;
     }
+
+    curl_multi_remove_handle(m_cmh, exe.m_curl_handle);
+    // The user already has the timesup response, this only returns the executor to the pool.
+    complete_request_normal(executor_ptr{&exe}, lift_status::timeout);
 }
 
-auto client::acquire_executor() -> std::unique_ptr<executor>
+auto client::update_scheduled() -> void
 {
-    std::unique_ptr<executor> executor_ptr{nullptr};
-
+    if (m_scheduled_tasks.empty() && m_scheduled_requests.empty())
+    {
+        uv_timer_stop(&m_uv_timer_scheduled);
+        return;
+    }
+
+    auto first = std::numeric_limits<time_point>::max();
+    if (!m_scheduled_tasks.empty())
+    {
+        first = m_scheduled_tasks.begin()->first;
+    }
+    if (!m_scheduled_requests.empty())
+    {
+        first = std::min(first, m_scheduled_requests.begin()->first);
+    }
+
+    auto now = uv_now(&m_uv_loop);
+    uv_timer_start(&m_uv_timer_scheduled, on_uv_scheduled_callback, first > now ? first - now : 0, 0);
+}
+
+auto client::fail_scheduled_requests() -> void
+{
+    auto failed = m_scheduled_requests.size();
+    for (auto& [due, request_ptr] : m_scheduled_requests)
+    {
+        start_request_notify_failed_start(std::move(request_ptr));
+    }
+    m_scheduled_requests.clear();
+
+    m_metrics.requests_scheduled.fetch_sub(failed, std::memory_order_relaxed);
+    m_active_request_count.fetch_sub(failed, std::memory_order_release);
+    update_scheduled();
+}
+
+auto client::update_timeouts() -> void
+{
+    // TODO only change if it needs to change, this will probably require
+    // an iterator to the item just added or removed to properly skip
+    // setting the timer every single time.
+
+    if (!m_timeouts.empty())
+    {
+        auto now   = uv_now(&m_uv_loop);
+        auto first = m_timeouts.begin()->first;
+
+        // If the first item is already 'expired' setting the timer to zero
+        // will trigger uv to call its callback on the next loop iteration.
+        // Otherwise set the difference to how many milliseconds are between
+        // first and now.
+        uint64_t timer_value{0};
+        if (first > now)
+        {
+            timer_value = first - now;
+        }
+
+        uv_timer_stop(&m_uv_timer_timeout);
+        uv_timer_start(&m_uv_timer_timeout, on_uv_timesup_callback, timer_value, 0);
+    }
+    else
+    {
+        uv_timer_stop(&m_uv_timer_timeout);
+    }
+}
+
+auto client::start_request_on_loop(request_ptr&& request_ptr, executor::role role, impl::tenant_queue* tenant)
+    -> void
+{
+    auto executor_ptr = acquire_executor();
+    executor_ptr->start_async(std::move(request_ptr), m_share_ptr.get());
+    executor_ptr->m_started_at = uv_now(&m_uv_loop);
+    executor_ptr->m_role       = role;
+    executor_ptr->m_tenant     = tenant;
+    if (m_predictive_pool.has_value() && role != executor::role::shadow)
+    {
+        track_host(*executor_ptr);
+    }
+    executor_ptr->prepare();
+
+    // This must be done before adding to the CURLM* object,
+    // if not its possible a very fast request could complete
+    // before this gets into the multi-map!
+    add_timeout(*executor_ptr);
+
+    auto curl_code = curl_multi_add_handle(m_cmh, executor_ptr->m_curl_handle);
+
+    if (curl_code != CURLM_OK && curl_code != CURLM_CALL_MULTI_PERFORM)
+    {
+        /**
+         * If curl_multi_add_handle fails then notify the user that the request failed to start
+         * immediately.  This will return the just acquired executor back into the pool.
+         */
+        complete_request_normal(std::move(executor_ptr), executor::convert(CURLcode::CURLE_SEND_ERROR));
+    }
+    else
+    {
+        /**
+         * Drop the unique_ptr safety around the request_ptr while it is being
+         * processed by curl.  When curl is finished completing the request
+         * it will be put back into a request object for the client to use.
+         */
+        inflight_link(*executor_ptr);
+        (void)executor_ptr.release();
+
+        /**
+         * Immediately call curl's check action to get the current request moving.
+         * Curl appears to have an internal queue and if it gets too long it might
+         * drop requests.
+         */
+        check_actions();
+    }
+}
+
+auto client::mirror_request(const request& original) -> void
+{
+    const auto& mirror = m_mirror.value();
+    m_mirror_credit += std::clamp(mirror.rate, 0.0, 1.0);
+    if (m_mirror_credit < 1.0)
+    {
+        return;
+    }
+    m_mirror_credit -= 1.0;
+
+    if (m_shadows_in_flight + m_shadows_pending.size() >= mirror.max_in_flight ||
+        m_is_stopping.load(std::memory_order_acquire))
+    {
+        m_metrics.shadow_dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // The copy shares the original's url, headers and body, only what changes below is copied.
+    auto shadow = original.clone();
+    if (!mirror.target.empty())
+    {
+        auto origin = url_origin(shadow->url());
+        shadow->url(mirror.target + shadow->url().substr(origin.size()));
+    }
+    shadow->timeout(mirror.timeout);
+    shadow->connect_timeout(mirror.timeout);
+    shadow->transfer_progress_handler(std::nullopt);
+    shadow->debug_info_handler(nullptr);
+    if (mirror.rewrite != nullptr)
+    {
+        mirror.rewrite(*shadow);
+    }
+
+    m_shadows_pending.emplace_back(std::move(shadow));
+}
+
+auto client::start_shadows(std::size_t own_requests) -> void
+{
+    const auto& mirror = m_mirror.value();
+
+    // Shadows only ever run on the capacity the client's own requests leave unused.
+    if (mirror.shed_above.has_value() && own_requests > mirror.shed_above.value())
+    {
+        m_metrics.shadow_dropped.fetch_add(m_shadows_pending.size(), std::memory_order_relaxed);
+        m_shadows_pending.clear();
+
+        auto* exe = m_inflight_head;
+        while (exe != nullptr)
+        {
+            // Completing the shadow unlinks it.
+            auto* next = exe->m_inflight_next;
+            if (exe->m_role == executor::role::shadow)
+            {
+                m_metrics.shadow_aborted.fetch_add(1, std::memory_order_relaxed);
+                curl_multi_remove_handle(m_cmh, exe->m_curl_handle);
+                complete_request_normal(executor_ptr{exe}, lift_status::error);
+            }
+            exe = next;
+        }
+        return;
+    }
+
+    for (auto& shadow : m_shadows_pending)
+    {
+        ++m_shadows_in_flight;
+        m_active_request_count.fetch_add(1, std::memory_order_release);
+        m_metrics.shadow_requests.fetch_add(1, std::memory_order_relaxed);
+        start_request_on_loop(std::move(shadow), executor::role::shadow);
+    }
+    m_shadows_pending.clear();
+}
+
+auto client::set_connection_cache_size(uint64_t connections) -> void
+{
+    if (m_mirror.has_value())
+    {
+        connections += m_mirror.value().max_in_flight;
+    }
+    curl_multi_setopt(m_cmh, CURLMOPT_MAXCONNECTS, static_cast<long>(connections));
+}
+
+auto client::find_tenant(std::string_view name) -> impl::tenant_queue&
+{
+    auto found = m_tenants.find(name);
+    if (found != m_tenants.end())
+    {
+        return found->second;
+    }
+
+    const auto& config = m_fair_queuing.value();
+    auto        weight = config.default_weight;
+    auto        cap    = config.default_max_in_flight;
+    for (const auto& tenant : config.tenants)
+    {
+        if (tenant.name == name)
+        {
+            weight = tenant.weight;
+            cap    = tenant.max_in_flight;
+            break;
+        }
+    }
+
+    std::lock_guard<std::mutex> guard{m_tenants_lock};
+    auto&                       tenant = m_tenants.try_emplace(std::string{name}).first->second;
+    tenant.weight                      = std::max<uint64_t>(weight, 1);
+    tenant.max_in_flight               = cap;
+    return tenant;
+}
+
+auto client::enqueue_tenant(request_ptr&& request_ptr) -> void
+{
+    auto& tenant = find_tenant(request_ptr->tenant());
+    tenant.queue.push_back(impl::tenant_queue::queued_request{std::move(request_ptr), uv_now(&m_uv_loop)});
+    tenant.queued_count.store(tenant.queue.size(), std::memory_order_relaxed);
+
+    if (!tenant.active)
+    {
+        tenant.active = true;
+        m_tenants_active.push_back(&tenant);
+    }
+}
+
+auto client::admit_requests() -> void
+{
+    if (m_admitting)
+    {
+        return;
+    }
+    m_admitting = true;
+
+    auto max_in_flight = std::max<uint64_t>(m_fair_queuing.value().max_in_flight, 1);
+    auto at_cap        = [](const impl::tenant_queue& tenant)
+    { return tenant.max_in_flight.has_value() && tenant.in_flight >= tenant.max_in_flight.value(); };
+
+    // Stops once every tenant still waiting is at its own cap.
+    std::size_t capped{0};
+    while (!m_tenants_active.empty() && m_tenants_in_flight < max_in_flight && capped < m_tenants_active.size())
+    {
+        auto& tenant = *m_tenants_active.front();
+        if (at_cap(tenant))
+        {
+            // A capped tenant passes its turn, it does not save up credit while it waits.
+            tenant.deficit  = 0;
+            tenant.credited = false;
+            m_tenants_active.pop_front();
+            m_tenants_active.push_back(&tenant);
+            ++capped;
+            continue;
+        }
+        capped = 0;
+
+        if (!tenant.credited)
+        {
+            tenant.deficit += tenant.weight;
+            tenant.credited = true;
+        }
+
+        auto now = uv_now(&m_uv_loop);
+        while (tenant.deficit > 0 && !tenant.queue.empty() && !at_cap(tenant) && m_tenants_in_flight < max_in_flight)
+        {
+            auto queued = std::move(tenant.queue.front());
+            tenant.queue.pop_front();
+            --tenant.deficit;
+            ++tenant.in_flight;
+            ++m_tenants_in_flight;
+
+            auto waited = now - queued.queued_at;
+            tenant.queued_count.store(tenant.queue.size(), std::memory_order_relaxed);
+            tenant.in_flight_count.store(tenant.in_flight, std::memory_order_relaxed);
+            tenant.admitted.fetch_add(1, std::memory_order_relaxed);
+            tenant.wait_time_ms.fetch_add(waited, std::memory_order_relaxed);
+            if (waited > tenant.max_wait_time_ms.load(std::memory_order_relaxed))
+            {
+                tenant.max_wait_time_ms.store(waited, std::memory_order_relaxed);
+            }
+
+            start_request_on_loop(std::move(queued.request), executor::role::user, &tenant);
+        }
+
+        if (tenant.queue.empty())
+        {
+            tenant.deficit  = 0;
+            tenant.credited = false;
+            tenant.active   = false;
+            m_tenants_active.pop_front();
+        }
+        else if (tenant.deficit == 0 || at_cap(tenant))
+        {
+            tenant.deficit  = 0;
+            tenant.credited = false;
+            m_tenants_active.pop_front();
+            m_tenants_active.push_back(&tenant);
+        }
+        else
+        {
+            // The client is full, the tenant finishes its turn when the next slot frees up.
+            break;
+        }
+    }
+
+    m_admitting = false;
+}
+
+auto client::track_host(executor& exe) -> void
+{
+    auto origin = url_origin(exe.m_request->url());
+    if (origin.empty())
+    {
+        return;
+    }
+
+    auto found = m_hosts.find(origin);
+    if (found == m_hosts.end())
+    {
+        found                    = m_hosts.emplace(std::string{origin}, impl::host_demand{}).first;
+        found->second.warmup_url = found->first + "/";
+    }
+
+    auto& host = found->second;
+    if (exe.m_role == executor::role::warmup)
+    {
+        ++host.warming;
+    }
+    else
+    {
+        ++host.in_flight;
+        host.peak = std::max(host.peak, host.in_flight);
+    }
+    exe.m_host = &host;
+}
+
+auto client::predict_pool() -> void
+{
+    const auto& pool      = m_predictive_pool.value();
+    auto        smoothing = std::clamp(pool.smoothing, 0.0, 1.0);
+    auto        max_total = pool.max_connections;
+    if (m_max_connections.has_value())
+    {
+        max_total = std::min(max_total, m_max_connections.value());
+    }
+    auto max_per_host = pool.max_connections_per_host;
+    if (m_max_host_connections.value_or(0) > 0)
+    {
+        max_per_host = std::min(max_per_host, m_max_host_connections.value());
+    }
+
+    uint64_t total_sample{0};
+    uint64_t total_target{0};
+    uint64_t total_open{0};
+
+    for (auto it = m_hosts.begin(); it != m_hosts.end();)
+    {
+        auto& host   = it->second;
+        auto  sample = std::max(host.peak, host.in_flight);
+        host.peak    = host.in_flight;
+
+        host.average = smoothing * static_cast<double>(sample) + (1.0 - smoothing) * host.average;
+        if (host.average < predictive_pool_idle_average)
+        {
+            host.average = 0.0;
+        }
+        host.target = std::min(
+            max_per_host, static_cast<uint64_t>(std::ceil(host.average * std::max(pool.headroom, 0.0))));
+
+        // libcurl references the host until every connection it counted is closed.
+        if (host.target == 0 && host.in_flight == 0 && host.warming == 0 && host.open_connections == 0)
+        {
+            it = m_hosts.erase(it);
+            continue;
+        }
+
+        total_sample += sample;
+        total_target += host.target;
+        total_open += host.open_connections + host.warming;
+        ++it;
+    }
+    total_target = std::min(total_target, max_total);
+
+    // Open the connections each host is missing, never more than the total allows.
+    if (m_warm_connections && !m_is_stopping.load(std::memory_order_acquire))
+    {
+        auto budget = std::min(pool.max_warmups_per_interval, max_total - std::min(max_total, total_open));
+        for (auto& [origin, host] : m_hosts)
+        {
+            auto open    = host.open_connections + host.warming;
+            auto missing = host.target - std::min(host.target, open);
+            auto warmups = std::min(missing, budget);
+            budget -= warmups;
+
+            for (uint64_t i = 0; i < warmups; ++i)
+            {
+                auto warmup_ptr = std::make_unique<request>(host.warmup_url, predictive_pool_warmup_timeout);
+                warmup_ptr->method(http::method::head);
+
+                m_active_request_count.fetch_add(1, std::memory_order_release);
+                m_metrics.warmup_requests.fetch_add(1, std::memory_order_relaxed);
+                start_request_on_loop(std::move(warmup_ptr), executor::role::warmup);
+            }
+        }
+    }
+
+    // An executor per predicted connection, so a burst doesn't have to allocate them.
+    while (m_executors_total < total_target)
+    {
+        m_executors.push_back(executor::make_unique(this));
+        ++m_executors_total;
+    }
+    m_executors_predicted = static_cast<std::size_t>(total_target);
+    m_metrics.executors_total.store(m_executors_total, std::memory_order_relaxed);
+    m_metrics.executors_pooled.store(m_executors.size(), std::memory_order_relaxed);
+
+    // libcurl otherwise sizes its connection cache from the handles currently added and closes the
+    // idle connections kept for the next burst, zero would remove the limit entirely.
+    if (!m_max_connections.has_value())
+    {
+        auto cache_size = std::max<uint64_t>({1, total_target, 4 * total_sample});
+        set_connection_cache_size(cache_size);
+    }
+}
+
+auto client::inflight_link(executor& exe) -> void
+{
+    exe.m_inflight_prev = m_inflight_tail;
+    exe.m_inflight_next = nullptr;
+    if (m_inflight_tail != nullptr)
+    {
+        m_inflight_tail->m_inflight_next = &exe;
+    }
+    else
+    {
+        m_inflight_head = &exe;
+    }
+    m_inflight_tail = &exe;
+}
+
+auto client::inflight_unlink(executor& exe) -> void
+{
+    if (exe.m_inflight_prev == nullptr && m_inflight_head != &exe)
+    {
+        // Never linked, e.g. libcurl refused the handle.
+        return;
+    }
+
+    (exe.m_inflight_prev != nullptr ? exe.m_inflight_prev->m_inflight_next : m_inflight_head) = exe.m_inflight_next;
+    (exe.m_inflight_next != nullptr ? exe.m_inflight_next->m_inflight_prev : m_inflight_tail) = exe.m_inflight_prev;
+    exe.m_inflight_prev = nullptr;
+    exe.m_inflight_next = nullptr;
+}
+
+auto client::collect_inflight(std::chrono::milliseconds older_than) -> std::vector<lift::inflight_request>
+{
+    std::vector<lift::inflight_request> requests{};
+
+    uv_update_time(&m_uv_loop);
+    auto now = uv_now(&m_uv_loop);
+    for (auto* exe = m_inflight_head; exe != nullptr; exe = exe->m_inflight_next)
+    {
+        if (now - exe->m_started_at >= static_cast<uint64_t>(older_than.count()))
+        {
+            requests.emplace_back(exe->inflight(now));
+        }
+    }
+
+    if (older_than.count() <= 0)
+    {
+        for (const auto& [name, tenant] : m_tenants)
+        {
+            for (const auto& queued : tenant.queue)
+            {
+                auto& info = requests.emplace_back();
+                info.url   = queued.request->url();
+            }
+        }
+
+        auto add_queued = [&](const std::vector<request_ptr>& queue)
+        {
+            for (const auto& request_ptr : queue)
+            {
+                // Requests already started from the grabbed queue have been moved out.
+                if (request_ptr != nullptr)
+                {
+                    auto& info = requests.emplace_back();
+                    info.url   = request_ptr->url();
+                }
+            }
+        };
+
+        add_queued(m_grabbed_requests);
+        for (const auto& [due, request_ptr] : m_scheduled_requests)
+        {
+            auto& info = requests.emplace_back();
+            info.url   = request_ptr->url();
+        }
+        std::lock_guard<std::mutex> guard{m_pending_requests_lock};
+        add_queued(m_pending_requests);
+    }
+
+    return requests;
+}
+
+auto client::acquire_executor() -> std::unique_ptr<executor>
+{
+    std::unique_ptr<executor> executor_ptr{nullptr};
+
     if (!m_executors.empty())
     {
         executor_ptr = std::move(m_executors.back());
         m_executors.pop_back();
+        m_executors_low_water = std::min(m_executors_low_water, m_executors.size());
+        m_metrics.executors_pooled.store(m_executors.size(), std::memory_order_relaxed);
     }
 
     if (executor_ptr == nullptr)
     {
         executor_ptr = executor::make_unique(this);
+        m_executors_low_water = 0;
+        ++m_executors_total;
+        m_metrics.executors_total.store(m_executors_total, std::memory_order_relaxed);
     }
 
     return executor_ptr;
@@ -488,6 +1600,65 @@ auto client::return_executor(std::unique_ptr<executor> executor_ptr) -> void
 {
     executor_ptr->reset();
     m_executors.push_back(std::move(executor_ptr));
+    m_metrics.executors_pooled.store(m_executors.size(), std::memory_order_relaxed);
+}
+
+auto client::trim_pools() -> void
+{
+    // Anything that stayed in a pool for the entire interval was not needed to serve the load seen
+    // during that interval, those are safe to release.
+    auto executors_unused = std::min(m_executors_low_water, m_executors.size());
+    auto executors_kept   = std::max(m_executors_reserved, m_executors_predicted);
+    while (executors_unused > 0 && m_executors_total > executors_kept)
+    {
+        m_executors.pop_front();
+        --m_executors_total;
+        --executors_unused;
+    }
+    if (m_executors.empty())
+    {
+        m_executors.shrink_to_fit();
+    }
+    m_executors_low_water = m_executors.size();
+
+    auto curl_contexts_unused = std::min(m_curl_contexts_low_water, m_curl_context_ready.size());
+    for (std::size_t i = 0; i < curl_contexts_unused; ++i)
+    {
+        m_curl_context_ready.pop_front();
+    }
+    if (m_curl_context_ready.empty())
+    {
+        m_curl_context_ready.shrink_to_fit();
+    }
+    m_curl_contexts_low_water = m_curl_context_ready.size();
+
+    // The request queues are swapped back and forth, so both are shrunk to the largest batch
+    // actually accepted during the interval.
+    auto high_water = m_grabbed_requests_high_water;
+    if (m_grabbed_requests.capacity() > high_water)
+    {
+        std::vector<request_ptr> shrunk{};
+        shrunk.reserve(high_water);
+        m_grabbed_requests.swap(shrunk);
+    }
+    std::size_t pending_capacity{0};
+    {
+        std::lock_guard<std::mutex> guard{m_pending_requests_lock};
+        if (m_pending_requests.empty() && m_pending_requests.capacity() > high_water)
+        {
+            std::vector<request_ptr> shrunk{};
+            shrunk.reserve(high_water);
+            m_pending_requests.swap(shrunk);
+        }
+        pending_capacity = m_pending_requests.capacity();
+    }
+    m_grabbed_requests_high_water = 0;
+
+    m_metrics.executors_total.store(m_executors_total, std::memory_order_relaxed);
+    m_metrics.executors_pooled.store(m_executors.size(), std::memory_order_relaxed);
+    m_metrics.curl_contexts_pooled.store(m_curl_context_ready.size(), std::memory_order_relaxed);
+    m_metrics.request_queue_capacity.store(
+        m_grabbed_requests.capacity() + pending_capacity, std::memory_order_relaxed);
 }
 
 auto curl_start_timeout(CURLM* /*cmh*/, long timeout_ms, void* user_data) -> void
@@ -497,20 +1668,51 @@ auto curl_start_timeout(CURLM* /*cmh*/, long timeout_ms, void* user_data) -> voi
     // Stop the current timer regardless.
     uv_timer_stop(&c->m_uv_timer_curl);
 
-    if (timeout_ms > 0)
+    // A zero timeout is also deferred to the timer, this is called from within libcurl which rejects
+    // a nested curl_multi_socket_action() and the expiry would be lost, stalling a quiet transfer.
+    if (timeout_ms >= 0)
     {
         uv_timer_start(&c->m_uv_timer_curl, on_uv_timeout_callback, static_cast<uint64_t>(timeout_ms), 0);
     }
-    else if (timeout_ms == 0)
-    {
-        c->check_actions();
-    }
 }
 
 auto curl_handle_socket_actions(CURL* /*curl*/, curl_socket_t socket, int action, void* user_data, void* socketp) -> int
 {
     auto* c = static_cast<client*>(user_data);
 
+#if defined(LIFT_IO_URING)
+    if (c->m_io_uring != nullptr)
+    {
+        auto& ring = *c->m_io_uring;
+        if (action == CURL_POLL_IN || action == CURL_POLL_OUT || action == CURL_POLL_INOUT)
+        {
+            uint32_t events = 0;
+            if (action != CURL_POLL_OUT)
+            {
+                events |= impl::io_uring_poller::readable;
+            }
+            if (action != CURL_POLL_IN)
+            {
+                events |= impl::io_uring_poller::writable;
+            }
+
+            auto* token = ring.watch(socketp, socket, events);
+            if (token != socketp)
+            {
+                curl_multi_assign(c->m_cmh, socket, token);
+            }
+        }
+        else if (action == CURL_POLL_REMOVE && socketp != nullptr)
+        {
+            ring.unwatch(socketp);
+            curl_multi_assign(c->m_cmh, socket, nullptr);
+        }
+
+        c->m_metrics.socket_poll_updates.store(ring.updates(), std::memory_order_relaxed);
+        return 0;
+    }
+#endif
+
     curl_context* cc = nullptr;
     if (action == CURL_POLL_IN || action == CURL_POLL_OUT || action == CURL_POLL_INOUT)
     {
@@ -531,6 +1733,8 @@ auto curl_handle_socket_actions(CURL* /*curl*/, curl_socket_t socket, int action
             {
                 cc = c->m_curl_context_ready.front().release();
                 c->m_curl_context_ready.pop_front();
+                c->m_curl_contexts_low_water = std::min(c->m_curl_contexts_low_water, c->m_curl_context_ready.size());
+                c->m_metrics.curl_contexts_pooled.store(c->m_curl_context_ready.size(), std::memory_order_relaxed);
             }
 
             cc->init(&c->m_uv_loop, socket);
@@ -558,9 +1762,13 @@ auto curl_handle_socket_actions(CURL* /*curl*/, curl_socket_t socket, int action
             }
             break;
         default:
-            break;
+            return 0;
     }
 
+    // Every uv_poll_start() and close is applied by libuv with its own epoll_ctl.
+    c->m_metrics.socket_poll_updates.fetch_add(1, std::memory_order_relaxed);
+    c->m_metrics.socket_poll_syscalls.fetch_add(1, std::memory_order_relaxed);
+
     return 0;
 }
 
@@ -615,52 +1823,228 @@ auto on_uv_requests_accept_async(uv_async_t* handle) -> void
      * vectors before working on them so we have exclusive access
      * to the request objects on the client thread.
      */
+    std::size_t                                                    pending_capacity{0};
+    std::vector<std::promise<std::vector<lift::inflight_request>>> inflight_waiters{};
+    std::vector<std::pair<client::time_point, request_ptr>>        scheduled{};
     {
         std::lock_guard<std::mutex> guard{c->m_pending_requests_lock};
         // swap so we can release the lock as quickly as possible
         c->m_grabbed_requests.swap(c->m_pending_requests);
+        c->m_requests_pending.store(false, std::memory_order_relaxed);
+        pending_capacity = c->m_pending_requests.capacity();
+        if (!c->m_inflight_waiters.empty())
+        {
+            inflight_waiters.swap(c->m_inflight_waiters);
+        }
+        if (!c->m_loop_tasks.empty())
+        {
+            c->m_grabbed_tasks.swap(c->m_loop_tasks);
+        }
+        if (!c->m_pending_scheduled.empty())
+        {
+            scheduled.swap(c->m_pending_scheduled);
+        }
     }
 
-    for (auto& request_ptr : c->m_grabbed_requests)
+    if (!scheduled.empty())
+    {
+        for (auto& [due, request_ptr] : scheduled)
+        {
+            c->m_scheduled_requests.emplace(due, std::move(request_ptr));
+        }
+        c->update_scheduled();
+    }
+
+    // Taken before the grabbed requests start so they are listed as queued.
+    if (!inflight_waiters.empty())
     {
-        auto executor_ptr = c->acquire_executor();
-        executor_ptr->start_async(std::move(request_ptr), c->m_share_ptr.get());
-        executor_ptr->prepare();
+        auto snapshot = c->collect_inflight(0ms);
+        for (auto& waiter : inflight_waiters)
+        {
+            waiter.set_value(snapshot);
+        }
+    }
 
-        // This must be done before adding to the CURLM* object,
-        // if not its possible a very fast request could complete
-        // before this gets into the multi-map!
-        c->add_timeout(*executor_ptr);
+    // Run before the grabbed requests start so they see every change submitted ahead of them.
+    for (auto& task : c->m_grabbed_tasks)
+    {
+        task();
+    }
+    c->m_grabbed_tasks.clear();
 
-        auto curl_code = curl_multi_add_handle(c->m_cmh, executor_ptr->m_curl_handle);
+    c->m_grabbed_requests_high_water = std::max(c->m_grabbed_requests_high_water, c->m_grabbed_requests.size());
+    c->m_metrics.requests_accepted.fetch_add(c->m_grabbed_requests.size(), std::memory_order_relaxed);
+    c->m_metrics.request_queue_capacity.store(
+        c->m_grabbed_requests.capacity() + pending_capacity, std::memory_order_relaxed);
 
-        if (curl_code != CURLM_OK && curl_code != CURLM_CALL_MULTI_PERFORM)
+    // Measured before the grabbed requests start, the fastest of them could already complete.
+    std::size_t own_requests{0};
+    if (c->m_mirror.has_value())
+    {
+        // Requests scheduled for later are counted as active but are not yet loading the client.
+        auto scheduled_count = c->m_metrics.requests_scheduled.load(std::memory_order_acquire);
+        auto active_count    = c->m_active_request_count.load(std::memory_order_acquire);
+        auto not_own         = std::min<uint64_t>(active_count, c->m_shadows_in_flight + scheduled_count);
+        own_requests         = active_count - not_own;
+    }
+
+    for (auto& request_ptr : c->m_grabbed_requests)
+    {
+        if (c->m_mirror.has_value())
+        {
+            c->mirror_request(*request_ptr);
+        }
+
+        if (c->m_fair_queuing.has_value())
         {
-            /**
-             * If curl_multi_add_handle fails then notify the user that the request failed to start
-             * immediately.  This will return the just acquired executor back into the pool.
-             */
-            c->complete_request_normal(std::move(executor_ptr), executor::convert(CURLcode::CURLE_SEND_ERROR));
+            c->enqueue_tenant(std::move(request_ptr));
         }
         else
         {
-            /**
-             * Drop the unique_ptr safety around the request_ptr while it is being
-             * processed by curl.  When curl is finished completing the request
-             * it will be put back into a request object for the client to use.
-             */
-            (void)executor_ptr.release();
-
-            /**
-             * Immediately call curl's check action to get the current request moving.
-             * Curl appears to have an internal queue and if it gets too long it might
-             * drop requests.
-             */
-            c->check_actions();
+            c->start_request_on_loop(std::move(request_ptr), executor::role::user);
         }
     }
 
+    if (c->m_fair_queuing.has_value())
+    {
+        c->admit_requests();
+    }
+
+    // The shadow copies wait until the originals are on their way.
+    if (c->m_mirror.has_value())
+    {
+        c->start_shadows(own_requests);
+    }
+
     c->m_grabbed_requests.clear();
+
+    // Last, the destructor stops waiting on the client as soon as these are counted out.
+    if (c->m_is_stopping.load(std::memory_order_acquire) && !c->m_scheduled_requests.empty())
+    {
+        c->fail_scheduled_requests();
+    }
+}
+
+auto on_uv_pool_trim_callback(uv_timer_t* handle) -> void
+{
+    auto* c = static_cast<client*>(handle->data);
+    c->trim_pools();
+}
+
+auto on_uv_inflight_dump_callback(uv_timer_t* handle) -> void
+{
+    auto* c    = static_cast<client*>(handle->data);
+    auto& dump = c->m_inflight_dump.value();
+
+    auto requests = c->collect_inflight(std::max(dump.older_than, 1ms));
+    if (!requests.empty())
+    {
+        dump.handler(requests);
+    }
+}
+
+auto on_uv_predictive_pool_callback(uv_timer_t* handle) -> void
+{
+    auto* c = static_cast<client*>(handle->data);
+    c->predict_pool();
+}
+
+auto on_uv_scheduled_callback(uv_timer_t* handle) -> void
+{
+    auto* c   = static_cast<client*>(handle->data);
+    auto  now = uv_now(&c->m_uv_loop);
+
+    // Due requests join the submission queue, the loop accepts them before it next blocks.
+    auto due_end = c->m_scheduled_requests.upper_bound(now);
+    if (due_end != c->m_scheduled_requests.begin())
+    {
+        uint64_t due_count{0};
+        {
+            std::lock_guard<std::mutex> guard{c->m_pending_requests_lock};
+            for (auto it = c->m_scheduled_requests.begin(); it != due_end; ++it)
+            {
+                c->m_pending_requests.emplace_back(std::move(it->second));
+                ++due_count;
+            }
+            c->m_requests_pending.store(true, std::memory_order_seq_cst);
+        }
+        c->m_scheduled_requests.erase(c->m_scheduled_requests.begin(), due_end);
+        c->m_metrics.requests_scheduled.fetch_sub(due_count, std::memory_order_relaxed);
+    }
+
+    // A task can schedule more tasks, only the ones due now run in this pass.
+    while (!c->m_scheduled_tasks.empty() && c->m_scheduled_tasks.begin()->first <= now)
+    {
+        auto task = std::move(c->m_scheduled_tasks.begin()->second);
+        c->m_scheduled_tasks.erase(c->m_scheduled_tasks.begin());
+        task();
+    }
+
+    c->m_metrics.tasks_scheduled.store(c->m_scheduled_tasks.size(), std::memory_order_relaxed);
+    c->update_scheduled();
+}
+
+auto on_uv_io_uring_ready_callback(uv_poll_t* handle, int /*status*/, int /*events*/) -> void
+{
+#if defined(LIFT_IO_URING)
+    auto* c = static_cast<client*>(handle->data);
+    c->m_io_uring->reap(
+        [](void* user_data, int fd, uint32_t events)
+        {
+            int32_t action = 0;
+            if ((events & (impl::io_uring_poller::readable | impl::io_uring_poller::hangup)) != 0)
+            {
+                action |= CURL_CSELECT_IN;
+            }
+            if ((events & impl::io_uring_poller::writable) != 0)
+            {
+                action |= CURL_CSELECT_OUT;
+            }
+            if ((events & impl::io_uring_poller::error) != 0)
+            {
+                action |= CURL_CSELECT_ERR;
+            }
+            static_cast<client*>(user_data)->check_actions(fd, action);
+        },
+        c);
+#else
+    (void)handle;
+#endif
+}
+
+auto on_uv_io_uring_prepare_callback(uv_prepare_t* handle) -> void
+{
+#if defined(LIFT_IO_URING)
+    auto* c = static_cast<client*>(handle->data);
+    c->m_io_uring->submit();
+    c->m_metrics.socket_poll_syscalls.store(c->m_io_uring->submits(), std::memory_order_relaxed);
+#else
+    (void)handle;
+#endif
+}
+
+auto on_uv_loop_prepare_callback(uv_prepare_t* handle) -> void
+{
+    auto* c = static_cast<client*>(handle->data);
+    if (c->m_spinning)
+    {
+        // A non-blocking spin iteration, the loop stays awake.
+        return;
+    }
+
+    // Order matters: once the loop is marked asleep any new submitter wakes it, anything submitted
+    // before that is seen here.  Both sides are seq_cst so neither can miss the other.
+    c->m_loop_awake.store(false, std::memory_order_seq_cst);
+    if (c->m_requests_pending.load(std::memory_order_seq_cst))
+    {
+        on_uv_requests_accept_async(&c->m_uv_async);
+    }
+}
+
+auto on_uv_loop_check_callback(uv_check_t* handle) -> void
+{
+    auto* c = static_cast<client*>(handle->data);
+    c->m_loop_awake.store(true, std::memory_order_seq_cst);
 }
 
 auto on_uv_timesup_callback(uv_timer_t* handle) -> void
@@ -675,19 +2059,65 @@ auto on_uv_timesup_callback(uv_timer_t* handle) -> void
 
     auto now = uv_now(&c->m_uv_loop);
 
-    // While the items in the timesup map are <= now "timesup" them to the client.
-    auto iter = timesup.begin();
-    while (iter != timesup.end())
+    // While the items in the timesup map are <= now "timesup" them to the client.  Orphaning a
+    // transfer can complete other requests and erase their nodes, so always restart from the front.
+    while (!timesup.empty() && timesup.begin()->first <= now)
     {
-        auto& [tp, exe] = *iter;
-        if (tp > now)
-        {
-            // Everything past this point has more time to wait.
-            break;
-        }
+        auto* exe = timesup.begin()->second;
 
         c->complete_request_timeout(*exe);
-        iter = c->remove_timeout(*exe);
+        c->remove_timeout(*exe);
+        c->orphan(*exe);
+    }
+
+    // Aborted transfers made room for queued requests.
+    if (c->m_fair_queuing.has_value())
+    {
+        c->admit_requests();
+    }
+}
+
+auto curl_prereq_callback(
+    void* clientp,
+    char* /*conn_primary_ip*/,
+    char* /*conn_local_ip*/,
+    int /*conn_primary_port*/,
+    int /*conn_local_port*/) -> int
+{
+#if LIBCURL_VERSION_NUM >= 0x075000
+    auto* exe        = static_cast<executor*>(clientp);
+    exe->m_connected = true;
+
+    if (exe->m_orphaned)
+    {
+        exe->m_client->m_metrics.orphans_connected.fetch_add(1, std::memory_order_relaxed);
+        return CURL_PREREQFUNC_ABORT;
+    }
+
+    return CURL_PREREQFUNC_OK;
+#else
+    (void)clientp;
+    return 0;
+#endif
+}
+
+static auto on_file_reader_ready(void* user_data) -> void
+{
+    // Called on the file reader's thread, the async handle is the only thread safe way in.
+    uv_async_send(static_cast<uv_async_t*>(user_data));
+}
+
+auto on_uv_file_reader_ready_async(uv_async_t* handle) -> void
+{
+    auto* c = static_cast<client*>(handle->data);
+
+    for (const auto& source : c->m_file_reader->take_ready())
+    {
+        // A source detached from its transfer has no handle to resume.
+        if (auto* curl_handle = source->curl_handle(); curl_handle != nullptr)
+        {
+            curl_easy_pause(curl_handle, CURLPAUSE_CONT);
+        }
     }
 }
 
@@ -1,7 +1,14 @@
 #include "lift/executor.hpp"
 #include "lift/client.hpp"
+#include "lift/impl/file_reader.hpp"
+#include "lift/impl/mime_body.hpp"
 #include "lift/init.hpp"
 
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+
 namespace lift
 {
 auto curl_write_header(char* buffer, size_t size, size_t nitems, void* user_ptr) -> size_t;
@@ -17,6 +24,43 @@ auto curl_xfer_info(
 
 auto curl_debug_info_callback(CURL* handle, curl_infotype type, char* data, size_t size, void* userptr) -> int;
 
+static auto curl_sockopt_callback(void* clientp, curl_socket_t curlfd, curlsocktype purpose) -> int;
+
+static auto curl_close_socket_callback(void* clientp, curl_socket_t item) -> int;
+
+static auto curl_discard(char* buffer, size_t size, size_t nitems, void* user_ptr) -> size_t;
+
+/**
+ * @return The request's own value if it set one, otherwise the client's default if there is one,
+ *         otherwise the library default.
+ */
+template<typename value_type>
+static auto with_default(
+    const std::optional<value_type>& own, const std::optional<value_type>* client_default, value_type library_default)
+    -> value_type
+{
+    if (own.has_value())
+    {
+        return own.value();
+    }
+    if (client_default != nullptr && client_default->has_value())
+    {
+        return client_default->value();
+    }
+    return library_default;
+}
+
+static auto header_names_equal(std::string_view a, std::string_view b) -> bool
+{
+    return std::equal(
+        a.begin(),
+        a.end(),
+        b.begin(),
+        b.end(),
+        [](char x, char y)
+        { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+}
+
 executor::executor(request* request, share* share) : m_request_sync(request), m_request(m_request_sync), m_response()
 {
     if (share != nullptr)
@@ -63,20 +107,52 @@ auto executor::perform() -> response
 auto executor::prepare() -> void
 {
     curl_easy_setopt(m_curl_handle, CURLOPT_PRIVATE, this);
-    curl_easy_setopt(m_curl_handle, CURLOPT_HEADERFUNCTION, curl_write_header);
-    curl_easy_setopt(m_curl_handle, CURLOPT_HEADERDATA, this);
-    curl_easy_setopt(m_curl_handle, CURLOPT_WRITEFUNCTION, curl_write_data);
-    curl_easy_setopt(m_curl_handle, CURLOPT_WRITEDATA, this);
+    if (m_role == role::shadow)
+    {
+        // Nobody reads a shadow copy's response, it is dropped as it arrives.
+        curl_easy_setopt(m_curl_handle, CURLOPT_HEADERFUNCTION, curl_discard);
+        curl_easy_setopt(m_curl_handle, CURLOPT_WRITEFUNCTION, curl_discard);
+    }
+    else
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_HEADERFUNCTION, curl_write_header);
+        curl_easy_setopt(m_curl_handle, CURLOPT_HEADERDATA, this);
+        curl_easy_setopt(m_curl_handle, CURLOPT_WRITEFUNCTION, curl_write_data);
+        curl_easy_setopt(m_curl_handle, CURLOPT_WRITEDATA, this);
+    }
     curl_easy_setopt(m_curl_handle, CURLOPT_NOSIGNAL, 1L);
 
     curl_easy_setopt(m_curl_handle, CURLOPT_URL, m_request->url().c_str());
 
+    std::pmr::memory_resource* resource = m_request->memory_resource();
+    if (resource == nullptr && m_client != nullptr)
+    {
+        resource = m_client->m_memory_resource;
+    }
+    if (resource == nullptr)
+    {
+        resource = std::pmr::get_default_resource();
+    }
+    if (m_response.memory_resource() != resource)
+    {
+        m_response.memory_resource(resource);
+    }
+
+    // The curl handle is always fresh or has been curl_easy_reset() at this point, settings that
+    // match libcurl's own defaults are not set again.
+
+    const request_defaults* defaults{nullptr};
+    if (m_client != nullptr && m_client->m_request_defaults.has_value())
+    {
+        defaults = &m_client->m_request_defaults.value();
+    }
+
     switch (m_request->method())
     {
         case http::method::unknown: // default to GET on unknown/bad value.
             /* INTENTIONAL FALLTHROUGH */
         case http::method::get:
-            curl_easy_setopt(m_curl_handle, CURLOPT_HTTPGET, 1L);
+            // libcurl default.
             break;
         case http::method::head:
             curl_easy_setopt(m_curl_handle, CURLOPT_NOBODY, 1L);
@@ -101,12 +177,14 @@ auto executor::prepare() -> void
             break;
     }
 
-    switch (m_request->version())
+    auto version = with_default(
+        m_request->m_version, (defaults != nullptr) ? &defaults->version : nullptr, http::version::use_best);
+    switch (version)
     {
         case http::version::unknown: // default to USE_BEST on unknown/bad value.
             /* INTENTIONAL FALLTHROUGH */
         case http::version::use_best:
-            curl_easy_setopt(m_curl_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_NONE);
+            // libcurl default, CURL_HTTP_VERSION_NONE.
             break;
         case http::version::v1_0:
             curl_easy_setopt(m_curl_handle, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_1_0);
@@ -146,23 +224,44 @@ auto executor::prepare() -> void
 
     // Connection timeout is handled when injecting into the CURLM* event loop for asynchronous requests.
 
-    if (m_request->follow_redirects())
+    // The redirect limit always comes from wherever follow redirects was decided.
+    bool    follow_redirects{true};
+    int64_t max_redirects{-1};
+    if (m_request->m_follow_redirects.has_value())
     {
-        curl_easy_setopt(m_curl_handle, CURLOPT_FOLLOWLOCATION, 1L);
-        curl_easy_setopt(m_curl_handle, CURLOPT_MAXREDIRS, static_cast<long>(m_request->max_redirects()));
+        follow_redirects = m_request->m_follow_redirects.value();
+        max_redirects    = m_request->m_max_redirects;
     }
-    else
+    else if (defaults != nullptr && defaults->follow_redirects.has_value())
     {
-        curl_easy_setopt(m_curl_handle, CURLOPT_FOLLOWLOCATION, 0L);
+        follow_redirects = defaults->follow_redirects.value();
+        max_redirects    = (follow_redirects) ? defaults->max_redirects.value_or(-1) : 0;
     }
 
+    if (follow_redirects)
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(m_curl_handle, CURLOPT_MAXREDIRS, static_cast<long>(max_redirects));
+    }
+    // else libcurl default, not following redirects.
+
     // https://curl.haxx.se/libcurl/c/CURLOPT_SSL_VERIFYPEER.html
-    curl_easy_setopt(m_curl_handle, CURLOPT_SSL_VERIFYPEER, (m_request->verify_ssl_peer()) ? 1L : 0L);
-    // Note that 1L is valid, but curl docs say its basically deprecated.
+    if (!with_default(m_request->m_verify_ssl_peer, (defaults != nullptr) ? &defaults->verify_ssl_peer : nullptr, true))
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_SSL_VERIFYPEER, 0L);
+    }
+    // Note that 1L is valid, but curl docs say its basically deprecated, 2L is the libcurl default.
     // https://curl.haxx.se/libcurl/c/CURLOPT_SSL_VERIFYHOST.html
-    curl_easy_setopt(m_curl_handle, CURLOPT_SSL_VERIFYHOST, (m_request->verify_ssl_host()) ? 2L : 0L);
+    if (!with_default(m_request->m_verify_ssl_host, (defaults != nullptr) ? &defaults->verify_ssl_host : nullptr, true))
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_SSL_VERIFYHOST, 0L);
+    }
     // https://curl.haxx.se/libcurl/c/CURLOPT_SSL_VERIFYSTATUS.html
-    curl_easy_setopt(m_curl_handle, CURLOPT_SSL_VERIFYSTATUS, (m_request->verify_ssl_status()) ? 1L : 0L);
+    if (with_default(
+            m_request->m_verify_ssl_status, (defaults != nullptr) ? &defaults->verify_ssl_status : nullptr, false))
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_SSL_VERIFYSTATUS, 1L);
+    }
 
     // https://curl.haxx.se/libcurl/c/CURLOPT_SSLCERT.html
     if (const auto& cert = m_request->ssl_cert(); cert.has_value())
@@ -245,42 +344,12 @@ auto executor::prepare() -> void
     const auto& encodings = m_request->accept_encodings();
     if (encodings.has_value())
     {
-        if (!encodings.value().empty())
-        {
-            std::size_t length{0};
-            for (const auto& e : encodings.value())
-            {
-                length += e.length() + 2; // for ", "
-            }
-
-            std::string joined{};
-            joined.reserve(length);
-
-            bool first{true};
-            for (auto& e : encodings.value())
-            {
-                if (first)
-                {
-                    first = false;
-                }
-                else
-                {
-                    joined.append(", ");
-                }
-                joined.append(e);
-            }
-
-            // strings are copied into libcurl except for POSTFIELDS.
-            curl_easy_setopt(m_curl_handle, CURLOPT_ACCEPT_ENCODING, joined.c_str());
-        }
-        else
-        {
-            // From the CURL docs (https://curl.haxx.se/libcurl/c/CURLOPT_ACCEPT_ENCODING.html):
-            // 'To aid applications not having to bother about what specific algorithms this particular
-            // libcurl build supports, libcurl allows a zero-length string to be set ("") to ask for an
-            // Accept-Encoding: header to be used that contains all built-in supported encodings.'
-            curl_easy_setopt(m_curl_handle, CURLOPT_ACCEPT_ENCODING, "");
-        }
+        // strings are copied into libcurl except for POSTFIELDS.
+        curl_easy_setopt(m_curl_handle, CURLOPT_ACCEPT_ENCODING, join_accept_encodings(encodings.value()).c_str());
+    }
+    else if (m_client != nullptr && m_client->m_default_accept_encoding.has_value())
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_ACCEPT_ENCODING, m_client->m_default_accept_encoding.value().c_str());
     }
 
     // Headers
@@ -290,30 +359,74 @@ auto executor::prepare() -> void
         m_curl_request_headers = nullptr;
     }
 
-    for (auto& header : m_request->m_request_headers)
-    {
-        m_curl_request_headers = curl_slist_append(m_curl_request_headers, header.data().data());
-    }
-
-    if (m_curl_request_headers != nullptr)
+    const auto& mime_template = m_request->mime_template();
+    if (m_request->headers().empty() && mime_template == nullptr)
     {
-        curl_easy_setopt(m_curl_handle, CURLOPT_HTTPHEADER, m_curl_request_headers);
+        // The client's prebuilt default header list is used as is, libcurl only reads it.
+        if (m_client != nullptr && m_client->m_default_headers != nullptr)
+        {
+            curl_easy_setopt(m_curl_handle, CURLOPT_HTTPHEADER, m_client->m_default_headers);
+        }
     }
     else
     {
-        curl_easy_setopt(m_curl_handle, CURLOPT_HTTPHEADER, nullptr);
+        if (defaults != nullptr)
+        {
+            for (const auto& default_header : defaults->headers)
+            {
+                bool replaced = std::any_of(
+                    m_request->headers().begin(),
+                    m_request->headers().end(),
+                    [&](const lift::header& h) { return header_names_equal(h.name(), default_header.name()); });
+                if (!replaced)
+                {
+                    m_curl_request_headers = curl_slist_append(m_curl_request_headers, default_header.data().data());
+                }
+            }
+        }
+
+        for (const auto& header : m_request->headers())
+        {
+            m_curl_request_headers = curl_slist_append(m_curl_request_headers, header.data().data());
+        }
+
+        if (mime_template != nullptr)
+        {
+            m_curl_request_headers =
+                curl_slist_append(m_curl_request_headers, mime_template->m_content_type_header.c_str());
+        }
+
+        curl_easy_setopt(m_curl_handle, CURLOPT_HTTPHEADER, m_curl_request_headers);
     }
 
-    // DNS resolve hosts
-    if (!m_request->m_resolve_hosts.empty() || (m_client != nullptr && !m_client->m_resolve_hosts.empty()))
+    // DNS resolve hosts, the client's are connect-to entries so libcurl only reuses a connection for
+    // requests sent to the address it was made to.  Through a proxy they go into the DNS cache instead.
+    const auto& request_resolve_hosts = m_request->resolve_hosts();
+    const bool  has_client_hosts =
+        m_client != nullptr && (!m_client->m_resolve_hosts.empty() || !m_client->m_resolve_hosts_removed.empty());
+    if (!request_resolve_hosts.empty() || has_client_hosts)
     {
         if (m_curl_resolve_hosts != nullptr)
         {
             curl_slist_free_all(m_curl_resolve_hosts);
             m_curl_resolve_hosts = nullptr;
         }
+        if (m_curl_connect_to != nullptr)
+        {
+            curl_slist_free_all(m_curl_connect_to);
+            m_curl_connect_to = nullptr;
+        }
 
-        for (const auto& resolve_host : m_request->m_resolve_hosts)
+        const bool proxied = m_request->proxy().has_value();
+        if (m_client != nullptr && proxied)
+        {
+            for (const auto& removed : m_client->m_resolve_hosts_removed)
+            {
+                m_curl_resolve_hosts = curl_slist_append(m_curl_resolve_hosts, removed.data());
+            }
+        }
+
+        for (const auto& resolve_host : request_resolve_hosts)
         {
             m_curl_resolve_hosts =
                 curl_slist_append(m_curl_resolve_hosts, resolve_host.curl_formatted_resolve_host().data());
@@ -323,12 +436,63 @@ auto executor::prepare() -> void
         {
             for (const auto& resolve_host : m_client->m_resolve_hosts)
             {
-                m_curl_resolve_hosts =
-                    curl_slist_append(m_curl_resolve_hosts, resolve_host.curl_formatted_resolve_host().data());
+                if (proxied)
+                {
+                    m_curl_resolve_hosts =
+                        curl_slist_append(m_curl_resolve_hosts, resolve_host.curl_formatted_resolve_host().data());
+                }
+                else
+                {
+                    m_curl_connect_to =
+                        curl_slist_append(m_curl_connect_to, resolve_host.curl_formatted_connect_to().data());
+                }
             }
         }
 
-        curl_easy_setopt(m_curl_handle, CURLOPT_RESOLVE, m_curl_resolve_hosts);
+        if (m_curl_resolve_hosts != nullptr)
+        {
+            curl_easy_setopt(m_curl_handle, CURLOPT_RESOLVE, m_curl_resolve_hosts);
+        }
+        if (m_curl_connect_to != nullptr)
+        {
+            curl_easy_setopt(m_curl_handle, CURLOPT_CONNECT_TO, m_curl_connect_to);
+        }
+    }
+
+    // Local source address, rotated across the client's source addresses one request at a time.
+    if (m_client != nullptr && !m_client->m_source_addresses.empty())
+    {
+        auto index                      = m_client->m_next_source_address;
+        m_client->m_next_source_address = (index + 1) % m_client->m_source_addresses.size();
+
+        const auto& source = m_client->m_source_addresses[index];
+        if (!source.address.empty())
+        {
+            curl_easy_setopt(m_curl_handle, CURLOPT_INTERFACE, source.address.c_str());
+        }
+        if (source.port.has_value())
+        {
+            curl_easy_setopt(m_curl_handle, CURLOPT_LOCALPORT, static_cast<long>(source.port.value()));
+            curl_easy_setopt(
+                m_curl_handle, CURLOPT_LOCALPORTRANGE, static_cast<long>(std::max<uint16_t>(1, source.port_range)));
+        }
+        m_source_address = index;
+    }
+
+    // Counts the connections open to the host for the client's predictive pool.  libcurl keeps the
+    // close callback with the connection, so the host is closed against even after this request.
+    if (m_host != nullptr && m_client->m_warm_connections)
+    {
+        curl_easy_setopt(m_curl_handle, CURLOPT_SOCKOPTFUNCTION, curl_sockopt_callback);
+        curl_easy_setopt(m_curl_handle, CURLOPT_SOCKOPTDATA, m_host);
+        curl_easy_setopt(m_curl_handle, CURLOPT_CLOSESOCKETFUNCTION, curl_close_socket_callback);
+        curl_easy_setopt(m_curl_handle, CURLOPT_CLOSESOCKETDATA, m_host);
+
+        // A warm-up is only useful if it opens a connection, the new connection is kept afterwards.
+        if (m_role == role::warmup)
+        {
+            curl_easy_setopt(m_curl_handle, CURLOPT_FRESH_CONNECT, 1L);
+        }
     }
 
     // POST or MIME data
@@ -337,6 +501,54 @@ auto executor::prepare() -> void
         curl_easy_setopt(m_curl_handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(m_request->data().size()));
         curl_easy_setopt(m_curl_handle, CURLOPT_POSTFIELDS, m_request->data().data());
     }
+    else if (mime_template != nullptr)
+    {
+        // The template's parts are already encoded, only this request's own parts are encoded here.
+        m_mime_body = std::make_unique<impl::mime_body>(mime_template);
+
+        for (const auto& mime_field : m_request->mime_fields())
+        {
+            m_mime_body->append(mime_template->part_header(mime_field));
+
+            if (std::holds_alternative<std::string>(mime_field.value()))
+            {
+                m_mime_body->append(std::string_view{std::get<std::string>(mime_field.value())});
+            }
+            else if (!mime_field.m_file_size.has_value())
+            {
+                m_mime_body->fail();
+            }
+            else if (m_client != nullptr)
+            {
+                auto size   = mime_field.m_file_size.value();
+                auto source = std::make_shared<impl::file_source>(
+                    *m_client->m_file_reader, std::get<std::filesystem::path>(mime_field.value()), size, m_curl_handle);
+                source->start();
+                m_mime_body->append(source, size);
+                m_file_sources.push_back(std::move(source));
+            }
+            else
+            {
+                m_mime_body->append(
+                    std::get<std::filesystem::path>(mime_field.value()), mime_field.m_file_size.value());
+            }
+
+            m_mime_body->append(std::string_view{"\r\n"});
+        }
+        m_mime_body->finish();
+
+        curl_easy_setopt(m_curl_handle, CURLOPT_POST, 1L);
+        curl_easy_setopt(m_curl_handle, CURLOPT_READFUNCTION, impl::mime_body::curl_read);
+        curl_easy_setopt(m_curl_handle, CURLOPT_READDATA, m_mime_body.get());
+        curl_easy_setopt(m_curl_handle, CURLOPT_SEEKFUNCTION, impl::mime_body::curl_seek);
+        curl_easy_setopt(m_curl_handle, CURLOPT_SEEKDATA, m_mime_body.get());
+        if (mime_template->content_length())
+        {
+            curl_easy_setopt(
+                m_curl_handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(m_mime_body->size()));
+        }
+        // else libcurl sends a body of unknown size with chunked transfer encoding.
+    }
     else if (m_request->m_mime_fields_set)
     {
         m_mime_handle = curl_mime_init(m_curl_handle);
@@ -351,6 +563,30 @@ auto executor::prepare() -> void
                 const auto& value = std::get<std::string>(mime_field.value());
                 curl_mime_data(field, value.data(), value.length());
             }
+            else if (m_client != nullptr && mime_field.m_file_size.has_value())
+            {
+                // The client's file reader thread reads the file ahead of libcurl, the event loop
+                // thread only copies out of its buffers.
+                const auto& path = std::get<std::filesystem::path>(mime_field.value());
+                auto        size = mime_field.m_file_size.value();
+                auto        source =
+                    std::make_shared<impl::file_source>(*m_client->m_file_reader, path, size, m_curl_handle);
+                curl_mime_data_cb(
+                    field,
+                    static_cast<curl_off_t>(size),
+                    impl::file_source::curl_read,
+                    impl::file_source::curl_seek,
+                    nullptr,
+                    source.get());
+
+                // Send the same part headers curl_mime_filedata() would.
+                auto filename = path.filename().string();
+                curl_mime_filename(field, filename.c_str());
+                curl_mime_type(field, impl::mime_type_for_filename(filename));
+
+                source->start();
+                m_file_sources.push_back(std::move(source));
+            }
             else
             {
                 curl_mime_filename(field, mime_field.name().data());
@@ -361,16 +597,15 @@ auto executor::prepare() -> void
         curl_easy_setopt(m_curl_handle, CURLOPT_MIMEPOST, m_mime_handle);
     }
 
-    if (m_request->m_on_transfer_progress_handler != nullptr)
+    const auto& extensions = m_request->extensions_or_empty();
+
+    if (extensions.transfer_progress_handler != nullptr)
     {
         curl_easy_setopt(m_curl_handle, CURLOPT_XFERINFOFUNCTION, curl_xfer_info);
         curl_easy_setopt(m_curl_handle, CURLOPT_XFERINFODATA, this);
         curl_easy_setopt(m_curl_handle, CURLOPT_NOPROGRESS, 0L);
     }
-    else
-    {
-        curl_easy_setopt(m_curl_handle, CURLOPT_NOPROGRESS, 1L);
-    }
+    // else libcurl default, no progress callbacks.
 
     if (const auto& timeout = m_request->happy_eyeballs_timeout(); timeout.has_value())
     {
@@ -385,7 +620,7 @@ auto executor::prepare() -> void
 
     // Set debug info if the user added a debug info functor callback
     // https://curl.se/libcurl/c/CURLOPT_DEBUGFUNCTION.html
-    if (m_request->m_debug_info_handler != nullptr)
+    if (extensions.debug_info_handler != nullptr)
     {
         curl_easy_setopt(m_curl_handle, CURLOPT_VERBOSE, 1L);
         curl_easy_setopt(m_curl_handle, CURLOPT_DEBUGFUNCTION, curl_debug_info_callback);
@@ -393,6 +628,39 @@ auto executor::prepare() -> void
     }
 }
 
+auto executor::join_accept_encodings(const std::vector<std::string>& encodings) -> std::string
+{
+    // From the CURL docs (https://curl.haxx.se/libcurl/c/CURLOPT_ACCEPT_ENCODING.html):
+    // 'To aid applications not having to bother about what specific algorithms this particular
+    // libcurl build supports, libcurl allows a zero-length string to be set ("") to ask for an
+    // Accept-Encoding: header to be used that contains all built-in supported encodings.'
+    // An empty list therefore joins into exactly that empty string.
+    std::size_t length{0};
+    for (const auto& e : encodings)
+    {
+        length += e.length() + 2; // for ", "
+    }
+
+    std::string joined{};
+    joined.reserve(length);
+
+    bool first{true};
+    for (const auto& e : encodings)
+    {
+        if (first)
+        {
+            first = false;
+        }
+        else
+        {
+            joined.append(", ");
+        }
+        joined.append(e);
+    }
+
+    return joined;
+}
+
 auto executor::copy_curl_to_response() -> void
 {
     long http_response_code = 0;
@@ -430,6 +698,75 @@ auto executor::set_timesup_response(std::chrono::milliseconds total_time) -> voi
     m_response.m_num_redirects = 0;
 }
 
+auto executor::inflight(uint64_t now) const -> inflight_request
+{
+    inflight_request info{};
+    info.age      = std::chrono::milliseconds{static_cast<int64_t>(now - m_started_at)};
+    info.orphaned = m_orphaned;
+    if (m_deadline.has_value())
+    {
+        info.time_left = std::chrono::milliseconds{static_cast<int64_t>(m_deadline.value() - now)};
+    }
+
+    if (m_request_async != nullptr)
+    {
+        info.url = m_request->url();
+    }
+    else
+    {
+        // An orphan's request was already handed back to the user.
+        char* effective_url{nullptr};
+        curl_easy_getinfo(m_curl_handle, CURLINFO_EFFECTIVE_URL, &effective_url);
+        if (effective_url != nullptr)
+        {
+            info.url = effective_url;
+        }
+    }
+
+    curl_off_t sent{0};
+    curl_off_t received{0};
+    curl_easy_getinfo(m_curl_handle, CURLINFO_SIZE_UPLOAD_T, &sent);
+    curl_easy_getinfo(m_curl_handle, CURLINFO_SIZE_DOWNLOAD_T, &received);
+    info.bytes_sent     = static_cast<uint64_t>(sent);
+    info.bytes_received = static_cast<uint64_t>(received);
+
+    // libcurl records the time each step finished, a step that has not finished yet reads as zero.
+    curl_off_t name_lookup{0};
+    curl_off_t connect{0};
+    curl_off_t app_connect{0};
+    curl_off_t pre_transfer{0};
+    curl_off_t start_transfer{0};
+    curl_easy_getinfo(m_curl_handle, CURLINFO_NAMELOOKUP_TIME_T, &name_lookup);
+    curl_easy_getinfo(m_curl_handle, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(m_curl_handle, CURLINFO_APPCONNECT_TIME_T, &app_connect);
+    curl_easy_getinfo(m_curl_handle, CURLINFO_PRETRANSFER_TIME_T, &pre_transfer);
+    curl_easy_getinfo(m_curl_handle, CURLINFO_STARTTRANSFER_TIME_T, &start_transfer);
+
+    if (start_transfer > 0)
+    {
+        info.phase = inflight_phase::receiving;
+    }
+    else if (pre_transfer > 0 || app_connect > 0)
+    {
+        info.phase = inflight_phase::waiting_for_first_byte;
+    }
+    else if (connect > 0)
+    {
+        // Only a TLS connection has anything left to do between connecting and sending the request.
+        info.phase = inflight_phase::tls_handshake;
+    }
+    else if (name_lookup > 0)
+    {
+        info.phase = inflight_phase::connecting;
+    }
+    else
+    {
+        info.phase = inflight_phase::resolving;
+    }
+
+    return info;
+}
+
 auto executor::reset() -> void
 {
     if (m_mime_handle != nullptr)
@@ -438,6 +775,15 @@ auto executor::reset() -> void
         m_mime_handle = nullptr;
     }
 
+    m_mime_body.reset();
+
+    // The file reader may still hold these, stop it from resuming this handle for the next request.
+    for (auto& source : m_file_sources)
+    {
+        source->cancel();
+    }
+    m_file_sources.clear();
+
     if (m_curl_request_headers != nullptr)
     {
         curl_slist_free_all(m_curl_request_headers);
@@ -450,6 +796,12 @@ auto executor::reset() -> void
         m_curl_resolve_hosts = nullptr;
     }
 
+    if (m_curl_connect_to != nullptr)
+    {
+        curl_slist_free_all(m_curl_connect_to);
+        m_curl_connect_to = nullptr;
+    }
+
     // Regardless of sync/async all three pointers get reset to nullptr.
     m_request_sync  = nullptr;
     m_request_async = nullptr;
@@ -457,7 +809,22 @@ auto executor::reset() -> void
 
     m_timeout_iterator.reset();
     m_on_complete_handler_processed = false;
-    m_response                      = response{};
+    m_orphaned                      = false;
+    m_connected                     = false;
+    m_source_address                = std::nullopt;
+    m_started_at                    = 0;
+    m_deadline                      = std::nullopt;
+    m_host                          = nullptr;
+    m_role                          = role::user;
+    m_tenant                        = nullptr;
+
+    // The response was moved out to the user, its now empty containers still reference the memory
+    // resource it was using which the user may release at any time.
+    if (m_response.memory_resource() != std::pmr::get_default_resource())
+    {
+        m_response.memory_resource(nullptr);
+    }
+    m_response = response{};
 
     curl_easy_setopt(m_curl_handle, CURLOPT_SHARE, nullptr);
     m_curl_share_handle = nullptr;
@@ -525,7 +892,7 @@ auto curl_write_header(char* buffer, size_t size, size_t nitems, void* user_ptr)
         data_view.remove_suffix(rm_size);
     }
 
-    response.m_headers.emplace_back(std::string{data_view.data(), data_view.length()});
+    response.m_headers.emplace_back(data_view);
 
     return data_length; // return original size for curl to continue processing
 }
@@ -553,9 +920,9 @@ auto curl_xfer_info(
 {
     const auto* executor_ptr = static_cast<const executor*>(clientp);
 
-    if (executor_ptr != nullptr && executor_ptr->m_request->m_on_transfer_progress_handler != nullptr)
+    if (executor_ptr != nullptr && executor_ptr->m_request->extensions_or_empty().transfer_progress_handler != nullptr)
     {
-        if (executor_ptr->m_request->m_on_transfer_progress_handler(
+        if (executor_ptr->m_request->extensions_or_empty().transfer_progress_handler(
                 *executor_ptr->m_request,
                 download_total_bytes,
                 download_now_bytes,
@@ -579,9 +946,9 @@ auto curl_debug_info_callback(CURL* /*handle*/, curl_infotype type, char* data,
 {
     const auto* executor_ptr = static_cast<const executor*>(userptr);
 
-    if (executor_ptr != nullptr && executor_ptr->m_request->m_debug_info_handler != nullptr)
+    if (executor_ptr != nullptr && executor_ptr->m_request->extensions_or_empty().debug_info_handler != nullptr)
     {
-        executor_ptr->m_request->m_debug_info_handler(
+        executor_ptr->m_request->extensions_or_empty().debug_info_handler(
             *executor_ptr->m_request, static_cast<debug_info_type>(type), std::string_view{data, size});
     }
 
@@ -589,4 +956,25 @@ auto curl_debug_info_callback(CURL* /*handle*/, curl_infotype type, char* data,
     return 0;
 }
 
+static auto curl_discard(char* /*buffer*/, size_t size, size_t nitems, void* /*user_ptr*/) -> size_t
+{
+    return size * nitems;
+}
+
+static auto curl_sockopt_callback(void* clientp, curl_socket_t /*curlfd*/, curlsocktype /*purpose*/) -> int
+{
+    ++static_cast<impl::host_demand*>(clientp)->open_connections;
+    return CURL_SOCKOPT_OK;
+}
+
+static auto curl_close_socket_callback(void* clientp, curl_socket_t item) -> int
+{
+    auto* host = static_cast<impl::host_demand*>(clientp);
+    if (host->open_connections > 0)
+    {
+        --host->open_connections;
+    }
+    return ::close(item);
+}
+
 } // namespace lift
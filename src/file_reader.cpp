@@ -0,0 +1,279 @@
+#include "lift/impl/file_reader.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+namespace lift::impl
+{
+file_source::file_source(file_reader& reader, std::filesystem::path path, uint64_t size, CURL* curl_handle)
+    : m_reader(reader),
+      m_path(std::move(path)),
+      m_size(size),
+      m_curl_handle(curl_handle)
+{
+}
+
+file_source::~file_source()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+}
+
+auto file_source::start() -> void
+{
+    std::lock_guard<std::mutex> guard{m_mutex};
+    schedule_locked();
+}
+
+auto file_source::cancel() -> void
+{
+    m_curl_handle = nullptr;
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+    m_cancelled = true;
+    m_buffers.clear();
+}
+
+auto file_source::curl_read(char* buffer, size_t size, size_t nitems, void* arg) -> size_t
+{
+    auto* source = static_cast<file_source*>(arg);
+    auto  length = size * nitems;
+
+    std::lock_guard<std::mutex> guard{source->m_mutex};
+    if (source->m_failed)
+    {
+        return CURL_READFUNC_ABORT;
+    }
+
+    std::size_t copied{0};
+    while (copied < length && !source->m_buffers.empty())
+    {
+        auto& front = source->m_buffers.front();
+        auto  count = std::min(length - copied, front.size() - source->m_front_offset);
+        std::memcpy(buffer + copied, front.data() + source->m_front_offset, count);
+        copied += count;
+        source->m_front_offset += count;
+
+        if (source->m_front_offset == front.size())
+        {
+            source->m_buffers.pop_front();
+            source->m_front_offset = 0;
+        }
+    }
+
+    if (copied == 0)
+    {
+        if (source->m_read_offset >= source->m_size)
+        {
+            return 0;
+        }
+
+        // Nothing is buffered yet, the file_reader resumes the transfer once there is.
+        source->m_paused = true;
+        source->schedule_locked();
+        return CURL_READFUNC_PAUSE;
+    }
+
+    source->schedule_locked();
+    return copied;
+}
+
+auto file_source::curl_seek(void* arg, curl_off_t offset, int origin) -> int
+{
+    auto* source = static_cast<file_source*>(arg);
+
+    std::lock_guard<std::mutex> guard{source->m_mutex};
+    if (origin != SEEK_SET || offset < 0 || static_cast<uint64_t>(offset) > source->m_size)
+    {
+        return CURL_SEEKFUNC_CANTSEEK;
+    }
+
+    ++source->m_generation;
+    source->m_buffers.clear();
+    source->m_front_offset = 0;
+    source->m_read_offset  = static_cast<uint64_t>(offset);
+    source->schedule_locked();
+    return CURL_SEEKFUNC_OK;
+}
+
+auto file_source::fill() -> bool
+{
+    uint64_t offset{0};
+    uint64_t generation{0};
+    uint64_t length{0};
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        if (m_cancelled)
+        {
+            m_read_queued = false;
+            return false;
+        }
+
+        offset     = m_read_offset;
+        generation = m_generation;
+        length     = std::min<uint64_t>(chunk_size, m_size - offset);
+    }
+
+    if (m_fd < 0)
+    {
+        m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+
+    std::string buffer(length, '\0');
+    uint64_t    total{0};
+    while (m_fd >= 0 && total < length)
+    {
+        auto count = ::pread(m_fd, buffer.data() + total, length - total, static_cast<off_t>(offset + total));
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            break;
+        }
+        total += static_cast<uint64_t>(count);
+    }
+
+    bool wake{false};
+    bool more{false};
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        if (generation != m_generation)
+        {
+            // libcurl seeked while this read was in progress, read again from the new position.
+            return !m_cancelled;
+        }
+
+        if (total == length)
+        {
+            m_buffers.push_back(std::move(buffer));
+            m_read_offset += length;
+        }
+        else
+        {
+            // The file could not be opened or is shorter than when the request was built.
+            m_failed = true;
+        }
+
+        wake     = m_paused && !m_cancelled;
+        m_paused = false;
+
+        more          = !m_failed && !m_cancelled && m_read_offset < m_size && m_buffers.size() < read_ahead;
+        m_read_queued = more;
+    }
+
+    if (wake)
+    {
+        m_reader.ready(shared_from_this());
+    }
+
+    return more;
+}
+
+auto file_source::schedule_locked() -> void
+{
+    if (m_read_queued || m_cancelled || m_failed || m_read_offset >= m_size || m_buffers.size() >= read_ahead)
+    {
+        return;
+    }
+
+    m_read_queued = true;
+    m_reader.enqueue(shared_from_this());
+}
+
+file_reader::file_reader(on_ready_type on_ready, void* user_data) : m_on_ready(on_ready), m_user_data(user_data)
+{
+}
+
+file_reader::~file_reader()
+{
+    stop();
+}
+
+auto file_reader::enqueue(std::shared_ptr<file_source> source) -> void
+{
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        if (m_stopping)
+        {
+            return;
+        }
+
+        if (!m_thread.joinable())
+        {
+            m_thread = std::thread{[this] { run(); }};
+        }
+        m_queue.push_back(std::move(source));
+    }
+    m_cv.notify_one();
+}
+
+auto file_reader::take_ready() -> std::vector<std::shared_ptr<file_source>>
+{
+    std::vector<std::shared_ptr<file_source>> sources{};
+    std::lock_guard<std::mutex>               guard{m_mutex};
+    sources.swap(m_ready);
+    return sources;
+}
+
+auto file_reader::ready(std::shared_ptr<file_source> source) -> void
+{
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        m_ready.push_back(std::move(source));
+    }
+    m_on_ready(m_user_data);
+}
+
+auto file_reader::stop() -> void
+{
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        m_stopping = true;
+    }
+    m_cv.notify_one();
+
+    if (m_thread.joinable())
+    {
+        m_thread.join();
+    }
+
+    std::lock_guard<std::mutex> guard{m_mutex};
+    m_queue.clear();
+    m_ready.clear();
+}
+
+auto file_reader::run() -> void
+{
+    while (true)
+    {
+        std::shared_ptr<file_source> source{nullptr};
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            m_cv.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+            if (m_stopping)
+            {
+                return;
+            }
+            source = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        // One buffer per turn so a single large file cannot starve the others.
+        if (source->fill())
+        {
+            std::lock_guard<std::mutex> guard{m_mutex};
+            m_queue.push_back(std::move(source));
+        }
+    }
+}
+
+} // namespace lift::impl
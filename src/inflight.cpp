@@ -0,0 +1,36 @@
+#include "lift/inflight.hpp"
+
+namespace lift
+{
+using namespace std::string_literals;
+
+static const std::string inflight_phase_queued                 = "queued"s;
+static const std::string inflight_phase_resolving              = "resolving"s;
+static const std::string inflight_phase_connecting             = "connecting"s;
+static const std::string inflight_phase_tls_handshake          = "tls_handshake"s;
+static const std::string inflight_phase_waiting_for_first_byte = "waiting_for_first_byte"s;
+static const std::string inflight_phase_receiving              = "receiving"s;
+static const std::string inflight_phase_unknown                = "unknown"s;
+
+auto to_string(inflight_phase phase) -> const std::string&
+{
+    switch (phase)
+    {
+        case inflight_phase::queued:
+            return inflight_phase_queued;
+        case inflight_phase::resolving:
+            return inflight_phase_resolving;
+        case inflight_phase::connecting:
+            return inflight_phase_connecting;
+        case inflight_phase::tls_handshake:
+            return inflight_phase_tls_handshake;
+        case inflight_phase::waiting_for_first_byte:
+            return inflight_phase_waiting_for_first_byte;
+        case inflight_phase::receiving:
+            return inflight_phase_receiving;
+        default:
+            return inflight_phase_unknown;
+    }
+}
+
+} // namespace lift
@@ -0,0 +1,354 @@
+#include "lift/impl/io_uring_poller.hpp"
+
+#if defined(LIFT_IO_URING)
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace lift::impl
+{
+/// Completions for POLL_REMOVE requests carry this user_data and are always ignored.
+static constexpr uint64_t remove_user_data = UINT64_MAX;
+
+static auto io_uring_setup(uint32_t entries, io_uring_params* params) -> int
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static auto io_uring_enter(int ring_fd, uint32_t to_submit, uint32_t flags) -> int
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, 0, flags, nullptr, 0));
+}
+
+static auto encode_user_data(uint32_t index, uint32_t generation) -> uint64_t
+{
+    return (static_cast<uint64_t>(generation) << 32) | index;
+}
+
+template<typename T>
+static auto ring_offset(void* base, uint32_t offset) -> T*
+{
+    return reinterpret_cast<T*>(static_cast<char*>(base) + offset);
+}
+
+auto io_uring_poller::make_unique(uint32_t entries) -> std::unique_ptr<io_uring_poller>
+{
+    std::unique_ptr<io_uring_poller> poller{new io_uring_poller{}};
+    if (!poller->setup(entries))
+    {
+        return nullptr;
+    }
+    return poller;
+}
+
+io_uring_poller::~io_uring_poller()
+{
+    if (m_sqes != nullptr)
+    {
+        munmap(m_sqes, m_sqes_size);
+    }
+    if (m_cq_ring != nullptr && m_cq_ring != m_sq_ring)
+    {
+        munmap(m_cq_ring, m_cq_ring_size);
+    }
+    if (m_sq_ring != nullptr)
+    {
+        munmap(m_sq_ring, m_sq_ring_size);
+    }
+    if (m_ring_fd >= 0)
+    {
+        close(m_ring_fd);
+    }
+}
+
+auto io_uring_poller::setup(uint32_t entries) -> bool
+{
+    io_uring_params params{};
+    params.flags      = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+    params.cq_entries = entries * 4;
+
+    m_ring_fd = io_uring_setup(entries, &params);
+    if (m_ring_fd < 0)
+    {
+        m_ring_fd = -1;
+        return false;
+    }
+
+    m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+    m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+        m_sq_ring_size = std::max(m_sq_ring_size, m_cq_ring_size);
+        m_cq_ring_size = m_sq_ring_size;
+    }
+
+    m_sq_ring = mmap(
+        nullptr, m_sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQ_RING);
+    if (m_sq_ring == MAP_FAILED)
+    {
+        m_sq_ring = nullptr;
+        return false;
+    }
+
+    if ((params.features & IORING_FEAT_SINGLE_MMAP) != 0)
+    {
+        m_cq_ring = m_sq_ring;
+    }
+    else
+    {
+        m_cq_ring = mmap(
+            nullptr, m_cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_CQ_RING);
+        if (m_cq_ring == MAP_FAILED)
+        {
+            m_cq_ring = nullptr;
+            return false;
+        }
+    }
+
+    m_sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes      = mmap(
+        nullptr, m_sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ring_fd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED)
+    {
+        m_sqes = nullptr;
+        return false;
+    }
+
+    m_sq_head       = ring_offset<uint32_t>(m_sq_ring, params.sq_off.head);
+    m_sq_tail       = ring_offset<uint32_t>(m_sq_ring, params.sq_off.tail);
+    m_sq_flags      = ring_offset<uint32_t>(m_sq_ring, params.sq_off.flags);
+    m_sq_array      = ring_offset<uint32_t>(m_sq_ring, params.sq_off.array);
+    m_sq_mask       = *ring_offset<uint32_t>(m_sq_ring, params.sq_off.ring_mask);
+    m_sq_entries    = params.sq_entries;
+    m_sq_local_tail = *m_sq_tail;
+
+    m_cq_head = ring_offset<uint32_t>(m_cq_ring, params.cq_off.head);
+    m_cq_tail = ring_offset<uint32_t>(m_cq_ring, params.cq_off.tail);
+    m_cqes    = ring_offset<void>(m_cq_ring, params.cq_off.cqes);
+    m_cq_mask = *ring_offset<uint32_t>(m_cq_ring, params.cq_off.ring_mask);
+
+    return true;
+}
+
+auto io_uring_poller::watch(void* token, int fd, uint32_t events) -> void*
+{
+    socket_watch* w = static_cast<socket_watch*>(token);
+    if (w == nullptr)
+    {
+        if (m_free_watches.empty())
+        {
+            w        = &m_watches.emplace_back();
+            w->index = static_cast<uint32_t>(m_watches.size() - 1);
+        }
+        else
+        {
+            w = &m_watches[m_free_watches.back()];
+            m_free_watches.pop_back();
+        }
+        w->fd     = fd;
+        w->active = true;
+    }
+    else if (w->armed && w->events == events)
+    {
+        return w;
+    }
+
+    if (w->armed)
+    {
+        queue_poll_remove(*w);
+    }
+
+    // Any completion still in flight for the previous registration is now stale.
+    ++w->generation;
+    w->events = events;
+    queue_poll_add(*w);
+    ++m_updates;
+
+    return w;
+}
+
+auto io_uring_poller::unwatch(void* token) -> void
+{
+    auto* w = static_cast<socket_watch*>(token);
+    if (w == nullptr || !w->active)
+    {
+        return;
+    }
+
+    if (w->armed)
+    {
+        queue_poll_remove(*w);
+    }
+
+    ++w->generation;
+    w->fd     = -1;
+    w->events = 0;
+    w->active = false;
+    m_free_watches.push_back(w->index);
+    ++m_updates;
+}
+
+auto io_uring_poller::submit() -> void
+{
+    // Without this a socket whose re-arm was dropped would never be polled again.  Only as many are
+    // queued as fit, next_sqe() must not flush from within submit().
+    while (!m_rearm_pending.empty() && m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) < m_sq_entries)
+    {
+        auto& w = m_watches[m_rearm_pending.back()];
+        m_rearm_pending.pop_back();
+        if (w.active && !w.armed)
+        {
+            queue_poll_add(w);
+        }
+    }
+
+    // Entries the kernel refused last time (EAGAIN/EBUSY under completion queue backpressure) are
+    // still published but unconsumed, they are retried along with the new ones.
+    auto to_submit = m_sq_local_tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (to_submit == 0)
+    {
+        return;
+    }
+
+    __atomic_store_n(m_sq_tail, m_sq_local_tail, __ATOMIC_RELEASE);
+    ++m_submits;
+
+    while (io_uring_enter(m_ring_fd, to_submit, 0) < 0 && errno == EINTR) {}
+}
+
+auto io_uring_poller::reap(on_ready_type on_ready, void* user_data) -> void
+{
+    auto* cqes = static_cast<io_uring_cqe*>(m_cqes);
+    auto  head = *m_cq_head;
+    auto  tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+
+    while (true)
+    {
+        if (head == tail)
+        {
+            // Completions that did not fit are parked in the kernel and keep the ring readable,
+            // they are only moved into the completion queue by an io_uring_enter.
+            if ((__atomic_load_n(m_sq_flags, __ATOMIC_ACQUIRE) & IORING_SQ_CQ_OVERFLOW) == 0)
+            {
+                break;
+            }
+
+            ++m_submits;
+            while (io_uring_enter(m_ring_fd, 0, IORING_ENTER_GETEVENTS) < 0 && errno == EINTR) {}
+            tail = __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE);
+            if (head == tail)
+            {
+                break;
+            }
+        }
+
+        // Copy out and release the slot before calling back into libcurl.
+        io_uring_cqe cqe = cqes[head & m_cq_mask];
+        ++head;
+        __atomic_store_n(m_cq_head, head, __ATOMIC_RELEASE);
+
+        if (cqe.user_data == remove_user_data)
+        {
+            continue;
+        }
+
+        auto index      = static_cast<uint32_t>(cqe.user_data & 0xFFFFFFFF);
+        auto generation = static_cast<uint32_t>(cqe.user_data >> 32);
+        if (index >= m_watches.size())
+        {
+            continue;
+        }
+
+        auto& w = m_watches[index];
+        if (!w.active || w.generation != generation)
+        {
+            continue;
+        }
+
+        w.armed = false;
+
+        uint32_t events = (cqe.res < 0) ? error : static_cast<uint32_t>(cqe.res);
+        on_ready(user_data, w.fd, events);
+
+        // Re-arm unless the poll itself failed or libcurl changed or removed its interest while
+        // handling the event.
+        if (cqe.res >= 0 && w.active && w.generation == generation && !w.armed)
+        {
+            queue_poll_add(w);
+        }
+    }
+}
+
+auto io_uring_poller::next_sqe() -> void*
+{
+    auto head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+    if (m_sq_local_tail - head >= m_sq_entries)
+    {
+        // The submission queue is full, flush it early rather than dropping the change.
+        submit();
+        head = __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE);
+        if (m_sq_local_tail - head >= m_sq_entries)
+        {
+            return nullptr;
+        }
+    }
+
+    auto index        = m_sq_local_tail & m_sq_mask;
+    m_sq_array[index] = index;
+    ++m_sq_local_tail;
+
+    auto* sqe = static_cast<io_uring_sqe*>(m_sqes) + index;
+    std::memset(sqe, 0, sizeof(io_uring_sqe));
+    return sqe;
+}
+
+auto io_uring_poller::queue_poll_add(socket_watch& w) -> void
+{
+    auto* sqe = static_cast<io_uring_sqe*>(next_sqe());
+    if (sqe == nullptr)
+    {
+        // Still full after the early submit, submit() queues it once the kernel has made room.
+        m_rearm_pending.push_back(w.index);
+        return;
+    }
+
+    sqe->opcode        = IORING_OP_POLL_ADD;
+    sqe->fd            = w.fd;
+    sqe->poll32_events = w.events;
+    sqe->user_data     = encode_user_data(w.index, w.generation);
+    w.armed            = true;
+}
+
+auto io_uring_poller::queue_poll_remove(socket_watch& w) -> void
+{
+    auto* sqe = static_cast<io_uring_sqe*>(next_sqe());
+    if (sqe == nullptr)
+    {
+        return;
+    }
+
+    sqe->opcode    = IORING_OP_POLL_REMOVE;
+    sqe->fd        = -1;
+    sqe->addr      = encode_user_data(w.index, w.generation);
+    sqe->user_data = remove_user_data;
+    w.armed        = false;
+}
+
+} // namespace lift::impl
+
+#else
+
+namespace lift::impl
+{
+// Without LIFT_IO_URING the client never creates a poller, only the destructor is needed.
+io_uring_poller::~io_uring_poller() = default;
+
+} // namespace lift::impl
+
+#endif
@@ -0,0 +1,209 @@
+#include "lift/impl/mime_body.hpp"
+#include "lift/impl/file_reader.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+namespace lift::impl
+{
+auto mime_type_for_filename(std::string_view filename) -> const char*
+{
+    static constexpr std::pair<std::string_view, const char*> types[] = {
+        {".gif", "image/gif"},
+        {".jpg", "image/jpeg"},
+        {".jpeg", "image/jpeg"},
+        {".png", "image/png"},
+        {".svg", "image/svg+xml"},
+        {".txt", "text/plain"},
+        {".htm", "text/html"},
+        {".html", "text/html"},
+        {".pdf", "application/pdf"},
+        {".xml", "application/xml"}};
+
+    for (const auto& [extension, type] : types)
+    {
+        if (filename.size() >= extension.size() &&
+            std::equal(
+                extension.begin(),
+                extension.end(),
+                filename.end() - static_cast<std::ptrdiff_t>(extension.size()),
+                [](char x, char y)
+                { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); }))
+        {
+            return type;
+        }
+    }
+    return "application/octet-stream";
+}
+
+mime_body::mime_body(std::shared_ptr<const lift::mime_template> mime_template) : m_template(std::move(mime_template))
+{
+    append(m_template->encoded());
+}
+
+mime_body::~mime_body()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+}
+
+auto mime_body::append(std::string_view data) -> void
+{
+    if (!data.empty())
+    {
+        m_segments.push_back(segment{data, nullptr, nullptr, data.size()});
+        m_size += data.size();
+    }
+}
+
+auto mime_body::append(std::string data) -> void
+{
+    append(std::string_view{m_storage.emplace_back(std::move(data))});
+}
+
+auto mime_body::append(std::shared_ptr<file_source> source, uint64_t size) -> void
+{
+    if (size > 0)
+    {
+        m_segments.push_back(segment{{}, std::move(source), nullptr, size});
+        m_size += size;
+    }
+}
+
+auto mime_body::append(const std::filesystem::path& path, uint64_t size) -> void
+{
+    if (size > 0)
+    {
+        m_segments.push_back(segment{{}, nullptr, &path, size});
+        m_size += size;
+    }
+}
+
+auto mime_body::finish() -> void
+{
+    append(std::string_view{m_template->m_trailer});
+}
+
+auto mime_body::curl_read(char* buffer, size_t size, size_t nitems, void* arg) -> size_t
+{
+    auto* body   = static_cast<mime_body*>(arg);
+    auto  length = size * nitems;
+
+    if (body->m_failed)
+    {
+        return CURL_READFUNC_ABORT;
+    }
+
+    std::size_t copied{0};
+    while (copied < length && body->m_index < body->m_segments.size())
+    {
+        auto& seg       = body->m_segments[body->m_index];
+        auto  remaining = std::min<uint64_t>(length - copied, seg.size - body->m_offset);
+        auto  count     = std::size_t{0};
+
+        if (seg.source != nullptr)
+        {
+            // The source may pause the transfer, which must not discard bytes already copied.
+            if (copied > 0)
+            {
+                break;
+            }
+
+            count = file_source::curl_read(buffer, 1, remaining, seg.source.get());
+            if (count == CURL_READFUNC_PAUSE || count == CURL_READFUNC_ABORT)
+            {
+                return count;
+            }
+        }
+        else if (seg.path != nullptr)
+        {
+            if (body->m_fd < 0 || body->m_fd_index != body->m_index)
+            {
+                if (body->m_fd >= 0)
+                {
+                    ::close(body->m_fd);
+                }
+                body->m_fd       = ::open(seg.path->c_str(), O_RDONLY | O_CLOEXEC);
+                body->m_fd_index = body->m_index;
+            }
+
+            ssize_t result{-1};
+            do
+            {
+                result = ::pread(body->m_fd, buffer + copied, remaining, static_cast<off_t>(body->m_offset));
+            } while (result < 0 && errno == EINTR);
+
+            if (result > 0)
+            {
+                count = static_cast<std::size_t>(result);
+            }
+        }
+        else
+        {
+            std::memcpy(buffer + copied, seg.data.data() + body->m_offset, remaining);
+            count = remaining;
+        }
+
+        if (count == 0)
+        {
+            // The file could not be opened or is shorter than when the request was built.
+            body->m_failed = true;
+            return CURL_READFUNC_ABORT;
+        }
+
+        copied += count;
+        body->m_offset += count;
+        if (body->m_offset == seg.size)
+        {
+            ++body->m_index;
+            body->m_offset = 0;
+        }
+    }
+
+    return copied;
+}
+
+auto mime_body::curl_seek(void* arg, curl_off_t offset, int origin) -> int
+{
+    auto* body = static_cast<mime_body*>(arg);
+    if (origin != SEEK_SET || offset < 0 || static_cast<uint64_t>(offset) > body->m_size)
+    {
+        return CURL_SEEKFUNC_CANTSEEK;
+    }
+
+    auto        position = static_cast<uint64_t>(offset);
+    std::size_t index{0};
+    while (index < body->m_segments.size() && position >= body->m_segments[index].size)
+    {
+        position -= body->m_segments[index].size;
+        ++index;
+    }
+
+    // Every file source read since the new position is read again from where it will next be used.
+    auto last = std::min(std::max(index, body->m_index), body->m_segments.size() - 1);
+    for (auto i = index; i < body->m_segments.size() && i <= last; ++i)
+    {
+        auto& source = body->m_segments[i].source;
+        if (source != nullptr &&
+            file_source::curl_seek(source.get(), static_cast<curl_off_t>((i == index) ? position : 0), SEEK_SET) !=
+                CURL_SEEKFUNC_OK)
+        {
+            return CURL_SEEKFUNC_CANTSEEK;
+        }
+    }
+
+    body->m_index  = index;
+    body->m_offset = position;
+    return CURL_SEEKFUNC_OK;
+}
+
+} // namespace lift::impl
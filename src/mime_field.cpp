@@ -12,6 +12,15 @@ mime_field::mime_field(std::string field_name, std::filesystem::path field_filep
     : m_field_name(std::move(field_name)),
       m_field_value(std::move(field_filepath))
 {
+    // Sized here on the caller's thread, a client uploads the file without touching the disk from
+    // its event loop thread.
+    std::error_code ec{};
+    auto            size = std::filesystem::file_size(std::get<std::filesystem::path>(m_field_value), ec);
+    if (!ec)
+    {
+        m_file_size = static_cast<uint64_t>(size);
+    }
+
     // TODO Doesn't seem to work?
     // if (!std::filesystem::exists(field_filepath)) {
     //     throw std::runtime_error("File path doesn't exist.");
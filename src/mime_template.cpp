@@ -0,0 +1,101 @@
+#include "lift/mime_template.hpp"
+#include "lift/impl/mime_body.hpp"
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+namespace lift
+{
+/**
+ * Escapes a part's name or filename the way libcurl does for form-data.
+ */
+static auto escape_disposition_value(std::string_view value) -> std::string
+{
+    std::string escaped{};
+    escaped.reserve(value.size());
+    for (auto c : value)
+    {
+        switch (c)
+        {
+            case '"':
+                escaped.append("%22");
+                break;
+            case '\r':
+                escaped.append("%0D");
+                break;
+            case '\n':
+                escaped.append("%0A");
+                break;
+            default:
+                escaped.push_back(c);
+                break;
+        }
+    }
+    return escaped;
+}
+
+mime_template::mime_template(std::vector<lift::mime_field> fields, bool content_length)
+    : m_content_length(content_length)
+{
+    static constexpr std::string_view alphabet{"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"};
+
+    std::random_device                         seed{};
+    std::mt19937                               engine{seed()};
+    std::uniform_int_distribution<std::size_t> pick{0, alphabet.size() - 1};
+
+    m_boundary = "------------------------";
+    for (std::size_t i = 0; i < 22; ++i)
+    {
+        m_boundary.push_back(alphabet[pick(engine)]);
+    }
+
+    m_content_type_header = "Content-Type: multipart/form-data; boundary=" + m_boundary;
+    m_trailer             = "--" + m_boundary + "--\r\n";
+
+    for (const auto& field : fields)
+    {
+        m_encoded.append(part_header(field));
+
+        if (std::holds_alternative<std::string>(field.value()))
+        {
+            m_encoded.append(std::get<std::string>(field.value()));
+        }
+        else
+        {
+            const auto&   path = std::get<std::filesystem::path>(field.value());
+            std::ifstream file{path, std::ios::binary};
+            if (!file)
+            {
+                throw std::runtime_error("Cannot read mime_template file part " + path.string());
+            }
+            m_encoded.append(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        }
+
+        m_encoded.append("\r\n");
+    }
+}
+
+auto mime_template::part_header(const lift::mime_field& field) const -> std::string
+{
+    std::string header{};
+    header.append("--").append(m_boundary).append("\r\n");
+    header.append("Content-Disposition: form-data; name=\"").append(escape_disposition_value(field.name()));
+
+    if (std::holds_alternative<std::filesystem::path>(field.value()))
+    {
+        auto filename = std::get<std::filesystem::path>(field.value()).filename().string();
+        header.append("\"; filename=\"").append(escape_disposition_value(filename)).append("\"\r\n");
+        header.append("Content-Type: ").append(impl::mime_type_for_filename(filename)).append("\r\n");
+    }
+    else
+    {
+        header.append("\"\r\n");
+    }
+
+    header.append("\r\n");
+    return header;
+}
+
+} // namespace lift
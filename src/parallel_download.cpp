@@ -0,0 +1,628 @@
+#include "lift/parallel_download.hpp"
+#include "lift/client.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+namespace lift
+{
+file_download_sink::file_download_sink(std::filesystem::path path) : m_path(std::move(path))
+{
+}
+
+file_download_sink::~file_download_sink()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+}
+
+auto file_download_sink::prepare(uint64_t size) -> bool
+{
+    m_fd = ::open(m_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    // Size the file up front so out of order ranges never leave it short.
+    return ::ftruncate(m_fd, static_cast<off_t>(size)) == 0;
+}
+
+auto file_download_sink::resume(uint64_t size) -> bool
+{
+    m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+    {
+        return false;
+    }
+
+    return ::ftruncate(m_fd, static_cast<off_t>(size)) == 0;
+}
+
+auto file_download_sink::read(uint64_t offset, uint64_t length, std::string& out) -> bool
+{
+    out.resize(length);
+    uint64_t total{0};
+    while (total < length)
+    {
+        auto count = ::pread(m_fd, out.data() + total, length - total, static_cast<off_t>(offset + total));
+        if (count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (count <= 0)
+        {
+            return false;
+        }
+        total += static_cast<uint64_t>(count);
+    }
+
+    return true;
+}
+
+auto file_download_sink::write(uint64_t offset, std::string_view data) -> bool
+{
+    while (!data.empty())
+    {
+        auto written = ::pwrite(m_fd, data.data(), data.size(), static_cast<off_t>(offset));
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+
+        data.remove_prefix(static_cast<std::size_t>(written));
+        offset += static_cast<uint64_t>(written);
+    }
+
+    return true;
+}
+
+auto file_download_sink::finish() -> bool
+{
+    auto fd = m_fd;
+    m_fd    = -1;
+    return ::close(fd) == 0;
+}
+
+mmap_download_sink::mmap_download_sink(std::filesystem::path path) : m_path(std::move(path))
+{
+}
+
+mmap_download_sink::~mmap_download_sink()
+{
+    if (m_data != nullptr)
+    {
+        ::munmap(m_data, m_size);
+    }
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+    }
+}
+
+auto mmap_download_sink::prepare(uint64_t size) -> bool
+{
+    return map(size, O_TRUNC);
+}
+
+auto mmap_download_sink::resume(uint64_t size) -> bool
+{
+    return map(size, 0);
+}
+
+auto mmap_download_sink::map(uint64_t size, int flags) -> bool
+{
+    m_fd = ::open(m_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | flags, 0644);
+    if (m_fd < 0 || ::ftruncate(m_fd, static_cast<off_t>(size)) != 0)
+    {
+        return false;
+    }
+
+    // An empty object cannot be mapped, there is nothing to write either.
+    if (size == 0)
+    {
+        return true;
+    }
+
+    auto* data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return false;
+    }
+
+    m_data = static_cast<char*>(data);
+    m_size = size;
+    return true;
+}
+
+auto mmap_download_sink::write(uint64_t offset, std::string_view data) -> bool
+{
+    if (offset > m_size || data.size() > m_size - offset)
+    {
+        return false;
+    }
+
+    std::memcpy(m_data + offset, data.data(), data.size());
+    return true;
+}
+
+auto mmap_download_sink::read(uint64_t offset, uint64_t length, std::string& out) -> bool
+{
+    if (offset > m_size || length > m_size - offset)
+    {
+        return false;
+    }
+
+    out.assign(m_data + offset, length);
+    return true;
+}
+
+auto mmap_download_sink::finish() -> bool
+{
+    bool ok{true};
+    if (m_data != nullptr)
+    {
+        ok     = ::munmap(m_data, m_size) == 0;
+        m_data = nullptr;
+    }
+
+    auto fd = m_fd;
+    m_fd    = -1;
+    return (::close(fd) == 0) && ok;
+}
+
+/**
+ * A single byte range of the object, [offset, offset + length).
+ */
+struct download_range
+{
+    uint64_t offset{0};
+    uint64_t length{0};
+    uint64_t attempts{0};
+};
+
+/**
+ * Completed range requests are handed from the event loop thread back to the downloading thread.
+ * Shared with the callbacks so a download that fails early can return before its outstanding
+ * ranges complete.
+ */
+struct download_completions
+{
+    std::mutex                                    m_mutex{};
+    std::condition_variable                       m_cv{};
+    std::deque<std::pair<std::size_t, response>> m_completed{};
+};
+
+/**
+ * The progress of a download as persisted in its checkpoint file.  The file is a header naming the
+ * object's validator, size and range layout followed by one line per range written to the sink
+ * with the CRC-32 of its bytes.  Lines are only ever appended, a torn last line is ignored.
+ */
+struct download_checkpoint
+{
+    std::string                                    validator{};
+    uint64_t                                       size{0};
+    uint64_t                                       chunk_size{0};
+    std::vector<std::pair<std::size_t, uint32_t>> ranges{};
+};
+
+static constexpr std::string_view checkpoint_magic{"lift_download_checkpoint 1"};
+
+static auto header_names_equal(std::string_view a, std::string_view b) -> bool
+{
+    return std::equal(
+        a.begin(),
+        a.end(),
+        b.begin(),
+        b.end(),
+        [](char x, char y)
+        { return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y)); });
+}
+
+static auto find_header(const response& rep, std::string_view name) -> std::optional<std::string_view>
+{
+    for (const auto& h : rep.headers())
+    {
+        if (header_names_equal(h.name(), name))
+        {
+            return h.value();
+        }
+    }
+    return std::nullopt;
+}
+
+static auto parse_uint(std::string_view value) -> std::optional<uint64_t>
+{
+    uint64_t result{0};
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result);
+    if (ec != std::errc{} || ptr != value.data() + value.size())
+    {
+        return std::nullopt;
+    }
+    return result;
+}
+
+static auto load_checkpoint(const std::filesystem::path& path) -> std::optional<download_checkpoint>
+{
+    std::ifstream file{path};
+    std::string   line{};
+    if (!std::getline(file, line) || line != checkpoint_magic)
+    {
+        return std::nullopt;
+    }
+
+    download_checkpoint checkpoint{};
+    while (std::getline(file, line))
+    {
+        std::string_view view{line};
+        auto             space = view.find(' ');
+        if (space == std::string_view::npos)
+        {
+            continue;
+        }
+
+        auto key   = view.substr(0, space);
+        auto value = view.substr(space + 1);
+        if (key == "validator")
+        {
+            checkpoint.validator = std::string{value};
+        }
+        else if (key == "size")
+        {
+            checkpoint.size = parse_uint(value).value_or(0);
+        }
+        else if (key == "chunk_size")
+        {
+            checkpoint.chunk_size = parse_uint(value).value_or(0);
+        }
+        else if (key == "range")
+        {
+            auto separator = value.find(' ');
+            if (separator == std::string_view::npos)
+            {
+                continue;
+            }
+            auto index = parse_uint(value.substr(0, separator));
+            auto crc   = parse_uint(value.substr(separator + 1));
+            if (index.has_value() && crc.has_value())
+            {
+                checkpoint.ranges.emplace_back(index.value(), static_cast<uint32_t>(crc.value()));
+            }
+        }
+    }
+
+    if (checkpoint.validator.empty() || checkpoint.chunk_size == 0)
+    {
+        return std::nullopt;
+    }
+    return checkpoint;
+}
+
+static auto checksum(std::string_view data) -> uint32_t
+{
+    uLong crc = ::crc32(0L, Z_NULL, 0);
+    while (!data.empty())
+    {
+        auto length = static_cast<uInt>(std::min<std::size_t>(data.size(), UINT32_MAX));
+        crc         = ::crc32(crc, reinterpret_cast<const Bytef*>(data.data()), length);
+        data.remove_prefix(length);
+    }
+    return static_cast<uint32_t>(crc);
+}
+
+/**
+ * Ranges are only retried for failures that can be transient.
+ */
+static auto retryable(const response& rep) -> bool
+{
+    if (rep.lift_status() != lift_status::success)
+    {
+        return true;
+    }
+
+    auto code = static_cast<uint32_t>(rep.status_code());
+    return code >= 500 || rep.status_code() == http::status_code::http_408_request_timeout ||
+           rep.status_code() == http::status_code::http_429_too_many_requests;
+}
+
+/**
+ * @return True if `rep` is a 206 for exactly `range` of an object of `size` bytes.
+ */
+static auto matches_range(const response& rep, const download_range& range, uint64_t size) -> bool
+{
+    if (rep.status_code() != http::status_code::http_206_partial_content || rep.data().size() != range.length)
+    {
+        return false;
+    }
+
+    auto expected = "bytes " + std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1) +
+                    "/" + std::to_string(size);
+    auto content_range = find_header(rep, "Content-Range");
+    return content_range.has_value() && content_range.value() == expected;
+}
+
+static auto make_request(
+    const std::string& url, const parallel_download_options& options, const std::optional<std::string>& if_range)
+    -> request_ptr
+{
+    auto request_ptr = std::make_unique<request>(url, options.timeout);
+    for (const auto& h : options.headers)
+    {
+        request_ptr->header(h.name(), h.value());
+    }
+    if (if_range.has_value())
+    {
+        request_ptr->header("If-Range", if_range.value());
+    }
+    return request_ptr;
+}
+
+static auto elapsed_since(std::chrono::steady_clock::time_point start) -> std::chrono::milliseconds
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+}
+
+/**
+ * Downloads the whole object with a single request, for servers without byte range support.
+ */
+static auto download_whole(
+    client& c, const std::string& url, download_sink& sink, const parallel_download_options& options)
+    -> parallel_download_result
+{
+    parallel_download_result result{};
+
+    auto [req, rep]    = c.start_request(make_request(url, options, std::nullopt)).get();
+    result.lift_status = rep.lift_status();
+    result.status_code = rep.status_code();
+    if (rep.lift_status() != lift_status::success || rep.status_code() != http::status_code::http_200_ok)
+    {
+        return result;
+    }
+
+    result.size = rep.data().size();
+    if (!sink.prepare(result.size) || !sink.write(0, rep.data()) || !sink.finish())
+    {
+        result.lift_status = lift_status::error;
+    }
+    return result;
+}
+
+auto parallel_download(std::string url, download_sink& sink, parallel_download_options options)
+    -> parallel_download_result
+{
+    auto start = std::chrono::steady_clock::now();
+
+    std::unique_ptr<client> owned_client{nullptr};
+    if (options.client == nullptr)
+    {
+        owned_client   = std::make_unique<client>();
+        options.client = owned_client.get();
+    }
+    auto& c = *options.client;
+
+    parallel_download_result result{};
+
+    auto probe_ptr = make_request(url, options, std::nullopt);
+    probe_ptr->method(http::method::head);
+    auto [probe_req, probe] = c.start_request(std::move(probe_ptr)).get();
+    result.lift_status      = probe.lift_status();
+    result.status_code      = probe.status_code();
+    if (probe.lift_status() != lift_status::success || probe.status_code() != http::status_code::http_200_ok)
+    {
+        result.total_time = elapsed_since(start);
+        return result;
+    }
+
+    auto accept_ranges  = find_header(probe, "Accept-Ranges");
+    auto content_length = find_header(probe, "Content-Length");
+    auto size           = content_length.has_value() ? parse_uint(content_length.value()) : std::nullopt;
+
+    options.chunks = std::max<uint64_t>(options.chunks, 1);
+    if (!accept_ranges.has_value() || accept_ranges.value() != "bytes" || !size.has_value() ||
+        size.value() < options.min_chunk_size * 2 || (options.chunks == 1 && !options.max_chunk_size.has_value()))
+    {
+        result            = download_whole(c, url, sink, options);
+        result.total_time = elapsed_since(start);
+        return result;
+    }
+
+    // Every range must come from the same version of the object, weak validators cannot be used.
+    std::optional<std::string> if_range{std::nullopt};
+    if (auto etag = find_header(probe, "ETag"); etag.has_value() && etag.value().substr(0, 2) != "W/")
+    {
+        if_range = std::string{etag.value()};
+    }
+    else if (auto last_modified = find_header(probe, "Last-Modified"); last_modified.has_value())
+    {
+        if_range = std::string{last_modified.value()};
+    }
+
+    result.size   = size.value();
+    result.ranged = true;
+
+    auto chunk_size = std::max<uint64_t>((result.size + options.chunks - 1) / options.chunks, options.min_chunk_size);
+    if (options.max_chunk_size.has_value())
+    {
+        chunk_size = std::max<uint64_t>(std::min(chunk_size, options.max_chunk_size.value()), 1);
+    }
+
+    // Progress can only be reused if the object is provably unchanged, without a validator there is
+    // nothing to checkpoint.
+    bool                               checkpointing = options.checkpoint.has_value() && if_range.has_value();
+    std::optional<download_checkpoint> saved{std::nullopt};
+    if (checkpointing)
+    {
+        saved = load_checkpoint(options.checkpoint.value());
+        if (saved.has_value() && (saved.value().validator != if_range.value() || saved.value().size != result.size))
+        {
+            saved = std::nullopt;
+        }
+    }
+
+    // A resumed download keeps the range layout it was started with.
+    if (saved.has_value())
+    {
+        chunk_size = saved.value().chunk_size;
+    }
+
+    std::vector<download_range> ranges{};
+    for (uint64_t offset = 0; offset < result.size; offset += chunk_size)
+    {
+        ranges.push_back(download_range{offset, std::min(chunk_size, result.size - offset), 0});
+    }
+    result.ranges = ranges.size();
+
+    std::vector<bool>                             written(ranges.size(), false);
+    std::vector<std::pair<std::size_t, uint32_t>> verified{};
+    if (saved.has_value() && sink.resume(result.size))
+    {
+        // Data the checkpoint claims was written may never have reached the disk, verify it first.
+        std::string data{};
+        for (const auto& [index, crc] : saved.value().ranges)
+        {
+            if (index < ranges.size() && !written[index] &&
+                sink.read(ranges[index].offset, ranges[index].length, data) && checksum(data) == crc)
+            {
+                written[index] = true;
+                verified.emplace_back(index, crc);
+                result.resumed_bytes += ranges[index].length;
+            }
+        }
+    }
+    else if (!sink.prepare(result.size))
+    {
+        result.lift_status = lift_status::error;
+        result.total_time  = elapsed_since(start);
+        return result;
+    }
+
+    // Rewrite the checkpoint with only the verified ranges, completed ranges are appended to it.
+    std::ofstream checkpoint_file{};
+    if (checkpointing)
+    {
+        checkpoint_file.open(options.checkpoint.value(), std::ios::trunc);
+        checkpoint_file << checkpoint_magic << "\nvalidator " << if_range.value() << "\nsize " << result.size
+                        << "\nchunk_size " << chunk_size << "\n";
+        for (const auto& [index, crc] : verified)
+        {
+            checkpoint_file << "range " << index << " " << crc << "\n";
+        }
+        checkpoint_file.flush();
+    }
+
+    std::vector<std::size_t> pending{};
+    for (std::size_t index = 0; index < ranges.size(); ++index)
+    {
+        if (!written[index])
+        {
+            pending.push_back(index);
+        }
+    }
+
+    auto completions = std::make_shared<download_completions>();
+
+    auto issue = [&](std::size_t index) -> void
+    {
+        auto& range     = ranges[index];
+        auto  range_ptr = make_request(url, options, if_range);
+        range_ptr->header(
+            "Range",
+            "bytes=" + std::to_string(range.offset) + "-" + std::to_string(range.offset + range.length - 1));
+        ++range.attempts;
+
+        c.start_request(
+            std::move(range_ptr),
+            [completions, index](lift::request_ptr, response rep) -> void
+            {
+                {
+                    std::lock_guard<std::mutex> guard{completions->m_mutex};
+                    completions->m_completed.emplace_back(index, std::move(rep));
+                }
+                completions->m_cv.notify_one();
+            });
+    };
+
+    std::size_t next{0};
+    for (; next < pending.size() && next < options.chunks; ++next)
+    {
+        issue(pending[next]);
+    }
+
+    uint64_t remaining = pending.size();
+    while (remaining > 0)
+    {
+        std::unique_lock<std::mutex> lock{completions->m_mutex};
+        completions->m_cv.wait(lock, [&]() { return !completions->m_completed.empty(); });
+        auto [index, rep] = std::move(completions->m_completed.front());
+        completions->m_completed.pop_front();
+        lock.unlock();
+
+        auto& range = ranges[index];
+        if (!matches_range(rep, range, result.size))
+        {
+            if (retryable(rep) && range.attempts <= options.max_retries)
+            {
+                ++result.retries;
+                issue(index);
+                continue;
+            }
+
+            // Outstanding ranges complete into the shared completions and are discarded.
+            result.lift_status = (rep.lift_status() == lift_status::success) ? lift_status::error : rep.lift_status();
+            result.status_code = rep.status_code();
+            result.total_time  = elapsed_since(start);
+            return result;
+        }
+
+        if (!sink.write(range.offset, rep.data()))
+        {
+            result.lift_status = lift_status::error;
+            result.total_time  = elapsed_since(start);
+            return result;
+        }
+
+        if (checkpointing)
+        {
+            checkpoint_file << "range " << index << " " << checksum(rep.data()) << "\n";
+            checkpoint_file.flush();
+        }
+
+        --remaining;
+        if (next < pending.size())
+        {
+            issue(pending[next]);
+            ++next;
+        }
+    }
+
+    result.lift_status = sink.finish() ? lift_status::success : lift_status::error;
+    if (checkpointing && result.lift_status == lift_status::success)
+    {
+        checkpoint_file.close();
+        std::error_code ec{};
+        std::filesystem::remove(options.checkpoint.value(), ec);
+    }
+    result.total_time  = elapsed_since(start);
+    return result;
+}
+
+} // namespace lift
@@ -55,9 +55,17 @@ auto to_string(debug_info_type type) -> const std::string&
 }
 
 request::request(std::string url, std::optional<std::chrono::milliseconds> timeout)
+    : m_timeout(std::move(timeout))
+{
+    m_url.assign(std::move(url));
+}
+
+request::request(
+    std::string url, std::optional<std::chrono::milliseconds> timeout, std::pmr::memory_resource* resource)
     : m_timeout(std::move(timeout)),
-      m_url(std::move(url))
+      m_memory_resource(resource)
 {
+    m_url.assign(std::move(url));
 }
 
 auto request::perform(share_ptr share_ptr) -> response
@@ -66,15 +74,36 @@ auto request::perform(share_ptr share_ptr) -> response
     return exe.perform();
 }
 
+auto request::clone() const -> std::unique_ptr<request>
+{
+    auto copy = std::make_unique<request>(*this);
+    // Copying moved the completion handler into the copy, it belongs to this request.
+    std::swap(m_on_complete_handler.m_object, copy->m_on_complete_handler.m_object);
+    copy->m_on_complete_handler.m_object = async_handlers_type{std::monostate{}};
+    return copy;
+}
+
 auto request::transfer_progress_handler(std::optional<transfer_progress_handler_type> transfer_progress_handler) -> void
 {
     if (transfer_progress_handler.has_value() && transfer_progress_handler.value())
     {
-        m_on_transfer_progress_handler = std::move(transfer_progress_handler.value());
+        mutable_extensions().transfer_progress_handler = std::move(transfer_progress_handler.value());
     }
-    else
+    else if (extensions_or_empty().transfer_progress_handler != nullptr)
+    {
+        mutable_extensions().transfer_progress_handler = nullptr;
+    }
+}
+
+auto request::debug_info_handler(debug_info_callback_type callback_functor) -> void
+{
+    if (callback_functor != nullptr)
+    {
+        mutable_extensions().debug_info_handler = std::move(callback_functor);
+    }
+    else if (extensions_or_empty().debug_info_handler != nullptr)
     {
-        m_on_transfer_progress_handler = nullptr;
+        mutable_extensions().debug_info_handler = nullptr;
     }
 }
 
@@ -101,9 +130,41 @@ auto request::follow_redirects(bool follow_redirects, std::optional<uint64_t> ma
     }
 }
 
+auto request::extensions_or_empty() const -> const extensions&
+{
+    return m_extensions.value_or_empty();
+}
+
+auto request::mutable_extensions() -> extensions&
+{
+    return m_extensions.mutate();
+}
+
+auto request::memory_resource_or_default() const -> std::pmr::memory_resource*
+{
+    return (m_memory_resource != nullptr) ? m_memory_resource : std::pmr::get_default_resource();
+}
+
+auto request::detach_memory_resource() -> void
+{
+    if (m_memory_resource != nullptr)
+    {
+        // Containers bound to a resource are never shared with a copy, mutate() does not copy them.
+        if (m_request_headers.m_ptr != nullptr)
+        {
+            impl::rebind_memory_resource(m_request_headers.mutate(), std::pmr::get_default_resource());
+        }
+        if (m_mime_fields.m_ptr != nullptr)
+        {
+            impl::rebind_memory_resource(m_mime_fields.mutate(), std::pmr::get_default_resource());
+        }
+        m_memory_resource = nullptr;
+    }
+}
+
 auto request::header(std::string_view name, std::string_view value) -> void
 {
-    m_request_headers.emplace_back(name, value);
+    m_request_headers.mutate(memory_resource_or_default()).emplace_back(name, value);
 }
 
 auto request::data(std::string data) -> void
@@ -114,7 +175,7 @@ auto request::data(std::string data) -> void
     }
 
     m_request_data_set = true;
-    m_request_data     = std::move(data);
+    m_request_data.assign(std::move(data));
     // Attempt to switch to a smarter verb if it isn't already set.
     if (m_method != http::method::post && m_method != http::method::put)
     {
@@ -130,7 +191,25 @@ auto request::mime_field(lift::mime_field mf) -> void
     }
 
     m_mime_fields_set = true;
-    m_mime_fields.emplace_back(std::move(mf));
+    m_mime_fields.mutate(memory_resource_or_default()).emplace_back(std::move(mf));
+}
+
+auto request::mime_template(std::shared_ptr<const lift::mime_template> mime_template) -> void
+{
+    if (m_request_data_set)
+    {
+        throw std::logic_error("Cannot use a Mime Template on request after using POST request data.");
+    }
+
+    if (mime_template != nullptr)
+    {
+        m_mime_fields_set                  = true;
+        mutable_extensions().mime_template = std::move(mime_template);
+    }
+    else if (extensions_or_empty().mime_template != nullptr)
+    {
+        mutable_extensions().mime_template = nullptr;
+    }
 }
 
 } // namespace lift
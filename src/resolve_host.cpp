@@ -6,7 +6,8 @@ resolve_host::resolve_host(std::string resolve_host, uint16_t resolve_port, std:
     : m_resolve_host(std::move(resolve_host)),
       m_resolve_port(resolve_port),
       m_resolved_ip_addr(std::move(resolved_ip_addr)),
-      m_curl_formatted()
+      m_curl_formatted(),
+      m_curl_formatted_connect_to()
 {
     constexpr size_t RESERVE_BYTES_PORT = 16; // ports are 2^16 which is maximum 5 bytes, this should do.
 
@@ -17,6 +18,18 @@ resolve_host::resolve_host(std::string resolve_host, uint16_t resolve_port, std:
     m_curl_formatted.append(std::to_string(m_resolve_port));
     m_curl_formatted.append(":");
     m_curl_formatted.append(m_resolved_ip_addr);
+
+    // Connect-to needs IPv6 addresses in brackets.
+    auto bracket = m_resolved_ip_addr.find(':') != std::string::npos && m_resolved_ip_addr.front() != '[';
+
+    m_curl_formatted_connect_to.reserve(m_curl_formatted.length() + RESERVE_BYTES_PORT);
+    m_curl_formatted_connect_to.append(m_resolve_host);
+    m_curl_formatted_connect_to.append(":");
+    m_curl_formatted_connect_to.append(std::to_string(m_resolve_port));
+    m_curl_formatted_connect_to.append(bracket ? ":[" : ":");
+    m_curl_formatted_connect_to.append(m_resolved_ip_addr);
+    m_curl_formatted_connect_to.append(bracket ? "]:" : ":");
+    m_curl_formatted_connect_to.append(std::to_string(m_resolve_port));
 }
 
 } // namespace lift
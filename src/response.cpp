@@ -5,8 +5,26 @@
 
 namespace lift
 {
-response::response()
+response::response() : response(nullptr)
 {
+}
+
+response::response(std::pmr::memory_resource* resource)
+    : m_headers((resource != nullptr) ? resource : std::pmr::get_default_resource()),
+      m_data((resource != nullptr) ? resource : std::pmr::get_default_resource())
+{
+    m_headers.reserve(header_default_count);
+}
+
+auto response::memory_resource(std::pmr::memory_resource* resource) -> void
+{
+    if (resource == nullptr)
+    {
+        resource = std::pmr::get_default_resource();
+    }
+
+    impl::rebind_memory_resource(m_headers, resource);
+    impl::rebind_memory_resource(m_data, resource);
     m_headers.reserve(header_default_count);
 }
 
@@ -0,0 +1,143 @@
+#include "catch_amalgamated.hpp"
+#include "setup.hpp"
+#include <lift/lift.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using namespace std::chrono_literals;
+
+static auto batch_options(std::chrono::milliseconds window, std::size_t max_batch_size) -> lift::batcher::options
+{
+    return lift::batcher::options{
+        .window         = window,
+        .max_batch_size = max_batch_size,
+        .merge =
+            [](const std::vector<std::string>& items)
+        {
+            std::string keys{};
+            for (const auto& item : items)
+            {
+                keys += (keys.empty() ? "" : ",") + item;
+            }
+            return std::make_unique<lift::request>(
+                "http://" + nginx_hostname + ":" + nginx_port_str + "/?keys=" + keys, std::chrono::seconds{10});
+        },
+        .split =
+            [](const lift::response& response, const std::vector<std::string>& items)
+        {
+            std::vector<std::optional<std::string>> results{};
+            for (const auto& item : items)
+            {
+                results.emplace_back(item + ":" + std::to_string(static_cast<int>(response.status_code())));
+            }
+            return results;
+        }};
+}
+
+static auto wait_for(std::atomic<uint64_t>& completed, uint64_t expected) -> void
+{
+    auto deadline = std::chrono::steady_clock::now() + 10s;
+    while (completed.load(std::memory_order_acquire) < expected && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+TEST_CASE("batcher Full batches are sent without waiting for the window")
+{
+    lift::client  client{};
+    lift::batcher batcher{client, batch_options(10s, 10)};
+
+    std::mutex                         results_lock{};
+    std::map<std::string, std::string> results{};
+    std::atomic<uint64_t>              completed{0};
+
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        auto item = std::to_string(i);
+        batcher.submit(
+            item,
+            [&, item](lift::lift_status status, std::string result)
+            {
+                REQUIRE(status == lift::lift_status::success);
+                {
+                    std::lock_guard<std::mutex> guard{results_lock};
+                    results.emplace(item, std::move(result));
+                }
+                completed.fetch_add(1, std::memory_order_release);
+            });
+    }
+
+    // The window is far longer than the test, only full batches can have been sent.
+    wait_for(completed, 100);
+    REQUIRE(completed.load() == 100);
+    REQUIRE(batcher.items() == 100);
+    REQUIRE(batcher.batches() == 10);
+
+    std::lock_guard<std::mutex> guard{results_lock};
+    REQUIRE(results.size() == 100);
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        REQUIRE(results[std::to_string(i)] == std::to_string(i) + ":200");
+    }
+}
+
+TEST_CASE("batcher A partial batch is sent once its window passes")
+{
+    lift::client  client{};
+    lift::batcher batcher{client, batch_options(20ms, 64)};
+
+    std::atomic<uint64_t> completed{0};
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        batcher.submit(
+            std::to_string(i),
+            [&](lift::lift_status status, std::string)
+            {
+                REQUIRE(status == lift::lift_status::success);
+                completed.fetch_add(1, std::memory_order_release);
+            });
+    }
+
+    wait_for(completed, 5);
+    REQUIRE(completed.load() == 5);
+    REQUIRE(batcher.batches() == 1);
+}
+
+TEST_CASE("batcher Items fail when merge cannot build a batch")
+{
+    lift::client client{};
+
+    auto opts  = batch_options(1ms, 64);
+    opts.merge = [](const std::vector<std::string>&) -> lift::request_ptr { return nullptr; };
+
+    std::atomic<uint64_t> failed{0};
+    {
+        lift::batcher batcher{client, std::move(opts)};
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            batcher.submit(
+                std::to_string(i),
+                [&](lift::lift_status status, std::string)
+                {
+                    if (status == lift::lift_status::error_failed_to_start)
+                    {
+                        failed.fetch_add(1, std::memory_order_release);
+                    }
+                });
+        }
+    }
+
+    REQUIRE(failed.load() == 3);
+}
+
+TEST_CASE("batcher Requires merge and split")
+{
+    lift::client client{};
+    REQUIRE_THROWS_AS(lift::batcher(client, lift::batcher::options{}), std::runtime_error);
+}
@@ -2,6 +2,16 @@
 #include "setup.hpp"
 #include <lift/lift.hpp>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <thread>
+
 TEST_CASE("client Start event loop, then stop and add a request.")
 {
     lift::client client{};
@@ -118,4 +128,1045 @@ TEST_CASE("client Provide nullptr lambda functor for batch requests")
         "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
 
     REQUIRE_THROWS(client.start_requests(std::move(requests), nullptr));
-}
\ No newline at end of file
+}
+
+TEST_CASE("client Pool trim returns executors to the reserved size")
+{
+    lift::client client{lift::client::options{
+        .reserve_connections = 2, .pool_trim_interval = std::chrono::milliseconds{20}}};
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.executors_total == 2);
+    REQUIRE(metrics.executors_pooled == 2);
+
+    std::vector<lift::request_ptr> requests;
+    for (std::size_t i = 0; i < 32; ++i)
+    {
+        requests.emplace_back(std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
+    }
+
+    auto futures = client.start_requests(std::move(requests));
+    for (auto& f : futures)
+    {
+        auto [req, rep] = f.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+    }
+
+    // The burst needs more executors than were reserved up front.
+    REQUIRE(client.metrics().executors_total > 2);
+
+    // Each trim interval releases whatever sat idle in the pools for the whole interval.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (client.metrics().executors_total > 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+
+    metrics = client.metrics();
+    REQUIRE(metrics.executors_total == 2);
+    REQUIRE(metrics.executors_pooled == 2);
+    REQUIRE(metrics.timeouts_pending == 0);
+}
+
+TEST_CASE("client Predictive pool keeps connections warm for the next burst")
+{
+    lift::client client{lift::client::options{
+        .predictive_pool = lift::predictive_pool{
+            .interval = std::chrono::milliseconds{20}, .smoothing = 0.5, .headroom = 2.0}}};
+
+    auto burst = [&](std::size_t count)
+    {
+        std::vector<lift::request_ptr> requests{};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            requests.emplace_back(std::make_unique<lift::request>(
+                "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
+        }
+
+        for (auto& f : client.start_requests(std::move(requests)))
+        {
+            auto [req, rep] = f.get();
+            REQUIRE(rep.lift_status() == lift::lift_status::success);
+        }
+    };
+
+    // Steady bursts of 4 predict 4 requests in flight, with the headroom 8 connections are kept.
+    for (std::size_t i = 0; i < 50; ++i)
+    {
+        burst(4);
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.warmup_requests > 0);
+    REQUIRE(metrics.executors_total >= 8);
+    REQUIRE(metrics.warm_requests + metrics.cold_requests == 200);
+
+    // Only the warm-ups are left executing once the last burst is done.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!client.empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    // A burst twice as large finds every connection it needs already open.
+    burst(8);
+    auto after = client.metrics();
+    REQUIRE(after.cold_requests == metrics.cold_requests);
+    REQUIRE(after.warm_requests == metrics.warm_requests + 8);
+}
+
+TEST_CASE("client Fair queuing shares the client between tenants by weight")
+{
+    std::mutex               mutex{};
+    std::string              order{};
+    std::atomic<std::size_t> completed{0};
+
+    lift::client client{lift::client::options{
+        .fair_queuing = lift::fair_queuing{
+            .max_in_flight = 1, .tenants = {{.name = "a", .weight = 3}, {.name = "b", .weight = 1}}}}};
+
+    // Tenant a queues its whole batch first, b still gets one of every four requests.
+    std::vector<lift::request_ptr> requests{};
+    for (const auto* tenant : {"a", "b"})
+    {
+        for (std::size_t i = 0; i < 20; ++i)
+        {
+            auto request = std::make_unique<lift::request>(
+                "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60});
+            request->tenant(tenant);
+            requests.emplace_back(std::move(request));
+        }
+    }
+
+    client.start_requests(
+        std::move(requests),
+        [&](lift::request_ptr req, lift::response rep)
+        {
+            REQUIRE(rep.lift_status() == lift::lift_status::success);
+            std::lock_guard<std::mutex> guard{mutex};
+            order += req->tenant();
+            completed.fetch_add(1, std::memory_order_release);
+        });
+
+    while (completed.load(std::memory_order_acquire) < 40)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    {
+        std::lock_guard<std::mutex> guard{mutex};
+        REQUIRE(order.substr(0, 24) == "aaabaaabaaabaaabaaabaaab");
+    }
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.tenants.size() == 2);
+    for (const auto& tenant : metrics.tenants)
+    {
+        REQUIRE(tenant.queued == 0);
+        REQUIRE(tenant.in_flight == 0);
+        REQUIRE(tenant.admitted == 20);
+        REQUIRE(tenant.completed == 20);
+        REQUIRE(tenant.max_wait_time > std::chrono::milliseconds{0});
+        REQUIRE(tenant.wait_time >= tenant.max_wait_time);
+    }
+}
+
+TEST_CASE("client Fair queuing caps each tenant's requests in flight")
+{
+    lift::client client{lift::client::options{
+        .fair_queuing = lift::fair_queuing{.max_in_flight = 8, .default_max_in_flight = 2}}};
+
+    std::vector<lift::request_ptr> requests{};
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        requests.emplace_back(std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
+    }
+
+    auto futures = client.start_requests(std::move(requests));
+
+    // The untagged requests are the default tenant's, the client has room for them but the tenant does not.
+    uint64_t max_in_flight{0};
+    while (!client.empty())
+    {
+        auto metrics = client.metrics();
+        if (!metrics.tenants.empty())
+        {
+            max_in_flight = std::max(max_in_flight, metrics.tenants[0].in_flight);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+
+    for (auto& f : futures)
+    {
+        auto [req, rep] = f.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+    }
+
+    auto metrics = client.metrics();
+    REQUIRE(max_in_flight <= 2);
+    REQUIRE(metrics.tenants.size() == 1);
+    REQUIRE(metrics.tenants[0].name.empty());
+    REQUIRE(metrics.tenants[0].completed == 16);
+}
+
+TEST_CASE("client io_uring socket backend")
+{
+    lift::client client{lift::client::options{.socket_backend = lift::socket_backend::io_uring}};
+
+#if defined(LIFT_IO_URING)
+    // The kernel may refuse io_uring (old kernel, seccomp), in which case the client falls back.
+    bool using_io_uring = client.active_socket_backend() == lift::socket_backend::io_uring;
+#else
+    REQUIRE(client.active_socket_backend() == lift::socket_backend::uv_poll);
+    bool using_io_uring = false;
+#endif
+
+    std::vector<lift::request_ptr> requests;
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        requests.emplace_back(std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
+    }
+
+    auto futures = client.start_requests(std::move(requests));
+    for (auto& f : futures)
+    {
+        auto [req, rep] = f.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+        REQUIRE(rep.status_code() == lift::http::status_code::http_200_ok);
+        REQUIRE(rep.data().size() > 0);
+    }
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.socket_poll_updates > 0);
+    REQUIRE(metrics.socket_poll_syscalls > 0);
+    if (using_io_uring)
+    {
+        // Interest changes are batched so there are never more submits than changes.
+        REQUIRE(metrics.socket_poll_syscalls <= metrics.socket_poll_updates);
+    }
+}
+
+TEST_CASE("client Spin budget")
+{
+    lift::client client{lift::client::options{.spin_budget = std::chrono::microseconds{500}}};
+
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        auto future = client.start_request(std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
+        auto [req, rep] = future.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+        REQUIRE(rep.status_code() == lift::http::status_code::http_200_ok);
+    }
+
+    // Once idle for longer than the budget the loop stops spinning and sleeps.
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    REQUIRE(client.metrics().loop_sleeps > 0);
+}
+
+TEST_CASE("client Submissions only wake the event loop when needed")
+{
+    lift::client client{};
+
+    constexpr std::size_t count = 64;
+
+    std::vector<lift::request::async_future_type> futures;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        futures.emplace_back(client.start_request(std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60})));
+    }
+
+    for (auto& f : futures)
+    {
+        auto [req, rep] = f.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+    }
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.requests_accepted == count);
+    REQUIRE(metrics.loop_wakeups >= 1);
+    REQUIRE(metrics.loop_wakeups <= count);
+}
+
+TEST_CASE("client Request defaults")
+{
+    lift::request_defaults defaults{};
+    defaults.version          = lift::http::version::v1_0;
+    defaults.timeout          = std::chrono::seconds{60};
+    defaults.follow_redirects = false;
+    defaults.accept_encodings = std::vector<std::string>{"gzip"};
+    defaults.headers.emplace_back("X-Lift-Default", "client");
+    defaults.headers.emplace_back("X-Lift-Replaced", "client");
+
+    lift::client client{lift::client::options{.request_defaults = std::move(defaults)}};
+
+    auto make_request = [](std::string& headers_out)
+    {
+        auto request_ptr = std::make_unique<lift::request>("http://" + nginx_hostname + ":" + nginx_port_str + "/");
+        request_ptr->debug_info_handler(
+            [&headers_out](const lift::request&, lift::debug_info_type type, std::string_view data)
+            {
+                if (type == lift::debug_info_type::header_out)
+                {
+                    headers_out.append(data);
+                }
+            });
+        return request_ptr;
+    };
+
+    {
+        std::string headers_out{};
+        auto [req, rep] = client.start_request(make_request(headers_out)).get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+        REQUIRE(rep.status_code() == lift::http::status_code::http_200_ok);
+
+        REQUIRE(headers_out.find("GET / HTTP/1.0") != std::string::npos);
+        REQUIRE(headers_out.find("X-Lift-Default: client") != std::string::npos);
+        REQUIRE(headers_out.find("X-Lift-Replaced: client") != std::string::npos);
+        REQUIRE(headers_out.find("Accept-Encoding: gzip") != std::string::npos);
+        // The request itself still reports the library defaults, it never set anything.
+        REQUIRE(req->version() == lift::http::version::use_best);
+        REQUIRE_FALSE(req->timeout().has_value());
+    }
+
+    {
+        std::string headers_out{};
+        auto        request_ptr = make_request(headers_out);
+        request_ptr->version(lift::http::version::v1_1);
+        request_ptr->header("x-lift-replaced", "request");
+        request_ptr->accept_encoding(std::vector<std::string>{"deflate"});
+
+        auto [req, rep] = client.start_request(std::move(request_ptr)).get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+
+        REQUIRE(headers_out.find("GET / HTTP/1.1") != std::string::npos);
+        REQUIRE(headers_out.find("X-Lift-Default: client") != std::string::npos);
+        REQUIRE(headers_out.find("X-Lift-Replaced: client") == std::string::npos);
+        REQUIRE(headers_out.find("x-lift-replaced: request") != std::string::npos);
+        REQUIRE(headers_out.find("Accept-Encoding: deflate") != std::string::npos);
+    }
+}
+
+/**
+ * Answers every request on its own connection with "Connection: close" on an ephemeral local port,
+ * recording the address and port each connection came from.
+ */
+class peer_recording_server
+{
+public:
+    peer_recording_server()
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port        = 0;
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(m_fd, 128);
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_thread = std::thread{[this] { serve(); }};
+    }
+
+    ~peer_recording_server()
+    {
+        ::shutdown(m_fd, SHUT_RDWR);
+        m_thread.join();
+        ::close(m_fd);
+    }
+
+    peer_recording_server(const peer_recording_server&) = delete;
+    peer_recording_server(peer_recording_server&&)      = delete;
+    auto operator=(const peer_recording_server&) -> peer_recording_server& = delete;
+    auto operator=(peer_recording_server&&) -> peer_recording_server& = delete;
+
+    auto url() const -> std::string { return "http://127.0.0.1:" + std::to_string(m_port) + "/"; }
+
+    /// The source address and port of every connection accepted.
+    auto peers() -> std::vector<std::pair<std::string, uint16_t>>
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        return m_peers;
+    }
+
+private:
+    auto serve() -> void
+    {
+        while (true)
+        {
+            sockaddr_in peer{};
+            socklen_t   len  = sizeof(peer);
+            int         conn = ::accept(m_fd, reinterpret_cast<sockaddr*>(&peer), &len);
+            if (conn < 0)
+            {
+                return;
+            }
+
+            char address[INET_ADDRSTRLEN]{};
+            ::inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address));
+            {
+                std::lock_guard<std::mutex> guard{m_mutex};
+                m_peers.emplace_back(address, ntohs(peer.sin_port));
+            }
+
+            std::string received{};
+            char        buffer[4096];
+            while (received.find("\r\n\r\n") == std::string::npos)
+            {
+                auto count = ::recv(conn, buffer, sizeof(buffer), 0);
+                if (count <= 0)
+                {
+                    break;
+                }
+                received.append(buffer, static_cast<std::size_t>(count));
+            }
+
+            std::string_view ok{"HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"};
+            ::send(conn, ok.data(), ok.size(), MSG_NOSIGNAL);
+
+            // The client closes first, so its side of the connection is the one left in TIME_WAIT.
+            while (::recv(conn, buffer, sizeof(buffer), 0) > 0)
+            {
+            }
+            ::close(conn);
+        }
+    }
+
+    int                                           m_fd{-1};
+    uint16_t                                      m_port{0};
+    std::thread                                   m_thread{};
+    std::mutex                                    m_mutex{};
+    std::vector<std::pair<std::string, uint16_t>> m_peers{};
+};
+
+TEST_CASE("client Source addresses spread new connections")
+{
+    peer_recording_server server{};
+
+    lift::client client{lift::client::options{
+        .source_addresses = {
+            lift::source_address{.address = "127.0.0.1"},
+            lift::source_address{.address = "127.0.0.2", .port = 41000, .port_range = 1000}}}};
+
+    // Every response closes its connection, so every request opens a new one from its source address.
+    constexpr std::size_t rounds{5};
+    constexpr std::size_t concurrent{40};
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+        std::vector<lift::request_ptr> requests{};
+        for (std::size_t i = 0; i < concurrent; ++i)
+        {
+            requests.emplace_back(std::make_unique<lift::request>(server.url(), std::chrono::seconds{10}));
+        }
+
+        for (auto& future : client.start_requests(std::move(requests)))
+        {
+            auto [req, rep] = future.get();
+            REQUIRE(rep.lift_status() == lift::lift_status::success);
+            REQUIRE(rep.status_code() == lift::http::status_code::http_200_ok);
+        }
+    }
+
+    std::map<std::string, std::size_t> connections{};
+    for (const auto& [address, port] : server.peers())
+    {
+        ++connections[address];
+        if (address == "127.0.0.2")
+        {
+            REQUIRE(port >= 41000);
+            REQUIRE(port < 42000);
+        }
+    }
+    REQUIRE(connections.size() == 2);
+    REQUIRE(connections["127.0.0.1"] == rounds * concurrent / 2);
+    REQUIRE(connections["127.0.0.2"] == rounds * concurrent / 2);
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.source_addresses.size() == 2);
+    for (const auto& source : metrics.source_addresses)
+    {
+        REQUIRE(source.requests == rounds * concurrent / 2);
+        REQUIRE(source.connections == rounds * concurrent / 2);
+    }
+}
+
+/**
+ * Accepts connections on an ephemeral local port and never completes a response, each connection
+ * is held open until the server is destroyed.  If partial is set the response headers and the start
+ * of the body are sent.
+ */
+class stalled_server
+{
+public:
+    explicit stalled_server(bool partial) : m_partial(partial)
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = 0;
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(m_fd, 128);
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_thread = std::thread{[this] { serve(); }};
+    }
+
+    ~stalled_server()
+    {
+        ::shutdown(m_fd, SHUT_RDWR);
+        m_thread.join();
+        ::close(m_fd);
+        for (auto conn : m_connections)
+        {
+            ::close(conn);
+        }
+    }
+
+    stalled_server(const stalled_server&) = delete;
+    stalled_server(stalled_server&&)      = delete;
+    auto operator=(const stalled_server&) -> stalled_server& = delete;
+    auto operator=(stalled_server&&) -> stalled_server& = delete;
+
+    auto url() const -> std::string { return "http://127.0.0.1:" + std::to_string(m_port) + "/stalled"; }
+
+private:
+    auto serve() -> void
+    {
+        while (true)
+        {
+            int conn = ::accept(m_fd, nullptr, nullptr);
+            if (conn < 0)
+            {
+                return;
+            }
+            m_connections.push_back(conn);
+
+            std::string received{};
+            char        buffer[4096];
+            while (received.find("\r\n\r\n") == std::string::npos)
+            {
+                auto count = ::recv(conn, buffer, sizeof(buffer), 0);
+                if (count <= 0)
+                {
+                    break;
+                }
+                received.append(buffer, static_cast<std::size_t>(count));
+            }
+
+            if (m_partial)
+            {
+                std::string_view partial{"HTTP/1.1 200 OK\r\nContent-Length: 1000\r\n\r\n0123456789"};
+                ::send(conn, partial.data(), partial.size(), MSG_NOSIGNAL);
+            }
+        }
+    }
+
+    bool             m_partial{false};
+    int              m_fd{-1};
+    uint16_t         m_port{0};
+    std::thread      m_thread{};
+    std::vector<int> m_connections{};
+};
+
+TEST_CASE("client In-flight snapshot shows where requests are stuck")
+{
+    // The servers are destroyed first, closing their connections ends the requests.
+    lift::client   client{};
+    stalled_server silent{false};
+    stalled_server partial{true};
+
+    REQUIRE(client.inflight_snapshot().empty());
+
+    std::vector<lift::request_ptr> requests{};
+    requests.emplace_back(std::make_unique<lift::request>(silent.url(), std::chrono::seconds{30}));
+    requests.emplace_back(std::make_unique<lift::request>(partial.url(), std::chrono::seconds{30}));
+    requests.emplace_back(std::make_unique<lift::request>(silent.url()));
+    auto futures = client.start_requests(std::move(requests));
+
+    // Wait for both servers to answer as far as they ever will.
+    std::vector<lift::inflight_request> inflight{};
+    for (int i = 0; i < 500; ++i)
+    {
+        inflight = client.inflight_snapshot();
+        if (inflight.size() == 3 && inflight[1].phase == lift::inflight_phase::receiving)
+        {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+
+    REQUIRE(inflight.size() == 3);
+
+    REQUIRE(inflight[0].url == silent.url());
+    REQUIRE(inflight[0].phase == lift::inflight_phase::waiting_for_first_byte);
+    REQUIRE(inflight[0].bytes_received == 0);
+    REQUIRE(inflight[0].time_left.has_value());
+    REQUIRE(inflight[0].time_left.value() <= std::chrono::seconds{30});
+    REQUIRE(inflight[0].time_left.value() > std::chrono::seconds{20});
+    REQUIRE(inflight[0].age < std::chrono::seconds{10});
+    REQUIRE_FALSE(inflight[0].orphaned);
+
+    REQUIRE(inflight[1].url == partial.url());
+    REQUIRE(inflight[1].phase == lift::inflight_phase::receiving);
+    REQUIRE(inflight[1].bytes_received == 10);
+
+    REQUIRE(inflight[2].url == silent.url());
+    REQUIRE_FALSE(inflight[2].time_left.has_value());
+
+    REQUIRE(lift::to_string(inflight[1].phase) == "receiving");
+}
+
+TEST_CASE("client In-flight dump reports long running requests")
+{
+    stalled_server silent{false};
+
+    std::mutex                          mutex{};
+    std::vector<lift::inflight_request> dumped{};
+    std::atomic<uint64_t>               dumps{0};
+
+    {
+        lift::client client{lift::client::options{
+            .inflight_dump = lift::inflight_dump{
+                .interval   = std::chrono::milliseconds{10},
+                .older_than = std::chrono::milliseconds{100},
+                .handler =
+                    [&](const std::vector<lift::inflight_request>& requests)
+                    {
+                        std::lock_guard<std::mutex> guard{mutex};
+                        dumped = requests;
+                        dumps.fetch_add(1, std::memory_order_release);
+                    }}}};
+
+        auto start  = std::chrono::steady_clock::now();
+        auto future =
+            client.start_request(std::make_unique<lift::request>(silent.url(), std::chrono::milliseconds{500}));
+
+        while (dumps.load(std::memory_order_acquire) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds{100});
+
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            REQUIRE(dumped.size() == 1);
+            REQUIRE(dumped[0].url == silent.url());
+            REQUIRE(dumped[0].age >= std::chrono::milliseconds{100});
+        }
+
+        auto [req, rep] = future.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::timeout);
+        REQUIRE(client.inflight_snapshot().empty());
+    }
+}
+
+/**
+ * Records every request it receives and answers each with a body nobody should need to buffer.
+ */
+class request_recording_server
+{
+public:
+    request_recording_server()
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = 0;
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(m_fd, 128);
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_thread = std::thread{[this] { serve(); }};
+    }
+
+    ~request_recording_server()
+    {
+        ::shutdown(m_fd, SHUT_RDWR);
+        m_thread.join();
+        ::close(m_fd);
+    }
+
+    request_recording_server(const request_recording_server&) = delete;
+    request_recording_server(request_recording_server&&)      = delete;
+    auto operator=(const request_recording_server&) -> request_recording_server& = delete;
+    auto operator=(request_recording_server&&) -> request_recording_server& = delete;
+
+    auto origin() const -> std::string { return "http://127.0.0.1:" + std::to_string(m_port); }
+
+    /// Every request received, head and body.
+    auto requests() -> std::vector<std::string>
+    {
+        std::lock_guard<std::mutex> guard{m_mutex};
+        return m_requests;
+    }
+
+private:
+    auto serve() -> void
+    {
+        while (true)
+        {
+            int conn = ::accept(m_fd, nullptr, nullptr);
+            if (conn < 0)
+            {
+                return;
+            }
+
+            std::string received{};
+            char        buffer[4096];
+            std::size_t expected{std::string::npos};
+            while (received.size() < expected)
+            {
+                auto count = ::recv(conn, buffer, sizeof(buffer), 0);
+                if (count <= 0)
+                {
+                    break;
+                }
+                received.append(buffer, static_cast<std::size_t>(count));
+
+                auto head_end = received.find("\r\n\r\n");
+                if (expected == std::string::npos && head_end != std::string::npos)
+                {
+                    auto length = received.find("Content-Length: ");
+                    expected    = head_end + 4 +
+                               ((length != std::string::npos && length < head_end)
+                                    ? std::stoul(received.substr(length + 16))
+                                    : 0);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> guard{m_mutex};
+                m_requests.emplace_back(std::move(received));
+            }
+
+            std::string response{"HTTP/1.1 200 OK\r\nContent-Length: 65536\r\nConnection: close\r\n\r\n"};
+            response.append(65536, 'x');
+            ::send(conn, response.data(), response.size(), MSG_NOSIGNAL);
+            ::close(conn);
+        }
+    }
+
+    int                      m_fd{-1};
+    uint16_t                 m_port{0};
+    std::thread              m_thread{};
+    std::mutex               m_mutex{};
+    std::vector<std::string> m_requests{};
+};
+
+TEST_CASE("client Mirror copies a sample of requests to the shadow endpoint")
+{
+    request_recording_server shadow{};
+
+    lift::client client{lift::client::options{
+        .mirror = lift::mirror{
+            .rate    = 0.5,
+            .target  = shadow.origin(),
+            .rewrite = [](lift::request& r) { r.header("X-Shadow", "1"); }}}};
+
+    std::vector<lift::request_ptr> requests{};
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+        auto request = std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/mirrored?n=1", std::chrono::seconds{60});
+        request->method(lift::http::method::post);
+        request->data("payload");
+        requests.emplace_back(std::move(request));
+    }
+
+    for (auto& f : client.start_requests(std::move(requests)))
+    {
+        auto [req, rep] = f.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+        // The originals are untouched by their copies' rewrite.
+        REQUIRE(req->url() == "http://" + nginx_hostname + ":" + nginx_port_str + "/mirrored?n=1");
+        REQUIRE(req->headers().empty());
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (client.metrics().shadow_completed < 5 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    auto metrics = client.metrics();
+    REQUIRE(metrics.shadow_requests == 5);
+    REQUIRE(metrics.shadow_completed == 5);
+    REQUIRE(metrics.shadow_dropped == 0);
+
+    auto received = shadow.requests();
+    REQUIRE(received.size() == 5);
+    for (const auto& r : received)
+    {
+        REQUIRE(r.rfind("POST /mirrored?n=1 HTTP/1.1\r\n", 0) == 0);
+        REQUIRE(r.find("X-Shadow: 1\r\n") != std::string::npos);
+        REQUIRE(r.substr(r.size() - 7) == "payload");
+    }
+}
+
+TEST_CASE("client Mirror drops shadow copies first under pressure")
+{
+    stalled_server silent{false};
+    auto           silent_origin = silent.url().substr(0, silent.url().rfind('/'));
+
+    lift::client client{lift::client::options{
+        .mirror = lift::mirror{
+            .rate          = 1.0,
+            .target        = silent_origin,
+            .max_in_flight = 2,
+            .timeout       = std::chrono::seconds{30},
+            .shed_above    = 4}}};
+
+    auto burst = [&](std::size_t count)
+    {
+        std::vector<lift::request_ptr> requests{};
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            requests.emplace_back(std::make_unique<lift::request>(
+                "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}));
+        }
+
+        for (auto& f : client.start_requests(std::move(requests)))
+        {
+            auto [req, rep] = f.get();
+            REQUIRE(rep.lift_status() == lift::lift_status::success);
+        }
+    };
+
+    // Only two copies fit the shadow budget, they stay stuck on the silent endpoint.
+    burst(4);
+    auto metrics = client.metrics();
+    REQUIRE(metrics.shadow_requests == 2);
+    REQUIRE(metrics.shadow_dropped == 2);
+
+    // The originals are counted out of the client just after their futures are set.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (client.size() > 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    REQUIRE(client.size() == 2);
+
+    // More of the client's own requests than shed_above aborts the copies still executing.
+    burst(6);
+    metrics = client.metrics();
+    REQUIRE(metrics.shadow_requests == 2);
+    REQUIRE(metrics.shadow_aborted == 2);
+    REQUIRE(metrics.shadow_dropped == 8);
+    REQUIRE(metrics.shadow_completed == 0);
+
+    deadline = std::chrono::steady_clock::now() + std::chrono::seconds{5};
+    while (!client.empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    REQUIRE(client.empty());
+}
+
+TEST_CASE("client Reconfigure raises the admission limit of a running client")
+{
+    stalled_server silent{false};
+
+    lift::client client{lift::client::options{.fair_queuing = lift::fair_queuing{.max_in_flight = 2}}};
+
+    std::vector<lift::request_ptr> requests{};
+    for (std::size_t i = 0; i < 6; ++i)
+    {
+        requests.emplace_back(std::make_unique<lift::request>(silent.url(), std::chrono::seconds{2}));
+    }
+    auto futures = client.start_requests(std::move(requests));
+
+    auto wait_for_in_flight = [&](uint64_t in_flight) -> lift::client::tenant_metrics
+    {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            auto metrics = client.metrics();
+            if (!metrics.tenants.empty() && metrics.tenants[0].in_flight == in_flight)
+            {
+                return metrics.tenants[0];
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+        return client.metrics().tenants.at(0);
+    };
+
+    auto tenant = wait_for_in_flight(2);
+    REQUIRE(tenant.in_flight == 2);
+    REQUIRE(tenant.queued == 4);
+
+    // The stalled requests keep executing, two more are admitted next to them.
+    client.reconfigure(lift::client::limits{
+        .max_connections      = 8,
+        .max_host_connections = 4,
+        .connect_timeout      = std::chrono::seconds{1},
+        .max_in_flight        = 4});
+    tenant = wait_for_in_flight(4);
+    REQUIRE(tenant.in_flight == 4);
+    REQUIRE(tenant.queued == 2);
+
+    for (auto& f : futures)
+    {
+        auto [req, rep] = f.get();
+        REQUIRE(rep.lift_status() == lift::lift_status::timeout);
+    }
+
+    // The lowered connection limits still let the client's own requests through.
+    auto [req, rep] = client
+                          .start_request(std::make_unique<lift::request>(
+                              "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{10}))
+                          .get();
+    REQUIRE(rep.lift_status() == lift::lift_status::success);
+}
+
+TEST_CASE("client Post runs tasks on the event loop thread in order")
+{
+    lift::client client{};
+
+    std::vector<std::size_t> order{};
+    std::thread::id          loop_thread{};
+    bool                     same_thread{true};
+    std::promise<void>       done{};
+
+    for (std::size_t i = 0; i < 100; ++i)
+    {
+        client.post(
+            [&, i]()
+            {
+                if (i == 0)
+                {
+                    loop_thread = std::this_thread::get_id();
+                }
+                same_thread = same_thread && std::this_thread::get_id() == loop_thread;
+                order.push_back(i);
+            });
+    }
+    client.post([&]() { done.set_value(); });
+    done.get_future().wait();
+
+    REQUIRE(loop_thread != std::this_thread::get_id());
+    REQUIRE(same_thread);
+    REQUIRE(order.size() == 100);
+    REQUIRE(std::is_sorted(order.begin(), order.end()));
+    REQUIRE_THROWS_AS(client.post(nullptr), std::runtime_error);
+}
+
+TEST_CASE("client Schedule runs tasks once their delay passes")
+{
+    lift::client client{};
+
+    std::mutex                                                   lock{};
+    std::vector<std::pair<uint64_t, std::chrono::milliseconds>> ran{};
+    std::promise<void>                                           done{};
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t delay : {60, 20, 40})
+    {
+        client.schedule(
+            std::chrono::milliseconds{delay},
+            [&, delay]()
+            {
+                std::lock_guard<std::mutex> guard{lock};
+                ran.emplace_back(
+                    delay,
+                    std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start));
+                if (ran.size() == 3)
+                {
+                    done.set_value();
+                }
+            });
+    }
+
+    REQUIRE(done.get_future().wait_for(std::chrono::seconds{5}) == std::future_status::ready);
+
+    std::lock_guard<std::mutex> guard{lock};
+    REQUIRE(ran[0].first == 20);
+    REQUIRE(ran[1].first == 40);
+    REQUIRE(ran[2].first == 60);
+    for (const auto& [delay, elapsed] : ran)
+    {
+        REQUIRE(elapsed.count() >= static_cast<int64_t>(delay) - 1);
+    }
+
+    // Published right after the due tasks ran.
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+    while (client.metrics().tasks_scheduled != 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    REQUIRE(client.metrics().tasks_scheduled == 0);
+}
+
+TEST_CASE("client Start requests at a later time")
+{
+    lift::client client{};
+
+    auto make_request = []()
+    {
+        return std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{10});
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<std::chrono::milliseconds, lift::request::async_future_type>> scheduled{};
+    for (auto delay : {std::chrono::milliseconds{150}, std::chrono::milliseconds{50}, std::chrono::milliseconds{100}})
+    {
+        scheduled.emplace_back(delay, client.start_request_after(make_request(), delay));
+    }
+    REQUIRE(client.size() == 3);
+    REQUIRE(client.metrics().requests_scheduled == 3);
+
+    // A time already passed starts the request right away.
+    std::atomic<bool> past_done{false};
+    client.start_request_at(
+        make_request(),
+        start - std::chrono::seconds{1},
+        [&](lift::request_ptr, lift::response response)
+        {
+            REQUIRE(response.lift_status() == lift::lift_status::success);
+            past_done.store(true, std::memory_order_release);
+        });
+
+    for (auto& [delay, future] : scheduled)
+    {
+        auto [req, rep] = future.get();
+        auto elapsed    = std::chrono::steady_clock::now() - start;
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+        REQUIRE(elapsed >= delay);
+    }
+    REQUIRE(past_done.load(std::memory_order_acquire));
+    REQUIRE(client.metrics().requests_scheduled == 0);
+}
+
+TEST_CASE("client Stopping fails requests scheduled for later")
+{
+    lift::request::async_future_type future{};
+    auto                             start = std::chrono::steady_clock::now();
+    {
+        lift::client client{};
+        future = client.start_request_after(
+            std::make_unique<lift::request>("http://" + nginx_hostname + ":" + nginx_port_str + "/"),
+            std::chrono::hours{1});
+    }
+
+    // The client doesn't wait for the request to become due.
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds{5});
+    auto [req, rep] = future.get();
+    REQUIRE(rep.lift_status() == lift::lift_status::error_failed_to_start);
+}
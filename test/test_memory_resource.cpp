@@ -0,0 +1,126 @@
+#include "catch_amalgamated.hpp"
+#include "setup.hpp"
+#include <lift/lift.hpp>
+
+#include <atomic>
+#include <memory_resource>
+
+/**
+ * Forwards to the new/delete resource while counting what is still allocated through it.
+ */
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+    std::atomic<int64_t> m_allocations{0};
+    std::atomic<int64_t> m_bytes_in_use{0};
+
+private:
+    auto do_allocate(std::size_t bytes, std::size_t alignment) -> void* override
+    {
+        m_allocations.fetch_add(1, std::memory_order_relaxed);
+        m_bytes_in_use.fetch_add(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    auto do_deallocate(void* p, std::size_t bytes, std::size_t alignment) -> void override
+    {
+        m_bytes_in_use.fetch_sub(static_cast<int64_t>(bytes), std::memory_order_relaxed);
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override
+    {
+        return this == &other;
+    }
+};
+
+TEST_CASE("memory_resource synchronous request and response")
+{
+    counting_resource resource{};
+
+    {
+        lift::request request{
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}, &resource};
+        request.header("X-Lift-Test", "memory_resource");
+        REQUIRE(request.memory_resource() == &resource);
+        REQUIRE(resource.m_allocations.load() > 0);
+
+        auto allocations = resource.m_allocations.load();
+        auto response    = request.perform();
+        REQUIRE(response.lift_status() == lift::lift_status::success);
+        REQUIRE(response.status_code() == lift::http::status_code::http_200_ok);
+        REQUIRE_FALSE(response.data().empty());
+        REQUIRE_FALSE(response.headers().empty());
+
+        // The response's headers and body came from the request's resource.
+        REQUIRE(resource.m_allocations.load() > allocations);
+        REQUIRE(response.headers().get_allocator().resource() == &resource);
+
+        // Copies allocate from the default resource.
+        lift::request copy{request};
+        REQUIRE(copy.headers().get_allocator().resource() == std::pmr::get_default_resource());
+        REQUIRE(copy.headers().front().name() == "X-Lift-Test");
+    }
+
+    // Everything was handed back once the request and response are gone.
+    REQUIRE(resource.m_bytes_in_use.load() == 0);
+}
+
+TEST_CASE("memory_resource monotonic arena per call")
+{
+    std::pmr::monotonic_buffer_resource arena{};
+
+    lift::client client{};
+
+    for (std::size_t i = 0; i < 4; ++i)
+    {
+        auto request_ptr = std::make_unique<lift::request>(
+            "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}, &arena);
+        request_ptr->header("X-Lift-Call", std::to_string(i));
+
+        auto [req, rep] = client.start_request(std::move(request_ptr)).get();
+        REQUIRE(rep.lift_status() == lift::lift_status::success);
+        REQUIRE(rep.status_code() == lift::http::status_code::http_200_ok);
+        REQUIRE(rep.headers().get_allocator().resource() == &arena);
+    }
+
+    // The executors the client pools for re-use no longer reference the arena.
+    arena.release();
+
+    auto [req, rep] = client
+                          .start_request(std::make_unique<lift::request>(
+                              "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}))
+                          .get();
+    REQUIRE(rep.lift_status() == lift::lift_status::success);
+    REQUIRE(rep.headers().get_allocator().resource() == std::pmr::get_default_resource());
+}
+
+TEST_CASE("memory_resource client default resource")
+{
+    counting_resource client_resource{};
+    counting_resource request_resource{};
+
+    {
+        lift::client client{lift::client::options{.memory_resource = &client_resource}};
+
+        auto [req1, rep1] = client
+                                .start_request(std::make_unique<lift::request>(
+                                    "http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}))
+                                .get();
+        REQUIRE(rep1.lift_status() == lift::lift_status::success);
+        REQUIRE(rep1.headers().get_allocator().resource() == &client_resource);
+
+        // A request's own resource takes precedence over the client's.
+        auto [req2, rep2] = client
+                                .start_request(std::make_unique<lift::request>(
+                                    "http://" + nginx_hostname + ":" + nginx_port_str + "/",
+                                    std::chrono::seconds{60},
+                                    &request_resource))
+                                .get();
+        REQUIRE(rep2.lift_status() == lift::lift_status::success);
+        REQUIRE(rep2.headers().get_allocator().resource() == &request_resource);
+    }
+
+    REQUIRE(client_resource.m_bytes_in_use.load() == 0);
+    REQUIRE(request_resource.m_bytes_in_use.load() == 0);
+}
@@ -2,6 +2,17 @@
 #include "setup.hpp"
 #include <lift/lift.hpp>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
 TEST_CASE("mime_field field_value")
 {
     lift::mime_field mime{"name", std::string{"value"}};
@@ -41,3 +52,292 @@ TEST_CASE("mime_field added to request")
     REQUIRE(std::holds_alternative<std::filesystem::path>(mime_fields[1].value()));
     REQUIRE(std::get<std::filesystem::path>(mime_fields[1].value()) == "/var/log/lift.log");
 }
+
+/**
+ * Accepts a single HTTP/1.1 request on an ephemeral local port, records it and responds 200.
+ */
+class upload_server
+{
+public:
+    upload_server()
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = 0;
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(m_fd, 1);
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+
+        m_thread = std::thread{[this] { serve(); }};
+    }
+
+    ~upload_server()
+    {
+        ::shutdown(m_fd, SHUT_RDWR);
+        m_thread.join();
+        ::close(m_fd);
+    }
+
+    upload_server(const upload_server&) = delete;
+    upload_server(upload_server&&)      = delete;
+    auto operator=(const upload_server&) -> upload_server& = delete;
+    auto operator=(upload_server&&) -> upload_server& = delete;
+
+    auto url() const -> std::string { return "http://127.0.0.1:" + std::to_string(m_port) + "/upload"; }
+
+    /// The full request received, only valid once the client has its response.
+    std::string m_received{};
+
+private:
+    auto serve() -> void
+    {
+        int conn = ::accept(m_fd, nullptr, nullptr);
+        if (conn < 0)
+        {
+            return;
+        }
+
+        std::size_t header_end{std::string::npos};
+        std::size_t content_length{0};
+        bool        chunked{false};
+        bool        continued{false};
+        char        buffer[64 * 1024];
+        while (true)
+        {
+            if (header_end == std::string::npos && (header_end = m_received.find("\r\n\r\n")) != std::string::npos)
+            {
+                auto headers = m_received.substr(0, header_end);
+                if (auto pos = headers.find("Content-Length: "); pos != std::string::npos)
+                {
+                    content_length = std::stoul(headers.substr(pos + 16));
+                }
+                chunked = headers.find("Transfer-Encoding: chunked") != std::string::npos;
+                if (headers.find("Expect: 100-continue") != std::string::npos && !continued)
+                {
+                    std::string_view go{"HTTP/1.1 100 Continue\r\n\r\n"};
+                    ::send(conn, go.data(), go.size(), MSG_NOSIGNAL);
+                    continued = true;
+                }
+            }
+
+            bool complete = (chunked) ? m_received.size() >= 5 && m_received.compare(m_received.size() - 5, 5, "0\r\n\r\n") == 0
+                                      : m_received.size() >= header_end + 4 + content_length;
+            if (header_end != std::string::npos && complete)
+            {
+                std::string_view ok{"HTTP/1.1 200 OK\r\nContent-Length: 0\r\nConnection: close\r\n\r\n"};
+                ::send(conn, ok.data(), ok.size(), MSG_NOSIGNAL);
+                break;
+            }
+
+            auto count = ::recv(conn, buffer, sizeof(buffer), 0);
+            if (count <= 0)
+            {
+                break;
+            }
+            m_received.append(buffer, static_cast<std::size_t>(count));
+        }
+
+        ::close(conn);
+    }
+
+    int         m_fd{-1};
+    uint16_t    m_port{0};
+    std::thread m_thread{};
+};
+
+static auto write_upload_file(const std::filesystem::path& path, std::size_t size) -> std::string
+{
+    std::string content(size, '\0');
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        content[i] = static_cast<char>('a' + (i * 7919) % 26);
+    }
+
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    return content;
+}
+
+TEST_CASE("mime_field file uploaded by a client")
+{
+    auto path    = std::filesystem::temp_directory_path() / "lift_mime_upload.bin";
+    auto content = write_upload_file(path, 700 * 1024);
+
+    upload_server server{};
+    lift::client  client{};
+
+    auto request_ptr = std::make_unique<lift::request>(server.url(), std::chrono::seconds{10});
+    request_ptr->method(lift::http::method::post);
+    request_ptr->mime_field(lift::mime_field{"field", std::string{"value"}});
+    request_ptr->mime_field(lift::mime_field{"file", path});
+
+    auto [req, rep] = client.start_request(std::move(request_ptr)).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::success);
+    REQUIRE(rep.status_code() == lift::http::status_code::http_200_ok);
+
+    // The part carries the same headers as one curl reads from disk itself.
+    const auto& received = server.m_received;
+    REQUIRE(received.find("filename=\"lift_mime_upload.bin\"") != std::string::npos);
+    REQUIRE(received.find("Content-Type: application/octet-stream") != std::string::npos);
+    REQUIRE(received.find(content) != std::string::npos);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("mime_field file removed before a client uploads it")
+{
+    auto path = std::filesystem::temp_directory_path() / "lift_mime_upload_removed.bin";
+    write_upload_file(path, 64 * 1024);
+
+    lift::mime_field field{"file", path};
+    std::filesystem::remove(path);
+
+    upload_server server{};
+    lift::client  client{};
+
+    auto request_ptr = std::make_unique<lift::request>(server.url(), std::chrono::seconds{10});
+    request_ptr->method(lift::http::method::post);
+    request_ptr->mime_field(std::move(field));
+
+    auto [req, rep] = client.start_request(std::move(request_ptr)).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::error);
+}
+
+/**
+ * @return The body of a request received by an upload_server with its part boundary replaced by
+ *         "BOUNDARY" so bodies sent with different boundaries can be compared.
+ */
+static auto received_body(const std::string& received) -> std::string
+{
+    auto headers = received.substr(0, received.find("\r\n\r\n"));
+    auto body    = received.substr(headers.size() + 4);
+
+    std::string_view marker{"boundary="};
+    auto             start    = headers.find(marker) + marker.size();
+    auto             boundary = headers.substr(start, headers.find("\r\n", start) - start);
+
+    for (auto pos = body.find(boundary); pos != std::string::npos; pos = body.find(boundary, pos))
+    {
+        body.replace(pos, boundary.size(), "BOUNDARY");
+    }
+    return body;
+}
+
+TEST_CASE("mime_template body matches a mime_field request")
+{
+    std::string expected{};
+    {
+        upload_server server{};
+        lift::request request{server.url(), std::chrono::seconds{10}};
+        request.mime_field(lift::mime_field{"shared", std::string{"shared value"}});
+        request.mime_field(lift::mime_field{"own", std::string{"own \"quoted\" value"}});
+        REQUIRE(request.perform().lift_status() == lift::lift_status::success);
+        expected = received_body(server.m_received);
+    }
+
+    auto mime_template = lift::mime_template::make_shared({lift::mime_field{"shared", std::string{"shared value"}}});
+
+    upload_server server{};
+    lift::request request{server.url(), std::chrono::seconds{10}};
+    request.mime_template(mime_template);
+    request.mime_field(lift::mime_field{"own", std::string{"own \"quoted\" value"}});
+    REQUIRE(request.perform().lift_status() == lift::lift_status::success);
+
+    REQUIRE(server.m_received.find("Content-Type: multipart/form-data; boundary=" + mime_template->boundary()) !=
+            std::string::npos);
+    REQUIRE(received_body(server.m_received) == expected);
+}
+
+TEST_CASE("mime_template shared by requests with their own file")
+{
+    auto shared_path    = std::filesystem::temp_directory_path() / "lift_mime_template_shared.txt";
+    auto shared_content = write_upload_file(shared_path, 1024);
+
+    auto mime_template = lift::mime_template::make_shared(
+        {lift::mime_field{"kind", std::string{"report"}}, lift::mime_field{"shared", shared_path}});
+    // The shared file is read once when the template is built.
+    std::filesystem::remove(shared_path);
+
+    lift::client client{};
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        auto path    = std::filesystem::temp_directory_path() / ("lift_mime_template_" + std::to_string(i) + ".bin");
+        auto content = write_upload_file(path, (i + 1) * 300 * 1024);
+
+        upload_server server{};
+        auto          request_ptr = std::make_unique<lift::request>(server.url(), std::chrono::seconds{10});
+        request_ptr->mime_template(mime_template);
+        request_ptr->mime_field(lift::mime_field{"file", path});
+
+        lift::response response{};
+        if (i == 0)
+        {
+            response = request_ptr->perform();
+        }
+        else
+        {
+            response = std::move(client.start_request(std::move(request_ptr)).get().second);
+        }
+        REQUIRE(response.lift_status() == lift::lift_status::success);
+
+        const auto& received = server.m_received;
+        auto        body     = received.substr(received.find("\r\n\r\n") + 4);
+        REQUIRE(received.find("Content-Length: " + std::to_string(body.size()) + "\r\n") != std::string::npos);
+        REQUIRE(received.find("Transfer-Encoding: chunked") == std::string::npos);
+        REQUIRE(body.find("name=\"kind\"\r\n\r\nreport\r\n") != std::string::npos);
+        REQUIRE(body.find("filename=\"lift_mime_template_shared.txt\"\r\nContent-Type: text/plain\r\n\r\n" +
+                          shared_content + "\r\n") != std::string::npos);
+        REQUIRE(
+            body.find(
+                "name=\"file\"; filename=\"" + path.filename().string() +
+                "\"\r\nContent-Type: application/octet-stream\r\n\r\n" + content + "\r\n--" +
+                mime_template->boundary() + "--\r\n") != std::string::npos);
+
+        std::filesystem::remove(path);
+    }
+}
+
+TEST_CASE("mime_template without content length is sent chunked")
+{
+    auto mime_template =
+        lift::mime_template::make_shared({lift::mime_field{"shared", std::string{"shared value"}}}, false);
+
+    upload_server server{};
+    lift::client  client{};
+
+    auto request_ptr = std::make_unique<lift::request>(server.url(), std::chrono::seconds{10});
+    request_ptr->mime_template(mime_template);
+    request_ptr->mime_field(lift::mime_field{"own", std::string{"own value"}});
+
+    auto [req, rep] = client.start_request(std::move(request_ptr)).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::success);
+    REQUIRE(server.m_received.find("Transfer-Encoding: chunked") != std::string::npos);
+    REQUIRE(server.m_received.find("Content-Length") == std::string::npos);
+    REQUIRE(server.m_received.find("shared value") != std::string::npos);
+    REQUIRE(server.m_received.find("own value") != std::string::npos);
+}
+
+TEST_CASE("mime_template and request data are mutually exclusive")
+{
+    auto mime_template = lift::mime_template::make_shared({lift::mime_field{"shared", std::string{"value"}}});
+
+    lift::request with_template{"http://localhost"};
+    with_template.mime_template(mime_template);
+    REQUIRE_THROWS_AS(with_template.data("data"), std::logic_error);
+
+    lift::request with_data{"http://localhost"};
+    with_data.data("data");
+    REQUIRE_THROWS_AS(with_data.mime_template(mime_template), std::logic_error);
+}
+
+TEST_CASE("mime_template file part that cannot be read")
+{
+    REQUIRE_THROWS_AS(
+        lift::mime_template::make_shared({lift::mime_field{"file", std::filesystem::path{"/nonexistent/lift.bin"}}}),
+        std::runtime_error);
+}
@@ -0,0 +1,177 @@
+#include "catch_amalgamated.hpp"
+#include "setup.hpp"
+#include <lift/lift.hpp>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+static auto read_file(const std::filesystem::path& path) -> std::string
+{
+    std::ifstream file{path, std::ios::binary};
+    return std::string{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+}
+
+static auto expected_body() -> std::string
+{
+    lift::request request{"http://" + nginx_hostname + ":" + nginx_port_str + "/index.html", std::chrono::seconds{60}};
+    auto          response = request.perform();
+    REQUIRE(response.lift_status() == lift::lift_status::success);
+    return std::string{response.data()};
+}
+
+TEST_CASE("parallel_download ranges into a file sink")
+{
+    auto path = std::filesystem::temp_directory_path() / "lift_parallel_download_file.html";
+
+    lift::client             client{};
+    lift::file_download_sink sink{path};
+    auto                     result = lift::parallel_download(
+        "http://" + nginx_hostname + ":" + nginx_port_str + "/index.html",
+        sink,
+        lift::parallel_download_options{
+                                .client = &client, .chunks = 3, .max_chunk_size = 100, .min_chunk_size = 1});
+
+    REQUIRE(result.lift_status == lift::lift_status::success);
+    REQUIRE(result.ranged);
+    REQUIRE(result.ranges == (result.size + 99) / 100);
+    REQUIRE(result.retries == 0);
+
+    auto expected = expected_body();
+    REQUIRE(result.size == expected.size());
+    REQUIRE(read_file(path) == expected);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("parallel_download ranges into an mmap sink")
+{
+    auto path = std::filesystem::temp_directory_path() / "lift_parallel_download_mmap.html";
+
+    lift::mmap_download_sink sink{path};
+    auto                     result = lift::parallel_download(
+        "http://" + nginx_hostname + ":" + nginx_port_str + "/index.html",
+        sink,
+        lift::parallel_download_options{.chunks = 8, .min_chunk_size = 1});
+
+    REQUIRE(result.lift_status == lift::lift_status::success);
+    REQUIRE(result.ranged);
+    REQUIRE(result.ranges == 8);
+    REQUIRE(read_file(path) == expected_body());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("parallel_download small objects use a single request")
+{
+    auto path = std::filesystem::temp_directory_path() / "lift_parallel_download_whole.html";
+
+    lift::file_download_sink sink{path};
+    auto                     result =
+        lift::parallel_download("http://" + nginx_hostname + ":" + nginx_port_str + "/index.html", sink);
+
+    REQUIRE(result.lift_status == lift::lift_status::success);
+    REQUIRE_FALSE(result.ranged);
+    REQUIRE(result.ranges == 0);
+    REQUIRE(read_file(path) == expected_body());
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("parallel_download missing object")
+{
+    auto path = std::filesystem::temp_directory_path() / "lift_parallel_download_missing.html";
+
+    lift::file_download_sink sink{path};
+    auto                     result = lift::parallel_download(
+        "http://" + nginx_hostname + ":" + nginx_port_str + "/not/here", sink, {.min_chunk_size = 1});
+
+    REQUIRE(result.lift_status == lift::lift_status::success);
+    REQUIRE(result.status_code == lift::http::status_code::http_404_not_found);
+    REQUIRE(result.ranges == 0);
+    REQUIRE_FALSE(std::filesystem::exists(path));
+}
+
+/**
+ * Fails every write after the first `writes` to simulate a download interrupted part way.
+ */
+class interrupted_sink : public lift::file_download_sink
+{
+public:
+    interrupted_sink(std::filesystem::path path, uint64_t writes)
+        : lift::file_download_sink(std::move(path)),
+          m_writes(writes)
+    {
+    }
+
+    auto write(uint64_t offset, std::string_view data) -> bool override
+    {
+        if (m_writes == 0)
+        {
+            return false;
+        }
+        --m_writes;
+        return lift::file_download_sink::write(offset, data);
+    }
+
+private:
+    uint64_t m_writes;
+};
+
+TEST_CASE("parallel_download resumes from a checkpoint")
+{
+    auto path       = std::filesystem::temp_directory_path() / "lift_parallel_download_resume.html";
+    auto checkpoint = std::filesystem::temp_directory_path() / "lift_parallel_download_resume.checkpoint";
+    auto url        = "http://" + nginx_hostname + ":" + nginx_port_str + "/index.html";
+    auto options    = lift::parallel_download_options{
+           .chunks = 2, .max_chunk_size = 100, .min_chunk_size = 1, .checkpoint = checkpoint};
+
+    {
+        interrupted_sink sink{path, 3};
+        auto             result = lift::parallel_download(url, sink, options);
+        REQUIRE(result.lift_status == lift::lift_status::error);
+        REQUIRE(std::filesystem::exists(checkpoint));
+    }
+
+    lift::file_download_sink sink{path};
+    auto                     result = lift::parallel_download(url, sink, options);
+    REQUIRE(result.lift_status == lift::lift_status::success);
+    REQUIRE(result.resumed_bytes == 300);
+    REQUIRE(read_file(path) == expected_body());
+
+    // A successful download removes its checkpoint.
+    REQUIRE_FALSE(std::filesystem::exists(checkpoint));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("parallel_download verifies checkpointed data before reusing it")
+{
+    auto path       = std::filesystem::temp_directory_path() / "lift_parallel_download_verify.html";
+    auto checkpoint = std::filesystem::temp_directory_path() / "lift_parallel_download_verify.checkpoint";
+    auto url        = "http://" + nginx_hostname + ":" + nginx_port_str + "/index.html";
+    auto options    = lift::parallel_download_options{
+           .chunks = 1, .max_chunk_size = 100, .min_chunk_size = 1, .checkpoint = checkpoint};
+
+    {
+        interrupted_sink sink{path, 3};
+        REQUIRE(lift::parallel_download(url, sink, options).lift_status == lift::lift_status::error);
+    }
+
+    // Ranges are issued one at a time so the first three were written, the first one's data never
+    // made it to disk intact.
+    {
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(10);
+        file.put('#');
+    }
+
+    lift::file_download_sink sink{path};
+    auto                     result = lift::parallel_download(url, sink, options);
+    REQUIRE(result.lift_status == lift::lift_status::success);
+    REQUIRE(result.resumed_bytes == 200);
+    REQUIRE(read_file(path) == expected_body());
+
+    std::filesystem::remove(path);
+}
@@ -39,3 +39,37 @@ TEST_CASE("resolve_host client")
 
     client.start_requests(std::move(requests), on_complete);
 }
+
+TEST_CASE("resolve_host client update keeps connections to addresses still in the table")
+{
+    lift::client client{lift::client::options{
+        .resolve_hosts = std::vector<lift::resolve_host>{{"testhostname", nginx_port, service_ip_address}}}};
+
+    auto perform = [&](std::chrono::milliseconds timeout) -> lift::response
+    {
+        auto request = std::make_unique<lift::request>("http://testhostname:" + nginx_port_str + "/", timeout);
+        auto [req, response] = client.start_request(std::move(request)).get();
+        return std::move(response);
+    };
+
+    auto response = perform(std::chrono::seconds{10});
+    REQUIRE(response.lift_status() == lift::lift_status::success);
+    REQUIRE(response.num_connects() == 1);
+
+    // The same address, the open connection is reused.
+    client.update_resolve_hosts({lift::resolve_host{"testhostname", nginx_port, service_ip_address}});
+    response = perform(std::chrono::seconds{10});
+    REQUIRE(response.lift_status() == lift::lift_status::success);
+    REQUIRE(response.num_connects() == 0);
+
+    // An unroutable address, the connection to the old address must not be reused for it.
+    client.update_resolve_hosts({lift::resolve_host{"testhostname", nginx_port, "192.0.2.1"}});
+    response = perform(std::chrono::milliseconds{250});
+    REQUIRE(response.lift_status() != lift::lift_status::success);
+
+    // Back to the original address, its connection is still open.
+    client.update_resolve_hosts({lift::resolve_host{"testhostname", nginx_port, service_ip_address}});
+    response = perform(std::chrono::seconds{10});
+    REQUIRE(response.lift_status() == lift::lift_status::success);
+    REQUIRE(response.num_connects() == 0);
+}
@@ -111,3 +111,80 @@ TEST_CASE("SSL functions")
 {
     // TODO, some of these require files.
 }
+
+TEST_CASE("Rarely used settings survive copies and moves")
+{
+    lift::request request{"http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}};
+    REQUIRE_FALSE(request.ssl_cert().has_value());
+    REQUIRE_FALSE(request.proxy().has_value());
+    REQUIRE(request.resolve_hosts().empty());
+
+    request.ssl_cert("/tmp/cert.pem");
+    request.ssl_cert_type(lift::ssl_certificate_type::pem);
+    request.key_password("password");
+    request.happy_eyeballs_timeout(std::chrono::milliseconds{100});
+    request.proxy(lift::proxy_type::http, "proxy.localhost", 3128);
+
+    // Copies are independent of the original.
+    lift::request copy{request};
+    copy.key_password("other");
+    REQUIRE(copy.ssl_cert().value() == "/tmp/cert.pem");
+    REQUIRE(copy.ssl_cert_type().value() == lift::ssl_certificate_type::pem);
+    REQUIRE(copy.proxy().value().m_host == "proxy.localhost");
+    REQUIRE(copy.key_password().value() == "other");
+    REQUIRE(request.key_password().value() == "password");
+
+    lift::request moved{std::move(copy)};
+    REQUIRE(moved.happy_eyeballs_timeout().value() == std::chrono::milliseconds{100});
+    REQUIRE(moved.proxy().value().m_port == 3128);
+
+    // Clearing settings that were never set leaves the request as it was.
+    lift::request plain{"http://" + nginx_hostname + ":" + nginx_port_str + "/", std::chrono::seconds{60}};
+    plain.debug_info_handler(nullptr);
+    plain.transfer_progress_handler(std::nullopt);
+    plain.clear_resolve_hosts();
+    REQUIRE_FALSE(plain.happy_eyeballs_timeout().has_value());
+
+    auto response = plain.perform();
+    REQUIRE(response.lift_status() == lift::lift_status::success);
+    REQUIRE(response.status_code() == lift::http::status_code::http_200_ok);
+}
+
+TEST_CASE("Clones share what they do not change")
+{
+    auto url = "http://" + nginx_hostname + ":" + nginx_port_str + "/";
+
+    lift::request original{url, std::chrono::seconds{60}};
+    original.header("X-Lift-Shared", "shared");
+    original.data(std::string(10 * 1024, 'x'));
+    original.method(lift::http::method::post);
+
+    auto clone = original.clone();
+    REQUIRE(clone->url() == original.url());
+    REQUIRE(clone->url().data() == original.url().data());
+    REQUIRE(clone->headers().data() == original.headers().data());
+    REQUIRE(clone->data().data() == original.data().data());
+
+    // Changing the clone's url and headers leaves the original and the shared body alone.
+    clone->url(url + "?clone=1");
+    clone->header("X-Lift-Clone", "clone");
+    REQUIRE(original.url() == url);
+    REQUIRE(original.headers().size() == 1);
+    REQUIRE(clone->headers().size() == 2);
+    REQUIRE(clone->headers().front().name() == "X-Lift-Shared");
+    REQUIRE(clone->data().data() == original.data().data());
+
+    lift::client client{};
+    auto         future = client.start_request(std::move(clone));
+
+    // The original's body can be replaced while the clone's transfer still reads the shared one.
+    original.data(std::string(1024, 'y'));
+    auto response = original.perform();
+    REQUIRE(response.lift_status() == lift::lift_status::success);
+    REQUIRE(original.data().size() == 1024);
+
+    auto [clone_request, clone_response] = future.get();
+    REQUIRE(clone_response.lift_status() == lift::lift_status::success);
+    REQUIRE(clone_request->data().size() == 10 * 1024);
+    REQUIRE(clone_request->url() == url + "?clone=1");
+}
@@ -2,7 +2,14 @@
 #include "setup.hpp"
 #include <lift/lift.hpp>
 
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
 #include <chrono>
+#include <string>
+#include <thread>
 #include <vector>
 
 TEST_CASE("Timesup single request")
@@ -46,3 +53,116 @@ TEST_CASE("Timesup two requests")
 
     client.start_requests(std::move(requests));
 }
+
+/**
+ * Accepts connections on an ephemeral local port and never responds, transfers to it connect
+ * immediately and then run until their connect timeout.
+ */
+class silent_listener
+{
+public:
+    silent_listener()
+    {
+        m_fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port        = 0;
+        ::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(m_fd, 16);
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(m_fd, reinterpret_cast<sockaddr*>(&addr), &len);
+        m_port = ntohs(addr.sin_port);
+    }
+
+    ~silent_listener() { ::close(m_fd); }
+
+    auto url() const -> std::string { return "http://127.0.0.1:" + std::to_string(m_port) + "/"; }
+
+private:
+    int      m_fd{-1};
+    uint16_t m_port{0};
+};
+
+/**
+ * The orphan policy is applied on the event loop after the timeout response is delivered, wait
+ * up to five seconds for the metrics to reflect it.
+ */
+template<typename predicate_type>
+static auto wait_for_metrics(lift::client& client, predicate_type predicate) -> lift::client::metrics_snapshot
+{
+    auto metrics = client.metrics();
+    for (std::size_t i = 0; i < 500 && !predicate(metrics); ++i)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        metrics = client.metrics();
+    }
+    return metrics;
+}
+
+TEST_CASE("Orphan policy abort")
+{
+    silent_listener listener{};
+    lift::client    client{lift::client::options{
+           .connect_timeout = std::chrono::seconds{2}, .orphan_policy = lift::orphan_policy::abort}};
+
+    auto [req, rep] =
+        client.start_request(std::make_unique<lift::request>(listener.url(), std::chrono::milliseconds{50})).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::timeout);
+
+    auto metrics = wait_for_metrics(client, [](const auto& m) { return m.orphans_aborted > 0; });
+    REQUIRE(metrics.orphans_aborted == 1);
+    REQUIRE(metrics.orphans_active == 0);
+    REQUIRE(metrics.orphans_completed == 0);
+}
+
+TEST_CASE("Orphan policy keep_to_completion")
+{
+    silent_listener listener{};
+    lift::client    client{lift::client::options{.connect_timeout = std::chrono::milliseconds{300}}};
+
+    auto [req, rep] =
+        client.start_request(std::make_unique<lift::request>(listener.url(), std::chrono::milliseconds{50})).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::timeout);
+    REQUIRE(wait_for_metrics(client, [](const auto& m) { return m.orphans_active > 0; }).orphans_active == 1);
+
+    // The orphan runs until the connect timeout, it never completes successfully.
+    auto metrics = wait_for_metrics(client, [](const auto& m) { return m.orphans_active == 0; });
+    REQUIRE(metrics.orphans_active == 0);
+    REQUIRE(metrics.orphans_aborted == 0);
+    REQUIRE(metrics.orphans_completed == 0);
+}
+
+TEST_CASE("Orphan policy max_orphans")
+{
+    silent_listener listener{};
+    lift::client    client{lift::client::options{.connect_timeout = std::chrono::seconds{2}, .max_orphans = 0}};
+
+    auto [req, rep] =
+        client.start_request(std::make_unique<lift::request>(listener.url(), std::chrono::milliseconds{50})).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::timeout);
+
+    auto metrics = wait_for_metrics(client, [](const auto& m) { return m.orphans_aborted > 0; });
+    REQUIRE(metrics.orphans_aborted == 1);
+    REQUIRE(metrics.orphans_active == 0);
+}
+
+#if LIBCURL_VERSION_NUM >= 0x075000
+TEST_CASE("Orphan policy keep_until_connected")
+{
+    silent_listener listener{};
+    lift::client    client{lift::client::options{
+           .connect_timeout = std::chrono::seconds{2}, .orphan_policy = lift::orphan_policy::keep_until_connected}};
+
+    auto [req, rep] =
+        client.start_request(std::make_unique<lift::request>(listener.url(), std::chrono::milliseconds{50})).get();
+    REQUIRE(rep.lift_status() == lift::lift_status::timeout);
+
+    // The local listener accepts immediately, so the connection was already up at timesup.
+    auto metrics = wait_for_metrics(client, [](const auto& m) { return m.orphans_connected > 0; });
+    REQUIRE(metrics.orphans_connected == 1);
+    REQUIRE(metrics.orphans_aborted == 0);
+    REQUIRE(metrics.orphans_active == 0);
+}
+#endif